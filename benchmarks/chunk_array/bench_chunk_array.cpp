@@ -0,0 +1,104 @@
+/*******************************************************************************
+* CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+* Copyright (C) 2015, IGG Group, ICube, University of Strasbourg, France       *
+*                                                                              *
+* This library is free software; you can redistribute it and/or modify it      *
+* under the terms of the GNU Lesser General Public License as published by the *
+* Free Software Foundation; either version 2.1 of the License, or (at your     *
+* option) any later version.                                                   *
+*                                                                              *
+* This library is distributed in the hope that it will be useful, but WITHOUT  *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+* for more details.                                                            *
+*                                                                              *
+* You should have received a copy of the GNU Lesser General Public License     *
+* along with this library; if not, write to the Free Software Foundation,      *
+* Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+*                                                                              *
+* Web site: http://cgogn.unistra.fr/                                           *
+* Contact information: cgogn@unistra.fr                                        *
+*                                                                              *
+*******************************************************************************/
+
+#include <cgogn/core/container/chunk_allocator.h>
+#include <cgogn/core/container/chunk_array_container.h>
+
+#include <benchmark/benchmark.h>
+
+using namespace cgogn::numerics;
+
+cgogn::AlignedChunkAllocator aligned_allocator;
+cgogn::PooledChunkAllocator pooled_allocator;
+cgogn::HugePageChunkAllocator huge_page_allocator;
+
+// range_x lines are inserted and written in order, then read in a scattered order;
+// the items are the read lines
+template <uint32 CHUNK_SIZE>
+static void fill_and_gather(benchmark::State& state, cgogn::ChunkAllocator* allocator)
+{
+	using Container = cgogn::ChunkArrayContainer<CHUNK_SIZE, uint32>;
+
+	const uint32 nb_lines = uint32(state.range_x());
+	std::size_t nb_read = 0u;
+	while(state.KeepRunning())
+	{
+		cgogn::set_chunk_allocator(allocator);
+		Container container;
+		auto values = container.template add_chunk_array<float64>("values");
+		cgogn::set_chunk_allocator(nullptr);
+
+		for (uint32 i = 0u; i < nb_lines; ++i)
+		{
+			const uint32 l = container.template insert_lines<1>();
+			(*values)[l] = float64(i);
+		}
+
+		float64 sum = 0.0;
+		uint32 l = 0u;
+		for (uint32 i = 0u; i < nb_lines; ++i)
+		{
+			l = (l + 2654435761u) % nb_lines;
+			sum += (*values)[l];
+		}
+		benchmark::DoNotOptimize(sum);
+		nb_read += nb_lines;
+	}
+	state.SetItemsProcessed(nb_read);
+	state.SetLabel(allocator->name());
+}
+
+template <uint32 CHUNK_SIZE>
+static void BENCH_aligned_allocator(benchmark::State& state)
+{
+	fill_and_gather<CHUNK_SIZE>(state, &aligned_allocator);
+}
+
+template <uint32 CHUNK_SIZE>
+static void BENCH_pooled_allocator(benchmark::State& state)
+{
+	fill_and_gather<CHUNK_SIZE>(state, &pooled_allocator);
+}
+
+template <uint32 CHUNK_SIZE>
+static void BENCH_huge_page_allocator(benchmark::State& state)
+{
+	fill_and_gather<CHUNK_SIZE>(state, &huge_page_allocator);
+}
+
+BENCHMARK_TEMPLATE(BENCH_aligned_allocator, 256)->Arg(1 << 16)->Arg(1 << 22);
+BENCHMARK_TEMPLATE(BENCH_aligned_allocator, 4096)->Arg(1 << 16)->Arg(1 << 22);
+BENCHMARK_TEMPLATE(BENCH_aligned_allocator, 65536)->Arg(1 << 16)->Arg(1 << 22);
+BENCHMARK_TEMPLATE(BENCH_pooled_allocator, 256)->Arg(1 << 16)->Arg(1 << 22);
+BENCHMARK_TEMPLATE(BENCH_pooled_allocator, 4096)->Arg(1 << 16)->Arg(1 << 22);
+BENCHMARK_TEMPLATE(BENCH_pooled_allocator, 65536)->Arg(1 << 16)->Arg(1 << 22);
+BENCHMARK_TEMPLATE(BENCH_huge_page_allocator, 4096)->Arg(1 << 16)->Arg(1 << 22);
+BENCHMARK_TEMPLATE(BENCH_huge_page_allocator, 65536)->Arg(1 << 16)->Arg(1 << 22);
+BENCHMARK_TEMPLATE(BENCH_huge_page_allocator, 262144)->Arg(1 << 16)->Arg(1 << 22);
+
+int main(int argc, char** argv)
+{
+	::benchmark::Initialize(&argc, argv);
+	::benchmark::RunSpecifiedBenchmarks();
+	return 0;
+}
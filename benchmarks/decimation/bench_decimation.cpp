@@ -0,0 +1,95 @@
+/*******************************************************************************
+* CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+* Copyright (C) 2015, IGG Group, ICube, University of Strasbourg, France       *
+*                                                                              *
+* This library is free software; you can redistribute it and/or modify it      *
+* under the terms of the GNU Lesser General Public License as published by the *
+* Free Software Foundation; either version 2.1 of the License, or (at your     *
+* option) any later version.                                                   *
+*                                                                              *
+* This library is distributed in the hope that it will be useful, but WITHOUT  *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+* for more details.                                                            *
+*                                                                              *
+* You should have received a copy of the GNU Lesser General Public License     *
+* along with this library; if not, write to the Free Software Foundation,      *
+* Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+*                                                                              *
+* Web site: http://cgogn.unistra.fr/                                           *
+* Contact information: cgogn@unistra.fr                                        *
+*                                                                              *
+*******************************************************************************/
+
+#include <cgogn/core/utils/logger.h>
+#include <cgogn/core/cmap/cmap2.h>
+#include <cgogn/io/map_import.h>
+#include <cgogn/modeling/algos/decimation.h>
+
+#include <benchmark/benchmark.h>
+
+#define DEFAULT_MESH_PATH CGOGN_STR(CGOGN_TEST_MESHES_PATH)
+
+using namespace cgogn::numerics;
+
+using Map2 = cgogn::CMap2;
+Map2 bench_map;
+
+using Vertex = Map2::Vertex;
+using Face = Map2::Face;
+
+template <typename T>
+using VertexAttribute = Map2::VertexAttribute<T>;
+
+using Vec3 = Eigen::Vector3d;
+
+std::string surface_mesh;
+
+// the mesh is reduced to range_x percent of its faces, the items are the removed faces
+static void decimate(benchmark::State& state, cgogn::modeling::DecimationSchedule schedule)
+{
+	std::size_t nb_removed = 0u;
+	while(state.KeepRunning())
+	{
+		state.PauseTiming();
+		bench_map.clear_and_remove_attributes();
+		cgogn::io::import_surface<Vec3>(bench_map, surface_mesh);
+		VertexAttribute<Vec3> vertex_position = bench_map.get_attribute<Vec3, Vertex>("position");
+		cgogn_assert(vertex_position.is_valid());
+		const uint32 nb_faces = bench_map.nb_cells<Face::ORBIT>() * uint32(state.range_x()) / 100u;
+		state.ResumeTiming();
+
+		nb_removed += cgogn::modeling::qem_decimation<Vec3>(bench_map, vertex_position, nb_faces, schedule);
+	}
+	state.SetItemsProcessed(nb_removed);
+}
+
+static void BENCH_qem_greedy(benchmark::State& state)
+{
+	decimate(state, cgogn::modeling::DECIMATION_GREEDY);
+}
+
+static void BENCH_qem_independent_sets(benchmark::State& state)
+{
+	decimate(state, cgogn::modeling::DECIMATION_INDEPENDENT_SETS);
+}
+
+BENCHMARK(BENCH_qem_greedy)->Arg(50)->Arg(10)->UseRealTime();
+BENCHMARK(BENCH_qem_independent_sets)->Arg(50)->Arg(10)->UseRealTime();
+
+int main(int argc, char** argv)
+{
+	::benchmark::Initialize(&argc, argv);
+
+	if (argc < 2)
+	{
+		cgogn_log_info("bench_decimation") << "USAGE: " << argv[0] << " [filename]";
+		surface_mesh = std::string(DEFAULT_MESH_PATH) + std::string("off/horse.off");
+		cgogn_log_info("bench_decimation") << "Using default mesh : \"" << surface_mesh << "\".";
+	}
+	else
+		surface_mesh = std::string(argv[1]);
+
+	::benchmark::RunSpecifiedBenchmarks();
+	return 0;
+}
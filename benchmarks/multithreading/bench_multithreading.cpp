@@ -339,9 +339,18 @@ int main(int argc, char** argv)
 	::benchmark::Initialize(&argc, argv);
 	std::string surfaceMesh;
 
+	// --numa: the workers are pinned to the NUMA nodes and the chunks are first touched by their owner
+	// (compare with a run under "numactl --interleave=all" as baseline)
+	bool numa = false;
+	if (argc > 1 && std::string(argv[argc-1]) == "--numa")
+	{
+		numa = true;
+		--argc;
+	}
+
 	if (argc < 2)
 	{
-		cgogn_log_info("bench_multithreading") << "USAGE: " << argv[0] << " [filename]";
+		cgogn_log_info("bench_multithreading") << "USAGE: " << argv[0] << " [filename] [--numa]";
 		surfaceMesh = std::string(DEFAULT_MESH_PATH) + std::string("off/aneurysm_3D.off");
 		cgogn_log_info("bench_multithreading") << "Using default mesh : \"" << surfaceMesh << "\".";
 	}
@@ -355,6 +364,13 @@ int main(int argc, char** argv)
 	bench_map.add_attribute<Vec3, VERTEX>("normal");
 	bench_map.add_attribute<Vec3, VERTEX>("normal_mt");
 
+	if (numa)
+	{
+		if (!cgogn::thread_pool()->pin_workers())
+			cgogn_log_warning("bench_multithreading") << "The workers could not be pinned.";
+		bench_map.numa_first_touch();
+	}
+
 	::benchmark::RunSpecifiedBenchmarks();
 	return 0;
 }
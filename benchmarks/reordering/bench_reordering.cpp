@@ -0,0 +1,127 @@
+/*******************************************************************************
+* CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+* Copyright (C) 2015, IGG Group, ICube, University of Strasbourg, France       *
+*                                                                              *
+* This library is free software; you can redistribute it and/or modify it      *
+* under the terms of the GNU Lesser General Public License as published by the *
+* Free Software Foundation; either version 2.1 of the License, or (at your     *
+* option) any later version.                                                   *
+*                                                                              *
+* This library is distributed in the hope that it will be useful, but WITHOUT  *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+* for more details.                                                            *
+*                                                                              *
+* You should have received a copy of the GNU Lesser General Public License     *
+* along with this library; if not, write to the Free Software Foundation,      *
+* Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+*                                                                              *
+* Web site: http://cgogn.unistra.fr/                                           *
+* Contact information: cgogn@unistra.fr                                        *
+*                                                                              *
+*******************************************************************************/
+
+#include <cgogn/core/utils/logger.h>
+#include <cgogn/core/cmap/cmap2.h>
+#include <cgogn/io/map_import.h>
+#include <cgogn/geometry/algos/reorder.h>
+
+#include <benchmark/benchmark.h>
+
+#define DEFAULT_MESH_PATH CGOGN_STR(CGOGN_TEST_MESHES_PATH)
+
+using namespace cgogn::numerics;
+
+using Map2 = cgogn::CMap2;
+Map2 shuffled_map;
+Map2 bfs_map;
+Map2 morton_map;
+
+using Vertex = Map2::Vertex;
+
+template <typename T>
+using VertexAttribute = Map2::VertexAttribute<T>;
+
+using Vec3 = Eigen::Vector3d;
+
+// the darts are renumbered in a pseudo-random order, as after heavy remeshing
+static void shuffle(Map2& map)
+{
+	map.reorder([] (cgogn::Dart d) -> uint64
+	{
+		uint64 x = uint64(d.index) * 0x9e3779b97f4a7c15ull;
+		x ^= x >> 29;
+		return x * 0xbf58476d1ce4e5b9ull;
+	});
+}
+
+// the items are the traversed vertices
+static void traverse(benchmark::State& state, Map2& map)
+{
+	VertexAttribute<Vec3> vertex_position = map.get_attribute<Vec3, Vertex>("position");
+	cgogn_assert(vertex_position.is_valid());
+
+	std::size_t nb_vertices = 0u;
+	while(state.KeepRunning())
+	{
+		Vec3 sum(0, 0, 0);
+		map.foreach_cell([&] (Vertex v)
+		{
+			map.foreach_adjacent_vertex_through_edge(v, [&] (Vertex av)
+			{
+				sum += vertex_position[av] - vertex_position[v];
+			});
+			++nb_vertices;
+		});
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed(nb_vertices);
+}
+
+static void BENCH_traversal_shuffled(benchmark::State& state)
+{
+	traverse(state, shuffled_map);
+}
+
+static void BENCH_traversal_bfs_reordered(benchmark::State& state)
+{
+	traverse(state, bfs_map);
+}
+
+static void BENCH_traversal_morton_reordered(benchmark::State& state)
+{
+	traverse(state, morton_map);
+}
+
+BENCHMARK(BENCH_traversal_shuffled);
+BENCHMARK(BENCH_traversal_bfs_reordered);
+BENCHMARK(BENCH_traversal_morton_reordered);
+
+int main(int argc, char** argv)
+{
+	::benchmark::Initialize(&argc, argv);
+
+	std::string surface_mesh;
+	if (argc < 2)
+	{
+		cgogn_log_info("bench_reordering") << "USAGE: " << argv[0] << " [filename]";
+		surface_mesh = std::string(DEFAULT_MESH_PATH) + std::string("off/horse.off");
+		cgogn_log_info("bench_reordering") << "Using default mesh : \"" << surface_mesh << "\".";
+	}
+	else
+		surface_mesh = std::string(argv[1]);
+
+	for (Map2* map : { &shuffled_map, &bfs_map, &morton_map })
+	{
+		cgogn::io::import_surface<Vec3>(*map, surface_mesh);
+		shuffle(*map);
+	}
+
+	bfs_map.reorder();
+
+	VertexAttribute<Vec3> vertex_position = morton_map.get_attribute<Vec3, Vertex>("position");
+	cgogn::geometry::morton_reorder<Vec3>(morton_map, vertex_position);
+
+	::benchmark::RunSpecifiedBenchmarks();
+	return 0;
+}
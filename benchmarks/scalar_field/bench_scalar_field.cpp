@@ -0,0 +1,90 @@
+/*******************************************************************************
+* CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+* Copyright (C) 2015, IGG Group, ICube, University of Strasbourg, France       *
+*                                                                              *
+* This library is free software; you can redistribute it and/or modify it      *
+* under the terms of the GNU Lesser General Public License as published by the *
+* Free Software Foundation; either version 2.1 of the License, or (at your     *
+* option) any later version.                                                   *
+*                                                                              *
+* This library is distributed in the hope that it will be useful, but WITHOUT  *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+* for more details.                                                            *
+*                                                                              *
+* You should have received a copy of the GNU Lesser General Public License     *
+* along with this library; if not, write to the Free Software Foundation,      *
+* Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+*                                                                              *
+* Web site: http://cgogn.unistra.fr/                                           *
+* Contact information: cgogn@unistra.fr                                        *
+*                                                                              *
+*******************************************************************************/
+
+#include <cgogn/core/utils/logger.h>
+#include <cgogn/core/cmap/cmap3.h>
+#include <cgogn/io/map_import.h>
+#include <cgogn/topology/types/adjacency_cache.h>
+#include <cgogn/topology/algos/scalar_field.h>
+
+#include <benchmark/benchmark.h>
+
+#define DEFAULT_MESH_PATH CGOGN_STR(CGOGN_TEST_MESHES_PATH)
+
+using namespace cgogn::numerics;
+
+using Map3 = cgogn::CMap3;
+Map3 bench_map;
+cgogn::topology::AdjacencyCache<Map3> bench_cache(bench_map);
+
+using Vertex = Map3::Vertex;
+
+template <typename T>
+using VertexAttribute = Map3::VertexAttribute<T>;
+
+using Vec3 = Eigen::Vector3d;
+using Scalar = float64;
+
+static void BENCH_critical_vertex_analysis(benchmark::State& state)
+{
+	while(state.KeepRunning())
+	{
+		state.PauseTiming();
+		VertexAttribute<Scalar> height = bench_map.get_attribute<Scalar, Vertex>("height");
+		cgogn_assert(height.is_valid());
+		cgogn::topology::ScalarField<Scalar, Map3> scalar_field(bench_map, bench_cache, height);
+		state.ResumeTiming();
+
+		scalar_field.critical_vertex_analysis();
+	}
+}
+
+BENCHMARK(BENCH_critical_vertex_analysis)->UseRealTime();
+
+int main(int argc, char** argv)
+{
+	::benchmark::Initialize(&argc, argv);
+	std::string volumeMesh;
+
+	if (argc < 2)
+	{
+		cgogn_log_info("bench_scalar_field") << "USAGE: " << argv[0] << " [filename]";
+		volumeMesh = std::string(DEFAULT_MESH_PATH) + std::string("tet/hand.tet");
+		cgogn_log_info("bench_scalar_field") << "Using default mesh : \"" << volumeMesh << "\".";
+	}
+	else
+		volumeMesh = std::string(argv[1]);
+
+	cgogn::io::import_volume<Vec3>(bench_map, volumeMesh);
+
+	VertexAttribute<Vec3> position = bench_map.get_attribute<Vec3, Vertex>("position");
+	VertexAttribute<Scalar> height = bench_map.add_attribute<Scalar, Vertex>("height");
+	bench_map.foreach_cell([&] (Vertex v)
+	{
+		height[v] = position[v][2];
+	});
+	bench_cache.init();
+
+	::benchmark::RunSpecifiedBenchmarks();
+	return 0;
+}
@@ -0,0 +1,96 @@
+/*******************************************************************************
+* CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+* Copyright (C) 2015, IGG Group, ICube, University of Strasbourg, France       *
+*                                                                              *
+* This library is free software; you can redistribute it and/or modify it      *
+* under the terms of the GNU Lesser General Public License as published by the *
+* Free Software Foundation; either version 2.1 of the License, or (at your     *
+* option) any later version.                                                   *
+*                                                                              *
+* This library is distributed in the hope that it will be useful, but WITHOUT  *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+* for more details.                                                            *
+*                                                                              *
+* You should have received a copy of the GNU Lesser General Public License     *
+* along with this library; if not, write to the Free Software Foundation,      *
+* Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+*                                                                              *
+* Web site: http://cgogn.unistra.fr/                                           *
+* Contact information: cgogn@unistra.fr                                        *
+*                                                                              *
+*******************************************************************************/
+
+#include <cgogn/core/utils/logger.h>
+#include <cgogn/core/cmap/cmap2.h>
+#include <cgogn/io/map_import.h>
+#include <cgogn/modeling/algos/catmull_clark.h>
+#include <cgogn/modeling/algos/loop.h>
+
+#include <benchmark/benchmark.h>
+
+#define DEFAULT_MESH_PATH CGOGN_STR(CGOGN_TEST_MESHES_PATH)
+
+using namespace cgogn::numerics;
+
+using Map2 = cgogn::CMap2;
+Map2 bench_map;
+
+using Vertex = Map2::Vertex;
+
+template <typename T>
+using VertexAttribute = Map2::VertexAttribute<T>;
+
+using Vec3 = Eigen::Vector3d;
+
+std::string surface_mesh;
+
+static void BENCH_catmull_clark(benchmark::State& state)
+{
+	while(state.KeepRunning())
+	{
+		state.PauseTiming();
+		bench_map.clear_and_remove_attributes();
+		cgogn::io::import_surface<Vec3>(bench_map, surface_mesh);
+		VertexAttribute<Vec3> vertex_position = bench_map.get_attribute<Vec3, Vertex>("position");
+		cgogn_assert(vertex_position.is_valid());
+		state.ResumeTiming();
+
+		cgogn::modeling::catmull_clark<Vec3>(bench_map, vertex_position, uint32(state.range_x()));
+	}
+}
+
+static void BENCH_loop(benchmark::State& state)
+{
+	while(state.KeepRunning())
+	{
+		state.PauseTiming();
+		bench_map.clear_and_remove_attributes();
+		cgogn::io::import_surface<Vec3>(bench_map, surface_mesh);
+		VertexAttribute<Vec3> vertex_position = bench_map.get_attribute<Vec3, Vertex>("position");
+		cgogn_assert(vertex_position.is_valid());
+		state.ResumeTiming();
+
+		cgogn::modeling::loop<Vec3>(bench_map, vertex_position, uint32(state.range_x()));
+	}
+}
+
+BENCHMARK(BENCH_catmull_clark)->Arg(1)->Arg(2)->Arg(3)->UseRealTime();
+BENCHMARK(BENCH_loop)->Arg(1)->Arg(2)->Arg(3)->UseRealTime();
+
+int main(int argc, char** argv)
+{
+	::benchmark::Initialize(&argc, argv);
+
+	if (argc < 2)
+	{
+		cgogn_log_info("bench_subdivision") << "USAGE: " << argv[0] << " [filename]";
+		surface_mesh = std::string(DEFAULT_MESH_PATH) + std::string("off/horse.off");
+		cgogn_log_info("bench_subdivision") << "Using default mesh : \"" << surface_mesh << "\".";
+	}
+	else
+		surface_mesh = std::string(argv[1]);
+
+	::benchmark::RunSpecifiedBenchmarks();
+	return 0;
+}
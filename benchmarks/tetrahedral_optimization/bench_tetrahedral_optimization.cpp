@@ -0,0 +1,96 @@
+/*******************************************************************************
+* CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+* Copyright (C) 2015, IGG Group, ICube, University of Strasbourg, France       *
+*                                                                              *
+* This library is free software; you can redistribute it and/or modify it      *
+* under the terms of the GNU Lesser General Public License as published by the *
+* Free Software Foundation; either version 2.1 of the License, or (at your     *
+* option) any later version.                                                   *
+*                                                                              *
+* This library is distributed in the hope that it will be useful, but WITHOUT  *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+* for more details.                                                            *
+*                                                                              *
+* You should have received a copy of the GNU Lesser General Public License     *
+* along with this library; if not, write to the Free Software Foundation,      *
+* Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+*                                                                              *
+* Web site: http://cgogn.unistra.fr/                                           *
+* Contact information: cgogn@unistra.fr                                        *
+*                                                                              *
+*******************************************************************************/
+
+#include <random>
+
+#include <cgogn/core/utils/logger.h>
+#include <cgogn/core/cmap/cmap3.h>
+#include <cgogn/io/map_import.h>
+#include <cgogn/geometry/algos/bounding_box.h>
+#include <cgogn/modeling/algos/tetrahedral_optimization.h>
+
+#include <benchmark/benchmark.h>
+
+#define DEFAULT_MESH_PATH CGOGN_STR(CGOGN_TEST_MESHES_PATH)
+
+using namespace cgogn::numerics;
+
+using Map3 = cgogn::CMap3;
+Map3 bench_map;
+
+using Vertex = Map3::Vertex;
+
+template <typename T>
+using VertexAttribute = Map3::VertexAttribute<T>;
+
+using Vec3 = Eigen::Vector3d;
+
+std::string volume_mesh;
+
+// the inner vertices are moved by range_x thousandths of the bounding box diagonal, the items are the swaps
+static void BENCH_tetrahedral_swaps(benchmark::State& state)
+{
+	std::size_t nb_swaps = 0u;
+	while(state.KeepRunning())
+	{
+		state.PauseTiming();
+		bench_map.clear_and_remove_attributes();
+		cgogn::io::import_volume<Vec3>(bench_map, volume_mesh);
+		VertexAttribute<Vec3> vertex_position = bench_map.get_attribute<Vec3, Vertex>("position");
+		cgogn_assert(vertex_position.is_valid());
+
+		cgogn::geometry::AABB<Vec3> bb;
+		cgogn::geometry::compute_AABB(vertex_position, bb);
+		const float64 noise = bb.diag_size() * float64(state.range_x()) / 1000.0;
+		std::mt19937 generator(0u);
+		std::uniform_real_distribution<float64> distribution(-noise, noise);
+		bench_map.foreach_cell([&] (Vertex v)
+		{
+			if (!bench_map.is_incident_to_boundary(v))
+				vertex_position[v] += Vec3(distribution(generator), distribution(generator), distribution(generator));
+		});
+		state.ResumeTiming();
+
+		nb_swaps += cgogn::modeling::tetrahedral_swaps<Vec3>(bench_map, vertex_position, 0.4).nb_swaps();
+	}
+	state.SetItemsProcessed(nb_swaps);
+}
+
+BENCHMARK(BENCH_tetrahedral_swaps)->Arg(0)->Arg(2)->Arg(5)->UseRealTime();
+
+int main(int argc, char** argv)
+{
+	::benchmark::Initialize(&argc, argv);
+
+	if (argc < 2)
+	{
+		cgogn_log_info("bench_tetrahedral_optimization") << "USAGE: " << argv[0] << " [filename]";
+		volume_mesh = std::string(DEFAULT_MESH_PATH) + std::string("tet/horse.tet");
+		cgogn_log_info("bench_tetrahedral_optimization") << "Using default mesh : \"" << volume_mesh << "\".";
+	}
+	else
+		volume_mesh = std::string(argv[1]);
+
+	::benchmark::RunSpecifiedBenchmarks();
+	return 0;
+}
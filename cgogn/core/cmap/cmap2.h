@@ -134,6 +134,25 @@ public:
 		return result;
 	}
 
+	/**
+	 * @brief end the current topology transaction (see begin_topology_transaction):
+	 * the cells created since its beginning are given their attribute elements
+	 * @param traversors cell caches or quick traversors to update with the new cells
+	 */
+	template <typename... Traversors>
+	void commit_topology_transaction(Traversors&... traversors)
+	{
+		CGOGN_CHECK_CONCRETE_TYPE;
+		cgogn_message_assert(this->topology_transaction_, "commit_topology_transaction: no transaction in progress");
+
+		this->topology_transaction_ = false;
+		this->template commit_deferred_embeddings<CDart>(traversors...);
+		this->template commit_deferred_embeddings<Vertex>(traversors...);
+		this->template commit_deferred_embeddings<Edge>(traversors...);
+		this->template commit_deferred_embeddings<Face>(traversors...);
+		this->template commit_deferred_embeddings<Volume>(traversors...);
+	}
+
 	/*******************************************************************************
 	 * Low-level topological operations
 	 *******************************************************************************/
@@ -612,6 +631,49 @@ public:
 		return v;
 	}
 
+protected:
+
+	/**
+	 * @brief Remove a face of co-degree 2 by sewing together the two faces adjacent to it
+	 * @param d : a dart of the face
+	 * @return the dart of the resulting edge that was phi2-linked to d
+	 */
+	inline Dart collapse_degenerated_face_topo(Dart d)
+	{
+		cgogn_message_assert(this->phi1(this->phi1(d)) == d, "collapse_degenerated_face: the face of d should have co-degree 2");
+
+		const Dart d1 = this->phi1(d);
+		const Dart e = phi2(d);
+		const Dart e1 = phi2(d1);
+		phi2_unsew(d);
+		phi2_unsew(d1);
+		phi2_sew(e, e1);
+		this->Inherit::remove_face_topo(d);
+
+		return e;
+	}
+
+public:
+
+	/**
+	 * @brief Remove a face of co-degree 2 (e.g. a triangle after the collapse of one of its edges)
+	 * @param f : the face to remove
+	 * @return the edge resulting from the merge of the two edges of f
+	 * If the map has Edge attributes, the attributes of the edge of phi2(f.dart) are kept.
+	 */
+	inline Edge collapse_degenerated_face(Face f)
+	{
+		CGOGN_CHECK_CONCRETE_TYPE;
+		cgogn_message_assert(!is_boundary_cell(f), "collapse_degenerated_face: should not remove a boundary face");
+
+		const Dart e = collapse_degenerated_face_topo(f.dart);
+
+		if (this->template is_embedded<Edge>())
+			this->template copy_embedding<Edge>(phi2(e), e);
+
+		return Edge(e);
+	}
+
 protected:
 
 	inline void split_vertex_topo(Dart d, Dart e)
@@ -1127,6 +1189,46 @@ public:
 		return true;
 	}
 
+	/**
+	 * @brief Check if the collapse of an edge preserves the manifoldness of the surface
+	 * @param e : an edge incident to two triangles
+	 * @return true if the opposite vertices of the triangles have a degree greater than 3
+	 * and are the only common neighbors of the vertices of e (link condition)
+	 * The map must have an embedding on vertices.
+	 */
+	bool edge_can_collapse(Edge e) const
+	{
+		cgogn_message_assert(this->template is_embedded<Vertex>(), "edge_can_collapse: the vertices must be embedded");
+
+		const Dart d = e.dart;
+		const Dart d2 = phi2(d);
+		if (this->is_boundary(d) || this->is_boundary(d2) || codegree(Face(d)) != 3u || codegree(Face(d2)) != 3u)
+			return false;
+
+		const Dart c = this->phi_1(d);
+		const Dart x = this->phi_1(d2);
+		if (degree(Vertex(c)) <= 3u || degree(Vertex(x)) <= 3u)
+			return false;
+
+		const uint32 vc = this->embedding(Vertex(c));
+		const uint32 vx = this->embedding(Vertex(x));
+		bool result = true;
+		foreach_dart_of_orbit(Vertex(d), [&] (Dart da) -> bool
+		{
+			const uint32 na = this->embedding(Vertex(this->phi1(da)));
+			if (na != vc && na != vx)
+			{
+				foreach_dart_of_orbit(Vertex(d2), [&] (Dart db) -> bool
+				{
+					result = this->embedding(Vertex(this->phi1(db))) != na;
+					return result;
+				});
+			}
+			return result;
+		});
+		return result;
+	}
+
 	/*******************************************************************************
 	 * Boundary information
 	 *******************************************************************************/
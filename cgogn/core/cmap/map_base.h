@@ -24,8 +24,10 @@
 #ifndef CGOGN_CORE_CMAP_MAP_BASE_H_
 #define CGOGN_CORE_CMAP_MAP_BASE_H_
 
+#include <algorithm>
 #include <vector>
 #include <memory>
+#include <initializer_list>
 
 #include <cgogn/core/utils/masks.h>
 #include <cgogn/core/utils/logger.h>
@@ -154,7 +156,9 @@ protected:
 	 */
 	inline Dart add_topology_element()
 	{
-		const uint32 idx = this->topology_.template insert_lines<ConcreteMap::PRIM_SIZE>();
+		const uint32 idx = this->concurrent_editing_ ?
+			this->topology_.template insert_lines_concurrent<ConcreteMap::PRIM_SIZE>(this->concurrent_slot()) :
+			this->topology_.template insert_lines<ConcreteMap::PRIM_SIZE>();
 		for(uint32 jdx = idx; jdx < idx + ConcreteMap::PRIM_SIZE; ++jdx)
 		{
 			this->topology_.init_markers_of_line(jdx);
@@ -194,7 +198,10 @@ protected:
 	inline void remove_topology_element(Dart d)
 	{
 		uint32 index = d.index;
-		this->topology_.template remove_lines<ConcreteMap::PRIM_SIZE>(index);
+		if (this->concurrent_editing_)
+			this->topology_.template remove_lines_concurrent<ConcreteMap::PRIM_SIZE>(index, this->concurrent_slot());
+		else
+			this->topology_.template remove_lines<ConcreteMap::PRIM_SIZE>(index);
 
 		for(uint32 orbit = 0; orbit < NB_ORBITS; ++orbit)
 		{
@@ -204,7 +211,7 @@ protected:
 				{
 					uint32 emb = (*this->embeddings_[orbit])[jdx];
 					if (emb != INVALID_INDEX)
-						this->attributes_[orbit].unref_line(emb);
+						this->unref_attribute_line(Orbit(orbit), emb);
 				}
 			}
 		}
@@ -215,7 +222,9 @@ protected:
 	{
 		static_assert(ORBIT < NB_ORBITS, "Unknown orbit parameter");
 
-		uint32 idx = this->attributes_[ORBIT].template insert_lines<1>();
+		uint32 idx = this->concurrent_editing_ ?
+			this->attributes_[ORBIT].template insert_lines_concurrent<1>(this->concurrent_slot()) :
+			this->attributes_[ORBIT].template insert_lines<1>();
 		this->attributes_[ORBIT].init_markers_of_line(idx);
 		return idx;
 	}
@@ -225,7 +234,10 @@ protected:
 	{
 		static_assert(ORBIT < NB_ORBITS,  "Unknown orbit parameter");
 
-		this->attributes_[ORBIT].template remove_lines<1>(index);
+		if (this->concurrent_editing_)
+			this->attributes_[ORBIT].template remove_lines_concurrent<1>(index, this->concurrent_slot());
+		else
+			this->attributes_[ORBIT].template remove_lines<1>(index);
 	}
 
 public:
@@ -427,8 +439,11 @@ protected:
 		// initialize all darts indices to INVALID_INDEX for this ORBIT
 		foreach_dart([ca] (Dart d) { (*ca)[d.index] = INVALID_INDEX; });
 
-		// initialize the indices of the existing orbits
-		foreach_cell<FORCE_DART_MARKING>([this] (Cell<ORBIT> c) { this->new_orbit_embedding(c); });
+		// initialize the indices of the existing orbits (never deferred, even inside a topology transaction)
+		foreach_cell<FORCE_DART_MARKING>([this] (Cell<ORBIT> c)
+		{
+			this->template set_orbit_embedding<Cell<ORBIT>>(c, this->template add_attribute_element<ORBIT>());
+		});
 
 		cgogn_assert(this->template is_well_embedded<Cell<ORBIT>>());
 	}
@@ -448,10 +463,19 @@ protected:
 	/**
 	 * \brief creates a new embedding and set it to the darts of the given cell
 	 * \return the new index
+	 * Inside a topology transaction, the cell is only recorded as waiting for its embedding
+	 * (its dart is unindexed) and INVALID_INDEX is returned.
 	 */
 	template <Orbit ORBIT>
 	inline uint32 new_orbit_embedding(Cell<ORBIT> c)
 	{
+		if (this->topology_transaction_)
+		{
+			this->template unset_embedding<Cell<ORBIT>>(c.dart);
+			this->deferred_orbits_ |= (1u << ORBIT);
+			return INVALID_INDEX;
+		}
+
 		const uint32 emb = add_attribute_element<ORBIT>();
 		set_orbit_embedding<Cell<ORBIT>>(c, emb);
 		return emb;
@@ -467,6 +491,7 @@ public:
 	{
 		static_assert(ORBIT < NB_ORBITS, "Unknown orbit parameter");
 		cgogn_message_assert(this->template is_embedded<ORBIT>(), "Invalid parameter: orbit not embedded");
+		cgogn_message_assert(!this->topology_transaction_, "enforce_unique_orbit_embedding: topology transaction in progress");
 
 		Attribute<uint32, ORBIT> counter = add_attribute<uint32, ORBIT>("__tmp_counter");
 		for (uint32& i : counter) i = 0;
@@ -588,6 +613,32 @@ public:
 		return true;
 	}
 
+	/*******************************************************************************
+	 * Memory reservation
+	 *******************************************************************************/
+
+	/**
+	 * \brief allocate the memory needed by the darts of indices lower than nb
+	 * Algorithms that create many darts can avoid incremental allocations
+	 * @param nb number of darts
+	 */
+	inline void reserve_darts(uint32 nb)
+	{
+		this->topology_.reserve(nb);
+	}
+
+	/**
+	 * \brief allocate the memory needed by the cells (of an embedded orbit) of indices lower than nb
+	 * @param nb number of cells
+	 */
+	template <class CellType>
+	inline void reserve_cells(uint32 nb)
+	{
+		static const Orbit ORBIT = CellType::ORBIT;
+		if (this->template is_embedded<ORBIT>())
+			this->template attribute_container<ORBIT>().reserve(nb);
+	}
+
 	/*******************************************************************************
 	 * Topological information
 	 *******************************************************************************/
@@ -851,6 +902,20 @@ public:
 		static_assert(is_ith_func_parameter_same<FUNC, 0, Dart>::value, "Wrong function first parameter type");
 		static_assert(is_ith_func_parameter_same<FUNC, 1, uint32>::value, "Wrong function second parameter type");
 
+		// each range of darts is given to the worker that owns it
+		if (this->numa_aware_)
+		{
+			parallel_foreach_owned_chunk(this->topology_.end(), CHUNK_SIZE, [&] (uint32 first, uint32 last, uint32 th_id)
+			{
+				for (uint32 i = first; i < last; ++i)
+				{
+					if (this->topology_.used(i))
+						f(Dart(i), th_id);
+				}
+			});
+			return;
+		}
+
 		using Future = std::future<typename std::result_of<FUNC(Dart, uint32)>::type>;
 		using VecDarts = std::vector<Dart>;
 
@@ -1195,6 +1260,28 @@ public:
 
 protected:
 
+	/**
+	 * @brief the number of buffers that are processed before waiting for the first ones
+	 * (in NUMA-aware mode, enough buffers to cover one chunk per worker)
+	 */
+	inline std::size_t nb_parallel_buffers(ThreadPool* pool) const
+	{
+		const std::size_t nb_buffers_per_chunk = CHUNK_SIZE > PARALLEL_BUFFER_SIZE ? CHUNK_SIZE / PARALLEL_BUFFER_SIZE : 1u;
+		return this->numa_aware_ ? pool->nb_threads() * nb_buffers_per_chunk : pool->nb_threads();
+	}
+
+	/**
+	 * @brief enqueue the processing of a buffer that begins at the dart of the given index
+	 * (in NUMA-aware mode, on the worker that owns the chunk of this dart)
+	 */
+	template <typename FUNC>
+	inline std::future<void> enqueue_buffer(ThreadPool* pool, uint32 first_index, const FUNC& f) const
+	{
+		if (this->numa_aware_)
+			return pool->enqueue_on(chunk_owner(first_index / CHUNK_SIZE, uint32(pool->nb_threads())), f);
+		return pool->enqueue(f);
+	}
+
 	template <typename FUNC, typename FilterFunction>
 	inline void parallel_foreach_cell_dart_marking(const FUNC& f, const FilterFunction& filter) const
 	{
@@ -1204,14 +1291,14 @@ protected:
 		using Future = std::future<typename std::result_of<FUNC(CellType, uint32)>::type>;
 
 		ThreadPool* thread_pool = cgogn::thread_pool();
-		const std::size_t nb_threads_pool = thread_pool->nb_threads();
+		const std::size_t nb_buffers = nb_parallel_buffers(thread_pool);
 
 		std::array<std::vector<VecCell*>, 2> cells_buffers;
 		std::array<std::vector<Future>, 2> futures;
-		cells_buffers[0].reserve(nb_threads_pool);
-		cells_buffers[1].reserve(nb_threads_pool);
-		futures[0].reserve(nb_threads_pool);
-		futures[1].reserve(nb_threads_pool);
+		cells_buffers[0].reserve(nb_buffers);
+		cells_buffers[1].reserve(nb_buffers);
+		futures[0].reserve(nb_buffers);
+		futures[1].reserve(nb_buffers);
 
 		Buffers<Dart>* dbuffs = cgogn::dart_buffers();
 
@@ -1221,10 +1308,11 @@ protected:
 		Dart last = cmap->end();
 
 		uint32 i = 0u; // buffer id (0/1)
-		uint32 j = 0u; // thread id (0..nb_threads_pool)
+		uint32 j = 0u; // buffer index (0..nb_buffers)
 		while (it.index < last.index)
 		{
 			// fill buffer
+			const uint32 first_index = it.index;
 			cells_buffers[i].push_back(dbuffs->template cell_buffer<CellType>());
 			VecCell& cells = *cells_buffers[i].back();
 			cells.reserve(PARALLEL_BUFFER_SIZE);
@@ -1243,13 +1331,13 @@ protected:
 				cmap->next(it);
 			}
 			//launch thread
-			futures[i].push_back(thread_pool->enqueue([&cells, &f] (uint32 th_id)
+			futures[i].push_back(enqueue_buffer(thread_pool, first_index, [&cells, &f] (uint32 th_id)
 			{
 				for (auto c : cells)
 					f(c, th_id);
 			}));
 			// next thread
-			if (++j == nb_threads_pool)
+			if (++j == nb_buffers)
 			{	// again from 0 & change buffer
 				j = 0;
 				i = (i+1u) % 2u;
@@ -1283,14 +1371,14 @@ protected:
 		using Future = std::future<typename std::result_of<FUNC(CellType, uint32)>::type>;
 
 		ThreadPool* thread_pool = cgogn::thread_pool();
-		const std::size_t nb_threads_pool = thread_pool->nb_threads();
+		const std::size_t nb_buffers = nb_parallel_buffers(thread_pool);
 
 		std::array<std::vector<VecCell*>, 2> cells_buffers;
 		std::array<std::vector<Future>, 2> futures;
-		cells_buffers[0].reserve(nb_threads_pool);
-		cells_buffers[1].reserve(nb_threads_pool);
-		futures[0].reserve(nb_threads_pool);
-		futures[1].reserve(nb_threads_pool);
+		cells_buffers[0].reserve(nb_buffers);
+		cells_buffers[1].reserve(nb_buffers);
+		futures[0].reserve(nb_buffers);
+		futures[1].reserve(nb_buffers);
 
 		Buffers<Dart>* dbuffs = cgogn::dart_buffers();
 
@@ -1300,10 +1388,11 @@ protected:
 		Dart last = cmap->end();
 
 		uint32 i = 0u; // buffer id (0/1)
-		uint32 j = 0u; // thread id (0..nb_threads_pool)
+		uint32 j = 0u; // buffer index (0..nb_buffers)
 		while (it.index < last.index)
 		{
 			// fill buffer
+			const uint32 first_index = it.index;
 			cells_buffers[i].push_back(dbuffs->template cell_buffer<CellType>());
 			VecCell& cells = *cells_buffers[i].back();
 			cells.reserve(PARALLEL_BUFFER_SIZE);
@@ -1322,13 +1411,13 @@ protected:
 				cmap->next(it);
 			}
 			// launch thread
-			futures[i].push_back(thread_pool->enqueue([&cells, &f] (uint32 th_id)
+			futures[i].push_back(enqueue_buffer(thread_pool, first_index, [&cells, &f] (uint32 th_id)
 			{
 				for (auto c : cells)
 					f(c, th_id);
 			}));
 			// next thread
-			if (++j == nb_threads_pool)
+			if (++j == nb_buffers)
 			{	// again from 0 & change buffer
 				j = 0;
 				i = (i+1u) % 2u;
@@ -1405,40 +1494,45 @@ public:
 		ChunkArray<uint32>* embedding = this->embeddings_[orbit];
 		if (embedding != nullptr)
 		{
-			std::vector<uint32> old_new = this->attributes_[orbit].template compact<1>();
+			const std::vector<uint32> old_new = this->attributes_[orbit].template compact<1>();
 			if (!old_new.empty())
 			{
-				for (uint32 i=this->topology_.begin(); i!= this->topology_.end(); this->topology_.next(i))
+				parallel_foreach_chunk(this->topology_.end(), PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
 				{
-					uint32& emb = (*embedding)[i];
-					if ((emb != std::numeric_limits<uint32>::max())
-						&& (old_new[emb] != std::numeric_limits<uint32>::max()))
-						emb = old_new[emb];
-				}
+					for (uint32 i = first; i < last; ++i)
+					{
+						if (!this->topology_.used(i))
+							continue;
+						uint32& emb = (*embedding)[i];
+						if ((emb != std::numeric_limits<uint32>::max())
+							&& (old_new[emb] != std::numeric_limits<uint32>::max()))
+							emb = old_new[emb];
+					}
+				});
 			}
 		}
 	}
 
 	void compact_topo()
 	{
-		std::vector<uint32> old_new = this->topology_.template compact<ConcreteMap::PRIM_SIZE>();
+		const std::vector<uint32> old_new = this->topology_.template compact<ConcreteMap::PRIM_SIZE>();
 
 		if (old_new.empty())
 			return;			// already compact nothing to do with relationss
 
-		for (ChunkArrayGen* ptr: this->topology_.chunk_arrays())
+		// the topology is now compact: all the lines of [0,end()) are used
+		for (ChunkArray<Dart>* ca : topology_relations())
 		{
-			ChunkArray<Dart>* ca = dynamic_cast<ChunkArray<Dart>*>(ptr);
-			if (ca)
+			parallel_foreach_chunk(this->topology_.end(), PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
 			{
-				for (uint32 i=this->topology_.begin(); i!= this->topology_.end(); this->topology_.next(i))
+				for (uint32 i = first; i < last; ++i)
 				{
 					Dart& d = (*ca)[i];
-					uint32 idx = d.index;
+					const uint32 idx = d.index;
 					if (old_new[idx] != std::numeric_limits<uint32>::max())
 						d = Dart(old_new[idx]);
 				}
-			}
+			});
 		}
 	}
 
@@ -1452,6 +1546,343 @@ public:
 			compact_embedding(orbit); // checking if embedding used done inside
 	}
 
+	/*******************************************************************************
+	 * Topology transactions
+	 *******************************************************************************/
+
+	/**
+	 * @brief start a topology transaction: until commit_topology_transaction() (see the concrete maps),
+	 * the cells created by the topological operations are not given their attribute elements
+	 * @details the operations only unindex one dart of each new cell, instead of creating an element
+	 * and walking the orbit; the attributes of the new cells must not be accessed before the commit.
+	 * Meant for the operations that create cells (cut_edge, cut_face, flip_edge, add_face...), called
+	 * in large numbers by subdivision and remeshing algorithms.
+	 */
+	inline void begin_topology_transaction()
+	{
+		cgogn_message_assert(!this->topology_transaction_, "begin_topology_transaction: a transaction is already in progress");
+		this->topology_transaction_ = true;
+	}
+
+	inline bool in_topology_transaction() const
+	{
+		return this->topology_transaction_;
+	}
+
+	/*******************************************************************************
+	 * Concurrent editing
+	 *******************************************************************************/
+
+	/**
+	 * @brief start a concurrent editing section: until end_concurrent_editing(), the threads registered
+	 * in the map (the workers of the thread pool are) may apply local topological operations at the same
+	 * time, provided that they work on disjoint regions
+	 * @param nb_new_darts upper bound of the number of darts, and of cells of each embedded orbit,
+	 * created during the section
+	 * @details each thread takes its new darts and attribute elements from its own blocks of lines
+	 * and keeps the removed ones until the end of the section, where they become holes.
+	 * Two regions are disjoint when no dart and no attribute element is read or written from both
+	 * (an embedded cell on their border has its reference counter updated from both).
+	 * Creating attributes or markers, traversing the whole map and compacting are not allowed
+	 * during the section.
+	 */
+	void begin_concurrent_editing(uint32 nb_new_darts)
+	{
+		cgogn_message_assert(!this->concurrent_editing_, "begin_concurrent_editing: a section is already in progress");
+
+		const uint32 nb_slots = uint32(this->thread_ids_.size());
+		this->topology_.template begin_concurrent_insertions<ConcreteMap::PRIM_SIZE>(nb_slots, nb_new_darts);
+		for (uint32 orbit = 0u; orbit < NB_ORBITS; ++orbit)
+		{
+			if (this->embeddings_[orbit])
+				this->attributes_[orbit].template begin_concurrent_insertions<1>(nb_slots, nb_new_darts);
+		}
+		this->concurrent_editing_ = true;
+	}
+
+	void end_concurrent_editing()
+	{
+		cgogn_message_assert(this->concurrent_editing_, "end_concurrent_editing: no section in progress");
+
+		this->topology_.template end_concurrent_insertions<ConcreteMap::PRIM_SIZE>();
+		for (uint32 orbit = 0u; orbit < NB_ORBITS; ++orbit)
+		{
+			if (this->attributes_[orbit].in_concurrent_insertions())
+				this->attributes_[orbit].template end_concurrent_insertions<1>();
+		}
+		this->concurrent_editing_ = false;
+	}
+
+	inline bool in_concurrent_editing() const
+	{
+		return this->concurrent_editing_;
+	}
+
+	/*******************************************************************************
+	 * NUMA placement
+	 *******************************************************************************/
+
+	/**
+	 * @brief switch this map to the NUMA-aware mode: each chunk of the topology and attribute containers
+	 * is reallocated, and thus first touched, by the worker of the thread pool that owns its range of indices
+	 * (see chunk_owner), and the parallel traversals then give each range of darts to its owner
+	 * @details to be called once the map is built (the chunks added later are touched by the thread
+	 * that adds them) and preferably after thread_pool()->pin_workers()
+	 */
+	void numa_first_touch()
+	{
+		this->topology_.first_touch();
+		for (uint32 orbit = 0u; orbit < NB_ORBITS; ++orbit)
+			this->attributes_[orbit].first_touch();
+		this->numa_aware_ = true;
+	}
+
+	inline bool is_numa_aware() const
+	{
+		return this->numa_aware_;
+	}
+
+	/*******************************************************************************
+	 * reordering
+	 *******************************************************************************/
+
+	/**
+	 * @brief renumber the darts and the cells of this map so that the darts that are
+	 * neighbors in the topology are close in memory
+	 * @details the map is compacted, then its primitives (groups of PRIM_SIZE darts) are numbered
+	 * by a breadth first traversal of the topological relations (a Cuthill-McKee order as all the
+	 * darts have the same degree) and the cells of each embedded orbit are numbered in the order
+	 * of their first dart
+	 */
+	void reorder()
+	{
+		compact();
+
+		const uint32 nb_lines = this->topology_.end();
+		const uint32 prim_size = uint32(ConcreteMap::PRIM_SIZE);
+		const std::vector<ChunkArray<Dart>*> relations = topology_relations();
+
+		std::vector<uint32> old_new(nb_lines, INVALID_INDEX);
+		std::vector<uint32> queue;
+		queue.reserve(nb_lines / prim_size);
+		uint32 nb_numbered = 0u;
+		auto number = [&] (uint32 prim)
+		{
+			for (uint32 k = 0u; k < prim_size; ++k)
+				old_new[prim + k] = nb_numbered++;
+			queue.push_back(prim);
+		};
+
+		std::size_t head = 0u;
+		for (uint32 seed = 0u; seed < nb_lines; seed += prim_size)
+		{
+			if (old_new[seed] != INVALID_INDEX)
+				continue;
+			number(seed);
+			while (head < queue.size())
+			{
+				const uint32 prim = queue[head++];
+				for (uint32 k = 0u; k < prim_size; ++k)
+				{
+					for (ChunkArray<Dart>* rel : relations)
+					{
+						const uint32 n = (*rel)[prim + k].index;
+						const uint32 n_prim = n - n % prim_size;
+						if (old_new[n_prim] == INVALID_INDEX)
+							number(n_prim);
+					}
+				}
+			}
+		}
+
+		permute_topo(old_new);
+	}
+
+	/**
+	 * @brief renumber the darts and the cells of this map in the order of the given keys
+	 * @param dart_key a function that gives the key (uint64) of a dart
+	 * (e.g. the Morton code of the position of its vertex)
+	 * @details the map is compacted, then its primitives (groups of PRIM_SIZE darts) are sorted
+	 * by the key of their first dart (the keys are computed in parallel) and the cells of
+	 * each embedded orbit are numbered in the order of their first dart
+	 */
+	template <typename FUNC>
+	void reorder(const FUNC& dart_key)
+	{
+		static_assert(is_func_parameter_same<FUNC, Dart>::value, "Wrong function parameter type");
+
+		compact();
+
+		const uint32 nb_lines = this->topology_.end();
+		const uint32 prim_size = uint32(ConcreteMap::PRIM_SIZE);
+		const uint32 nb_prims = nb_lines / prim_size;
+
+		std::vector<std::pair<uint64, uint32>> keys(nb_prims);
+		parallel_foreach_chunk(nb_prims, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+		{
+			for (uint32 p = first; p < last; ++p)
+				keys[p] = std::make_pair(uint64(dart_key(Dart(p * prim_size))), p);
+		});
+		std::sort(keys.begin(), keys.end());
+
+		std::vector<uint32> old_new(nb_lines);
+		for (uint32 i = 0u; i < nb_prims; ++i)
+			for (uint32 k = 0u; k < prim_size; ++k)
+				old_new[keys[i].second * prim_size + k] = i * prim_size + k;
+
+		permute_topo(old_new);
+	}
+
+protected:
+
+	/**
+	 * @brief give their attribute elements to the cells of CellType created during the topology
+	 * transaction that is being committed, and report them to the given cell traversors (see add_cells)
+	 * @details a new cell is found from its unindexed darts (a parallel scan of the darts) and is
+	 * represented by the smallest of them; the elements are created in bulk, then the orbits are
+	 * indexed in parallel and the indices that their darts held are released at the end.
+	 */
+	template <typename CellType, typename... Traversors>
+	void commit_deferred_embeddings(Traversors&... traversors)
+	{
+		static const Orbit ORBIT = CellType::ORBIT;
+		cgogn_message_assert(!this->topology_transaction_, "commit_deferred_embeddings: the transaction must be closed");
+
+		if (!this->template is_embedded<ORBIT>() || (this->deferred_orbits_ & (1u << ORBIT)) == 0u)
+			return;
+		this->deferred_orbits_ &= ~(1u << ORBIT);
+
+		const ConcreteMap* cmap = to_concrete();
+		ChunkArray<uint32>& embedding = *this->embeddings_[ORBIT];
+		ChunkArrayContainer<uint32>& container = this->attributes_[ORBIT];
+		const uint32 nb_lines = this->topology_.end();
+
+		// one dart per new cell (boundary cells are not embedded)
+		std::vector<std::vector<Dart>> range_cells((nb_lines + PARALLEL_BUFFER_SIZE - 1u) / PARALLEL_BUFFER_SIZE);
+		parallel_foreach_chunk(nb_lines, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+		{
+			std::vector<Dart>& cells = range_cells[first / PARALLEL_BUFFER_SIZE];
+			for (uint32 i = first; i < last; ++i)
+			{
+				if (!this->topology_.used(i) || embedding[i] != INVALID_INDEX)
+					continue;
+				const CellType c = CellType(Dart(i));
+				if (this->is_boundary_cell(c))
+					continue;
+				bool smallest = true;
+				cmap->foreach_dart_of_orbit(c, [&] (Dart d) -> bool
+				{
+					smallest = d.index >= i || embedding[d.index] != INVALID_INDEX;
+					return smallest;
+				});
+				if (smallest)
+					cells.push_back(c.dart);
+			}
+		});
+
+		std::vector<Dart> cells;
+		for (const std::vector<Dart>& rc : range_cells)
+			cells.insert(cells.end(), rc.begin(), rc.end());
+		const uint32 nb_cells = uint32(cells.size());
+
+		container.reserve(container.end() + nb_cells);
+		std::vector<uint32> elements(nb_cells);
+		for (uint32& e : elements)
+			e = this->template add_attribute_element<ORBIT>();
+
+		std::vector<std::vector<uint32>> released((nb_cells + PARALLEL_BUFFER_SIZE - 1u) / PARALLEL_BUFFER_SIZE);
+		parallel_foreach_chunk(nb_cells, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+		{
+			std::vector<uint32>& old_indices = released[first / PARALLEL_BUFFER_SIZE];
+			for (uint32 i = first; i < last; ++i)
+			{
+				const uint32 emb = elements[i];
+				cmap->foreach_dart_of_orbit(CellType(cells[i]), [&] (Dart d)
+				{
+					uint32& old = embedding[d.index];
+					if (old != INVALID_INDEX)
+						old_indices.push_back(old);
+					old = emb;
+					container.ref_line(emb);	// the elements are distinct: no concurrent access
+				});
+			}
+		});
+		for (const std::vector<uint32>& old_indices : released)
+			for (uint32 old : old_indices)
+				container.unref_line(old);
+
+		unused_parameters(std::initializer_list<int>{ 0, (traversors.template add_cells<CellType>(cells), 0)... });
+	}
+
+	inline std::vector<ChunkArray<Dart>*> topology_relations()
+	{
+		std::vector<ChunkArray<Dart>*> relations;
+		for (ChunkArrayGen* ptr : this->topology_.chunk_arrays())
+		{
+			ChunkArray<Dart>* ca = dynamic_cast<ChunkArray<Dart>*>(ptr);
+			if (ca)
+				relations.push_back(ca);
+		}
+		return relations;
+	}
+
+	/**
+	 * @brief renumber the darts of this (compact) map, then the cells of each embedded orbit
+	 * in the order of their first dart (the cells without dart are put at the end)
+	 * @param old_new the new index of each dart
+	 */
+	void permute_topo(const std::vector<uint32>& old_new)
+	{
+		const uint32 nb_lines = this->topology_.end();
+
+		this->topology_.permute(old_new);
+		for (ChunkArray<Dart>* rel : topology_relations())
+		{
+			parallel_foreach_chunk(nb_lines, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+			{
+				for (uint32 i = first; i < last; ++i)
+				{
+					Dart& d = (*rel)[i];
+					d = Dart(old_new[d.index]);
+				}
+			});
+		}
+
+		for (uint32 orbit = 0u; orbit < NB_ORBITS; ++orbit)
+		{
+			ChunkArray<uint32>* embedding = this->embeddings_[orbit];
+			if (embedding == nullptr)
+				continue;
+
+			std::vector<uint32> emb_old_new(this->attributes_[orbit].end(), INVALID_INDEX);
+			uint32 nb_numbered = 0u;
+			for (uint32 i = 0u; i < nb_lines; ++i)
+			{
+				const uint32 emb = (*embedding)[i];
+				if (emb != INVALID_INDEX && emb_old_new[emb] == INVALID_INDEX)
+					emb_old_new[emb] = nb_numbered++;
+			}
+			for (uint32& emb : emb_old_new)
+			{
+				if (emb == INVALID_INDEX)
+					emb = nb_numbered++;
+			}
+
+			this->attributes_[orbit].permute(emb_old_new);
+			parallel_foreach_chunk(nb_lines, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+			{
+				for (uint32 i = first; i < last; ++i)
+				{
+					uint32& emb = (*embedding)[i];
+					if (emb != INVALID_INDEX)
+						emb = emb_old_new[emb];
+				}
+			});
+		}
+	}
+
+public:
+
 	/**
 	 * @brief merge map in this map
 	 * @param map must be of same type than map
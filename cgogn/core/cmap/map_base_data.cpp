@@ -64,6 +64,10 @@ MapBaseData::MapBaseData()
 		mark_attributes_topology_[i].reserve(8u);
 
 	boundary_marker_ = topology_.add_marker_attribute();
+	numa_aware_ = false;
+	topology_transaction_ = false;
+	deferred_orbits_ = 0u;
+	concurrent_editing_ = false;
 
 	thread_ids_.reserve(NB_UNKNOWN_THREADS + 2u*MAX_NB_THREADS);
 	thread_ids_.resize(NB_UNKNOWN_THREADS);
@@ -92,6 +92,17 @@ protected:
 	// boundary marker shortcut
 	ChunkArrayBool* boundary_marker_;
 
+	// the chunks have been first touched by their owner worker (see MapBase::numa_first_touch)
+	bool numa_aware_;
+
+	// topology transaction in progress: the new cells are not indexed until the commit
+	bool topology_transaction_;
+	// mask of the orbits that have cells waiting for their embedding
+	uint32 deferred_orbits_;
+
+	// concurrent editing section in progress (see MapBase::begin_concurrent_editing)
+	bool concurrent_editing_;
+
 	// vector of available mark attributes per thread on the topology container
 	std::vector<std::vector<ChunkArrayBool*>> mark_attributes_topology_;
 	std::mutex mark_attributes_topology_mutex_;
@@ -248,6 +259,26 @@ public:
 
 protected:
 
+	/**
+	 * \brief decrement the reference counter of an attribute element
+	 * (from the slot of the calling thread in a concurrent editing section)
+	 */
+	inline void unref_attribute_line(Orbit orbit, uint32 index)
+	{
+		if (concurrent_editing_)
+			attributes_[orbit].unref_line_concurrent(index, concurrent_slot());
+		else
+			attributes_[orbit].unref_line(index);
+	}
+
+	/**
+	 * \brief slot of the calling thread in the containers during a concurrent editing section
+	 */
+	inline uint32 concurrent_slot() const
+	{
+		return uint32(current_thread_index());
+	}
+
 	template <class CellType>
 	inline void set_embedding(Dart d, uint32 emb)
 	{
@@ -261,18 +292,45 @@ protected:
 		// ref_line() is done before unref_line() to avoid deleting the indexed line if old == emb
 		attributes_[ORBIT].ref_line(emb);			// ref the new emb
 		if (old != INVALID_INDEX)
-			attributes_[ORBIT].unref_line(old);		// unref the old emb
+			unref_attribute_line(ORBIT, old);		// unref the old emb
 
 		(*embeddings_[ORBIT])[d.index] = emb;		// affect the embedding to the dart
 	}
 
+	/**
+	 * \brief removes the embedding of the dart d (its orbit is waiting for a new one)
+	 */
+	template <class CellType>
+	inline void unset_embedding(Dart d)
+	{
+		static const Orbit ORBIT = CellType::ORBIT;
+		static_assert(ORBIT < NB_ORBITS, "Unknown orbit parameter");
+		cgogn_message_assert(is_embedded<ORBIT>(), "Invalid parameter: orbit not embedded");
+
+		uint32& emb = (*embeddings_[ORBIT])[d.index];
+		if (emb != INVALID_INDEX)
+		{
+			unref_attribute_line(ORBIT, emb);
+			emb = INVALID_INDEX;
+		}
+	}
+
 	template <class CellType>
 	inline void copy_embedding(Dart dest, Dart src)
 	{
 		static const Orbit ORBIT = CellType::ORBIT;
 		static_assert(ORBIT < NB_ORBITS, "Unknown orbit parameter");
+		cgogn_message_assert(is_embedded<ORBIT>(), "Invalid parameter: orbit not embedded");
 
-		this->template set_embedding<CellType>(dest, embedding(CellType(src)));
+		const uint32 emb = (*embeddings_[ORBIT])[src.index];
+		if (emb != INVALID_INDEX)
+			this->template set_embedding<CellType>(dest, emb);
+		else
+		{
+			// the orbit of src is a new cell of the current topology transaction
+			cgogn_message_assert(topology_transaction_, "copy_embedding: embedding of src is INVALID_INDEX");
+			this->template unset_embedding<CellType>(dest);
+		}
 	}
 
 protected:
@@ -29,7 +29,14 @@
 namespace cgogn
 {
 
-static const cgogn::uint32 CGOGN_CHUNK_SIZE = 4096u;
+// the number of lines of the chunks of the maps attributes (set by the CMake variable CGOGN_CHUNK_SIZE)
+#ifndef CGOGN_CHUNK_SIZE_VALUE
+#define CGOGN_CHUNK_SIZE_VALUE 4096u
+#endif
+
+static const cgogn::uint32 CGOGN_CHUNK_SIZE = CGOGN_CHUNK_SIZE_VALUE;
+
+static_assert(CGOGN_CHUNK_SIZE >= 32u && (CGOGN_CHUNK_SIZE & (CGOGN_CHUNK_SIZE - 1u)) == 0u, "CGOGN_CHUNK_SIZE must be a power of 2 >= 32");
 
 } // namespace cgogn
 
@@ -0,0 +1,248 @@
+/*******************************************************************************
+* CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+* Copyright (C) 2015, IGG Group, ICube, University of Strasbourg, France       *
+*                                                                              *
+* This library is free software; you can redistribute it and/or modify it      *
+* under the terms of the GNU Lesser General Public License as published by the *
+* Free Software Foundation; either version 2.1 of the License, or (at your     *
+* option) any later version.                                                   *
+*                                                                              *
+* This library is distributed in the hope that it will be useful, but WITHOUT  *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+* for more details.                                                            *
+*                                                                              *
+* You should have received a copy of the GNU Lesser General Public License     *
+* along with this library; if not, write to the Free Software Foundation,      *
+* Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+*                                                                              *
+* Web site: http://cgogn.unistra.fr/                                           *
+* Contact information: cgogn@unistra.fr                                        *
+*                                                                              *
+*******************************************************************************/
+
+#define CGOGN_CORE_CONTAINER_CHUNK_ALLOCATOR_CPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#include <cgogn/core/container/chunk_allocator.h>
+
+namespace cgogn
+{
+
+namespace
+{
+
+void* aligned_malloc(std::size_t nb_bytes, std::size_t alignment)
+{
+	nb_bytes = std::max(nb_bytes, std::size_t(1u));
+#ifdef _MSC_VER
+	void* ptr = _aligned_malloc(nb_bytes, alignment);
+#else
+	void* ptr = nullptr;
+	if (posix_memalign(&ptr, alignment, nb_bytes) != 0)
+		ptr = nullptr;
+#endif
+	if (ptr == nullptr)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void aligned_free(void* ptr)
+{
+#ifdef _MSC_VER
+	_aligned_free(ptr);
+#else
+	std::free(ptr);
+#endif
+}
+
+inline std::size_t round_up(std::size_t nb_bytes, std::size_t alignment)
+{
+	return (nb_bytes + alignment - 1u) / alignment * alignment;
+}
+
+// the size of a (non empty) chunk in a pool
+inline std::size_t pooled_size(std::size_t nb_bytes)
+{
+	return round_up(std::max(nb_bytes, std::size_t(1u)), ChunkAllocator::CACHE_LINE_SIZE);
+}
+
+ChunkAllocator* default_chunk_allocator()
+{
+	static AlignedChunkAllocator allocator;
+	return &allocator;
+}
+
+std::atomic<ChunkAllocator*> current_chunk_allocator(nullptr);
+
+} // namespace
+
+ChunkAllocator::~ChunkAllocator()
+{}
+
+/*******************************************************************************
+ * AlignedChunkAllocator
+ *******************************************************************************/
+
+AlignedChunkAllocator::AlignedChunkAllocator(std::size_t alignment) :
+	alignment_(std::max(alignment, std::size_t(CACHE_LINE_SIZE)))
+{}
+
+AlignedChunkAllocator::~AlignedChunkAllocator()
+{}
+
+void* AlignedChunkAllocator::allocate(std::size_t nb_bytes)
+{
+	return aligned_malloc(nb_bytes, alignment_);
+}
+
+void AlignedChunkAllocator::deallocate(void* ptr, std::size_t)
+{
+	aligned_free(ptr);
+}
+
+std::string AlignedChunkAllocator::name() const
+{
+	return std::string("aligned");
+}
+
+/*******************************************************************************
+ * PooledChunkAllocator
+ *******************************************************************************/
+
+PooledChunkAllocator::PooledChunkAllocator(std::size_t arena_size) :
+	arena_size_(round_up(arena_size, CACHE_LINE_SIZE)),
+	current_(nullptr),
+	remaining_(0u)
+{}
+
+PooledChunkAllocator::~PooledChunkAllocator()
+{
+	// the derived classes release their own arenas (deallocate_arena is not virtual here)
+	for (const auto& arena : arenas_)
+		PooledChunkAllocator::deallocate_arena(arena.first, arena.second);
+}
+
+void* PooledChunkAllocator::allocate(std::size_t nb_bytes)
+{
+	const std::size_t size = pooled_size(nb_bytes);
+
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	auto it = free_lists_.find(size);
+	if (it != free_lists_.end() && !it->second.empty())
+	{
+		void* ptr = it->second.back();
+		it->second.pop_back();
+		return ptr;
+	}
+
+	if (size > remaining_)
+	{
+		// the large chunks have their own arena
+		if (size > arena_size_ / 2u)
+		{
+			void* ptr = allocate_arena(size);
+			arenas_.emplace_back(ptr, size);
+			return ptr;
+		}
+		current_ = static_cast<char*>(allocate_arena(arena_size_));
+		arenas_.emplace_back(current_, arena_size_);
+		remaining_ = arena_size_;
+	}
+
+	void* ptr = current_;
+	current_ += size;
+	remaining_ -= size;
+	return ptr;
+}
+
+void PooledChunkAllocator::deallocate(void* ptr, std::size_t nb_bytes)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	free_lists_[pooled_size(nb_bytes)].push_back(ptr);
+}
+
+std::string PooledChunkAllocator::name() const
+{
+	return std::string("pooled");
+}
+
+std::size_t PooledChunkAllocator::reserved_bytes() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	std::size_t nb_bytes = 0u;
+	for (const auto& arena : arenas_)
+		nb_bytes += arena.second;
+	return nb_bytes;
+}
+
+void* PooledChunkAllocator::allocate_arena(std::size_t nb_bytes)
+{
+	return aligned_malloc(nb_bytes, CACHE_LINE_SIZE);
+}
+
+void PooledChunkAllocator::deallocate_arena(void* ptr, std::size_t)
+{
+	aligned_free(ptr);
+}
+
+/*******************************************************************************
+ * HugePageChunkAllocator
+ *******************************************************************************/
+
+HugePageChunkAllocator::HugePageChunkAllocator(std::size_t arena_size) :
+	PooledChunkAllocator(round_up(arena_size, HUGE_PAGE_SIZE))
+{}
+
+HugePageChunkAllocator::~HugePageChunkAllocator()
+{
+	for (const auto& arena : arenas_)
+		deallocate_arena(arena.first, arena.second);
+	arenas_.clear();
+}
+
+std::string HugePageChunkAllocator::name() const
+{
+	return std::string("huge_page");
+}
+
+void* HugePageChunkAllocator::allocate_arena(std::size_t nb_bytes)
+{
+	const std::size_t size = round_up(nb_bytes, HUGE_PAGE_SIZE);
+	void* ptr = aligned_malloc(size, HUGE_PAGE_SIZE);
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+	madvise(ptr, size, MADV_HUGEPAGE); // only an advice: the failure is not an error
+#endif
+	return ptr;
+}
+
+void HugePageChunkAllocator::deallocate_arena(void* ptr, std::size_t)
+{
+	aligned_free(ptr);
+}
+
+/*******************************************************************************
+ * current allocator
+ *******************************************************************************/
+
+ChunkAllocator* chunk_allocator()
+{
+	ChunkAllocator* allocator = current_chunk_allocator.load();
+	return allocator != nullptr ? allocator : default_chunk_allocator();
+}
+
+void set_chunk_allocator(ChunkAllocator* allocator)
+{
+	current_chunk_allocator.store(allocator);
+}
+
+} // namespace cgogn
@@ -0,0 +1,162 @@
+/*******************************************************************************
+* CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+* Copyright (C) 2015, IGG Group, ICube, University of Strasbourg, France       *
+*                                                                              *
+* This library is free software; you can redistribute it and/or modify it      *
+* under the terms of the GNU Lesser General Public License as published by the *
+* Free Software Foundation; either version 2.1 of the License, or (at your     *
+* option) any later version.                                                   *
+*                                                                              *
+* This library is distributed in the hope that it will be useful, but WITHOUT  *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+* for more details.                                                            *
+*                                                                              *
+* You should have received a copy of the GNU Lesser General Public License     *
+* along with this library; if not, write to the Free Software Foundation,      *
+* Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+*                                                                              *
+* Web site: http://cgogn.unistra.fr/                                           *
+* Contact information: cgogn@unistra.fr                                        *
+*                                                                              *
+*******************************************************************************/
+
+#ifndef CGOGN_CORE_CONTAINER_CHUNK_ALLOCATOR_H_
+#define CGOGN_CORE_CONTAINER_CHUNK_ALLOCATOR_H_
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <cgogn/core/dll.h>
+#include <cgogn/core/utils/definitions.h>
+
+namespace cgogn
+{
+
+/**
+ * @brief Allocator of the memory chunks of the ChunkArrays.
+ * A chunk array uses the allocator that is current when it is created (see set_chunk_allocator)
+ * for all its chunks: an allocator must outlive the arrays that use it.
+ * The allocators are thread safe.
+ */
+class CGOGN_CORE_API ChunkAllocator
+{
+public:
+
+	static const std::size_t CACHE_LINE_SIZE = 64u;
+
+	inline ChunkAllocator() {}
+	CGOGN_NOT_COPYABLE_NOR_MOVABLE(ChunkAllocator);
+	virtual ~ChunkAllocator();
+
+	/**
+	 * @brief allocate a chunk
+	 * @param nb_bytes size of the chunk
+	 * @return a pointer on uninitialized memory aligned (at least) on a cache line
+	 */
+	virtual void* allocate(std::size_t nb_bytes) = 0;
+
+	/**
+	 * @brief give back a chunk
+	 * @param ptr a pointer returned by allocate
+	 * @param nb_bytes the size given to allocate
+	 */
+	virtual void deallocate(void* ptr, std::size_t nb_bytes) = 0;
+
+	virtual std::string name() const = 0;
+};
+
+/**
+ * @brief The default allocator: each chunk is allocated separately and aligned on alignment bytes
+ */
+class CGOGN_CORE_API AlignedChunkAllocator : public ChunkAllocator
+{
+public:
+
+	explicit AlignedChunkAllocator(std::size_t alignment = CACHE_LINE_SIZE);
+	~AlignedChunkAllocator() override;
+
+	void* allocate(std::size_t nb_bytes) override;
+	void deallocate(void* ptr, std::size_t nb_bytes) override;
+	std::string name() const override;
+
+protected:
+
+	std::size_t alignment_;
+};
+
+/**
+ * @brief The chunks are carved in large arenas and the given back chunks are kept in
+ * free lists (per size) to be reused. The memory is only given back to the system
+ * when the allocator is destroyed.
+ */
+class CGOGN_CORE_API PooledChunkAllocator : public ChunkAllocator
+{
+public:
+
+	explicit PooledChunkAllocator(std::size_t arena_size = std::size_t(1u) << 22u);
+	~PooledChunkAllocator() override;
+
+	void* allocate(std::size_t nb_bytes) override;
+	void deallocate(void* ptr, std::size_t nb_bytes) override;
+	std::string name() const override;
+
+	/**
+	 * @return the number of bytes allocated from the system
+	 */
+	std::size_t reserved_bytes() const;
+
+protected:
+
+	virtual void* allocate_arena(std::size_t nb_bytes);
+	virtual void deallocate_arena(void* ptr, std::size_t nb_bytes);
+
+	std::size_t arena_size_;
+
+	mutable std::mutex mutex_;
+	std::vector<std::pair<void*, std::size_t>> arenas_;
+	std::map<std::size_t, std::vector<void*>> free_lists_;
+	char* current_;
+	std::size_t remaining_;
+};
+
+/**
+ * @brief A pool whose arenas are aligned on 2MB and advised to be backed by transparent
+ * huge pages, to reduce the TLB misses on large maps (on other systems than Linux, the
+ * arenas are only aligned)
+ */
+class CGOGN_CORE_API HugePageChunkAllocator : public PooledChunkAllocator
+{
+public:
+
+	static const std::size_t HUGE_PAGE_SIZE = std::size_t(1u) << 21u;
+
+	explicit HugePageChunkAllocator(std::size_t arena_size = std::size_t(16u) * HUGE_PAGE_SIZE);
+	~HugePageChunkAllocator() override;
+
+	std::string name() const override;
+
+protected:
+
+	void* allocate_arena(std::size_t nb_bytes) override;
+	void deallocate_arena(void* ptr, std::size_t nb_bytes) override;
+};
+
+/**
+ * @return the allocator given to the chunk arrays that are created
+ */
+CGOGN_CORE_API ChunkAllocator* chunk_allocator();
+
+/**
+ * @brief set the allocator of the chunk arrays that will be created
+ * @param allocator the new allocator (the default one if nullptr)
+ */
+CGOGN_CORE_API void set_chunk_allocator(ChunkAllocator* allocator);
+
+} // namespace cgogn
+
+#endif // CGOGN_CORE_CONTAINER_CHUNK_ALLOCATOR_H_
@@ -35,5 +35,7 @@ template class CGOGN_CORE_API ChunkArray<CGOGN_CHUNK_SIZE, unsigned char>;
 template class CGOGN_CORE_API ChunkArray<CGOGN_CHUNK_SIZE, std::array<float32, 3>>;
 template class CGOGN_CORE_API ChunkArray<CGOGN_CHUNK_SIZE, std::array<float64, 3>>;
 template class CGOGN_CORE_API ChunkArrayBool<CGOGN_CHUNK_SIZE>;
+template class CGOGN_CORE_API ChunkArrayPacked<CGOGN_CHUNK_SIZE, 4>;
+template class CGOGN_CORE_API ChunkArrayPacked<CGOGN_CHUNK_SIZE, 8>;
 
 } // namespace cgogn
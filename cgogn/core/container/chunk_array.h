@@ -84,7 +84,7 @@ public:
 	~ChunkArray() override
 	{
 		for(auto chunk : table_data_)
-			delete[] chunk;
+			this->template deallocate_chunk<T>(chunk, CHUNK_SIZE);
 	}
 
 	std::string nested_type_name() const override
@@ -159,6 +159,7 @@ public:
 			return false;
 		}
 		table_data_.swap(ca->table_data_);
+		std::swap(this->allocator_, ca->allocator_);
 		return true;
 	}
 
@@ -167,7 +168,12 @@ public:
 	 */
 	void add_chunk() override
 	{
-		table_data_.push_back(new T[CHUNK_SIZE]());
+		table_data_.push_back(this->template allocate_chunk<T>(CHUNK_SIZE));
+	}
+
+	void reserve_chunk_table(uint32 nbc) override
+	{
+		table_data_.reserve(nbc);
 	}
 
 	/**
@@ -184,7 +190,7 @@ public:
 		else
 		{
 			for (std::size_t i = static_cast<std::size_t>(nbc); i < table_data_.size(); ++i)
-				delete[] table_data_[i];
+				this->template deallocate_chunk<T>(table_data_[i], CHUNK_SIZE);
 			table_data_.resize(nbc);
 		}
 	}
@@ -195,10 +201,24 @@ public:
 	void clear() override
 	{
 		for(auto chunk : table_data_)
-			delete[] chunk;
+			this->template deallocate_chunk<T>(chunk, CHUNK_SIZE);
 		table_data_.clear();
 	}
 
+	/**
+	 * @brief reallocate a chunk from the calling thread and move its elements in it
+	 * @param k index of the chunk
+	 */
+	void relocate_chunk(uint32 k) override
+	{
+		T* chunk = this->template allocate_chunk<T>(CHUNK_SIZE);
+		T* old_chunk = table_data_[k];
+		for (uint32 i = 0u; i < CHUNK_SIZE; ++i)
+			chunk[i] = std::move(old_chunk[i]);
+		table_data_[k] = chunk;
+		this->template deallocate_chunk<T>(old_chunk, CHUNK_SIZE);
+	}
+
 	/**
 	 * @brief initialize an element (overwrite with T())
 	 * @param id index of the element
@@ -443,7 +463,7 @@ public:
 	~ChunkArrayBool() override
 	{
 		for(auto chunk : table_data_)
-			delete[] chunk;
+			this->template deallocate_chunk<uint32>(chunk, CHUNK_SIZE/BOOLS_PER_INT);
 	}
 
 	std::string nested_type_name() const override
@@ -517,6 +537,7 @@ public:
 			return false;
 		}
 		table_data_.swap(ca->table_data_);
+		std::swap(this->allocator_, ca->allocator_);
 		return true;
 	}
 
@@ -525,8 +546,12 @@ public:
 	 */
 	void add_chunk() override
 	{
-		// adding the empty parentheses for default-initialization
-		table_data_.push_back(new uint32[CHUNK_SIZE/BOOLS_PER_INT]());
+		table_data_.push_back(this->template allocate_chunk<uint32>(CHUNK_SIZE/BOOLS_PER_INT));
+	}
+
+	void reserve_chunk_table(uint32 nbc) override
+	{
+		table_data_.reserve(nbc);
 	}
 
 	/**
@@ -543,7 +568,7 @@ public:
 		else
 		{
 			for (std::size_t i = nbc; i < table_data_.size(); ++i)
-				delete[] table_data_[i];
+				this->template deallocate_chunk<uint32>(table_data_[i], CHUNK_SIZE/BOOLS_PER_INT);
 			table_data_.resize(nbc);
 		}
 	}
@@ -554,10 +579,18 @@ public:
 	void clear() override
 	{
 		for(auto chunk : table_data_)
-			delete[] chunk;
+			this->template deallocate_chunk<uint32>(chunk, CHUNK_SIZE/BOOLS_PER_INT);
 		table_data_.clear();
 	}
 
+	void relocate_chunk(uint32 k) override
+	{
+		uint32* chunk = this->template allocate_chunk<uint32>(CHUNK_SIZE/BOOLS_PER_INT);
+		std::memcpy(chunk, table_data_[k], CHUNK_SIZE/BOOLS_PER_INT * sizeof(uint32));
+		this->template deallocate_chunk<uint32>(table_data_[k], CHUNK_SIZE/BOOLS_PER_INT);
+		table_data_[k] = chunk;
+	}
+
 	/**
 	 * @brief initialize an element (overwrite with T())
 	 * @param id index of the element
@@ -780,6 +813,305 @@ public:
 //	}
 };
 
+/**
+ * @brief separate version of ChunkArray for small unsigned integers, stored on BITS bits (4 or 8)
+ * and packed in 32 bits words. The values are accessed by value (operator[] and set_value).
+ * As for ChunkArrayBool, two threads must not write concurrently elements of a same word.
+ */
+template <uint32 CHUNK_SIZE, uint32 BITS>
+class ChunkArrayPacked : public ChunkArrayGen<CHUNK_SIZE>
+{
+	static_assert(BITS == 4u || BITS == 8u, "ChunkArrayPacked: only 4 and 8 bits values are supported");
+	static_assert(CHUNK_SIZE % (32u / BITS) == 0u, "ChunkArrayPacked: CHUNK_SIZE must be a multiple of the number of values per word");
+
+public:
+
+	using Inherit = ChunkArrayGen<CHUNK_SIZE>;
+	using Self = ChunkArrayPacked<CHUNK_SIZE, BITS>;
+	using value_type = uint32;
+
+	static const uint32 VALUES_PER_INT = 32u / BITS;
+	static const uint32 MAX_VALUE = (1u << BITS) - 1u;
+
+protected:
+
+	static const uint32 INTS_PER_CHUNK = CHUNK_SIZE / VALUES_PER_INT;
+
+	// vector of block pointers
+	std::vector<uint32*> table_data_;
+
+public:
+
+	static std::string packed_type_name()
+	{
+		return std::string("cgogn::packed_uint") + std::to_string(BITS);
+	}
+
+	inline ChunkArrayPacked(const std::string& name) :
+		Inherit(name, packed_type_name())
+	{
+		table_data_.reserve(1024u);
+	}
+
+	inline ChunkArrayPacked() : Inherit("", packed_type_name())
+	{
+		table_data_.reserve(1024u);
+	}
+
+	CGOGN_NOT_COPYABLE_NOR_MOVABLE(ChunkArrayPacked);
+
+	~ChunkArrayPacked() override
+	{
+		for(auto chunk : table_data_)
+			this->template deallocate_chunk<uint32>(chunk, INTS_PER_CHUNK);
+	}
+
+	std::string nested_type_name() const override
+	{
+		return name_of_type(uint32());
+	}
+
+	uint32 nb_components() const override
+	{
+		return 1u;
+	}
+
+	uint32 element_size() const override
+	{
+		return UINT32_MAX;
+	}
+
+	uint32 nb_chunks() const override
+	{
+		return uint32(table_data_.size());
+	}
+
+	uint32 capacity() const override
+	{
+		return uint32(table_data_.size())*CHUNK_SIZE;
+	}
+
+	/**
+	 * @brief return a vector with pointers to all chunks
+	 * @param byte_block_size filled with CHUNK_SIZE*BITS/8
+	 * @return the vector of pointers
+	 */
+	std::vector<const void*> chunks_pointers(uint32& byte_block_size) const override
+	{
+		std::vector<const void*> addr;
+		byte_block_size = INTS_PER_CHUNK * sizeof(uint32);
+
+		addr.reserve(table_data_.size());
+
+		for (typename std::vector<uint32*>::const_iterator it = table_data_.begin(); it != table_data_.end(); ++it)
+			addr.push_back(*it);
+
+		return addr;
+	}
+
+	std::unique_ptr<Inherit> clone(const std::string& clone_name) const override
+	{
+		if (clone_name == this->name_)
+			return nullptr;
+		return std::unique_ptr<Inherit>(new Self(clone_name));
+	}
+
+	bool swap_data(Inherit* cag) override
+	{
+		Self* ca = dynamic_cast<Self*>(cag);
+		if (!ca)
+		{
+			cgogn_log_warning("swap_data") << "Trying to swap attribute of different types";
+			return false;
+		}
+		table_data_.swap(ca->table_data_);
+		std::swap(this->allocator_, ca->allocator_);
+		return true;
+	}
+
+	void add_chunk() override
+	{
+		table_data_.push_back(this->template allocate_chunk<uint32>(INTS_PER_CHUNK));
+	}
+
+	void reserve_chunk_table(uint32 nbc) override
+	{
+		table_data_.reserve(nbc);
+	}
+
+	void set_nb_chunks(uint32 nbc) override
+	{
+		if (nbc >= table_data_.size())
+		{
+			for (std::size_t i = table_data_.size(); i < nbc; ++i)
+				add_chunk();
+		}
+		else
+		{
+			for (std::size_t i = nbc; i < table_data_.size(); ++i)
+				this->template deallocate_chunk<uint32>(table_data_[i], INTS_PER_CHUNK);
+			table_data_.resize(nbc);
+		}
+	}
+
+	void clear() override
+	{
+		for(auto chunk : table_data_)
+			this->template deallocate_chunk<uint32>(chunk, INTS_PER_CHUNK);
+		table_data_.clear();
+	}
+
+	void relocate_chunk(uint32 k) override
+	{
+		uint32* chunk = this->template allocate_chunk<uint32>(INTS_PER_CHUNK);
+		std::memcpy(chunk, table_data_[k], INTS_PER_CHUNK * sizeof(uint32));
+		this->template deallocate_chunk<uint32>(table_data_[k], INTS_PER_CHUNK);
+		table_data_[k] = chunk;
+	}
+
+	inline void init_element(uint32 id) override
+	{
+		set_value(id, 0u);
+	}
+
+	inline void copy_element(uint32 dst, uint32 src) override
+	{
+		set_value(dst, this->operator[](src));
+	}
+
+	void copy_external_element(uint32 dst, Inherit* cag_src, uint32 src) override
+	{
+		Self* ca = static_cast<Self*>(cag_src);
+		set_value(dst, ca->operator[](src));
+	}
+
+	inline void swap_elements(uint32 idx1, uint32 idx2) override
+	{
+		const uint32 data = this->operator[](idx1);
+		set_value(idx1, this->operator[](idx2));
+		set_value(idx2, data);
+	}
+
+	void save(std::ostream& fs, uint32 nb_lines) const override
+	{
+		// no data -> finished
+		if (nb_lines == 0)
+		{
+			std::size_t chunk_bytes = 0;
+			serialization::save(fs, &chunk_bytes, 1);
+			serialization::save(fs, &nb_lines, 1);
+			return;
+		}
+
+		// round nb_lines to a multiple of the number of values per word
+		if (nb_lines % VALUES_PER_INT)
+			nb_lines = ((nb_lines / VALUES_PER_INT) + 1u) * VALUES_PER_INT;
+
+		cgogn_assert(nb_lines / CHUNK_SIZE <= table_data_.size());
+
+		// save number of bytes
+		std::size_t chunk_bytes = nb_lines / VALUES_PER_INT * sizeof(uint32);
+		serialization::save(fs, &chunk_bytes, 1);
+
+		// save number of lines
+		serialization::save(fs, &nb_lines, 1);
+
+		const uint32 nbc = nb_chunks() - 1u;
+		// save data chunks except last
+		for(uint32 i = 0u; i < nbc; ++i)
+			fs.write(reinterpret_cast<const char*>(table_data_[i]), INTS_PER_CHUNK * sizeof(uint32));
+
+		// save last
+		const uint32 nb = nb_lines - nbc * CHUNK_SIZE;
+		fs.write(reinterpret_cast<const char*>(table_data_[nbc]), nb / VALUES_PER_INT * sizeof(uint32));
+	}
+
+	bool load(std::istream& fs) override
+	{
+		// get number of bytes
+		std::size_t chunk_bytes;
+		serialization::load(fs, &chunk_bytes, 1);
+
+		// get number of lines to load
+		uint32 nb_lines;
+		serialization::load(fs, &nb_lines, 1);
+
+		// no data -> finished
+		if (nb_lines == 0)
+			return true;
+
+		// compute number of chunks
+		uint32 nbc = nb_lines / CHUNK_SIZE;
+		if (nb_lines % CHUNK_SIZE != 0u)
+			nbc++;
+
+		this->set_nb_chunks(nbc);
+
+		// load data chunks except last
+		nbc--;
+		for(uint32 i = 0u; i < nbc; ++i)
+			fs.read(reinterpret_cast<char*>(table_data_[i]), INTS_PER_CHUNK * sizeof(uint32));
+
+		// load last chunk
+		const uint32 nb = nb_lines - nbc*CHUNK_SIZE;
+		fs.read(reinterpret_cast<char*>(table_data_[nbc]), nb / VALUES_PER_INT * sizeof(uint32));
+
+		return true;
+	}
+
+	void export_element(uint32 idx, std::ostream& o, bool binary, bool little_endian, std::size_t /*precision*/) const override
+	{
+		serialization::ostream_writer(o, this->operator[](idx), binary, little_endian);
+	}
+
+	void import_element(uint32 idx, std::istream& in) override
+	{
+		uint32 v;
+		in >> v;
+		set_value(idx, v);
+	}
+
+	const void* element_ptr(uint32) const override
+	{
+		return nullptr; // shall not be used with ChunkArrayPacked
+	}
+
+	/**
+	 * @brief operator[]
+	 * @param i index of element to access
+	 * @return value of the element
+	 */
+	inline uint32 operator[](uint32 i) const
+	{
+		const uint32 jj = i / CHUNK_SIZE;
+		cgogn_assert(jj < table_data_.size());
+		const uint32 j = i % CHUNK_SIZE;
+		const uint32 shift = (j % VALUES_PER_INT) * BITS;
+		return (table_data_[jj][j / VALUES_PER_INT] >> shift) & MAX_VALUE;
+	}
+
+	inline void set_value(uint32 i, uint32 v)
+	{
+		cgogn_message_assert(v <= MAX_VALUE, "ChunkArrayPacked: value out of range");
+		const uint32 jj = i / CHUNK_SIZE;
+		cgogn_assert(jj < table_data_.size());
+		const uint32 j = i % CHUNK_SIZE;
+		const uint32 shift = (j % VALUES_PER_INT) * BITS;
+		uint32& word = table_data_[jj][j / VALUES_PER_INT];
+		word = (word & ~(MAX_VALUE << shift)) | (v << shift);
+	}
+
+	inline void set_all_values(uint32 v)
+	{
+		cgogn_message_assert(v <= MAX_VALUE, "ChunkArrayPacked: value out of range");
+		uint32 word = 0u;
+		for (uint32 k = 0u; k < VALUES_PER_INT; ++k)
+			word |= v << (k * BITS);
+		for (uint32* chunk : table_data_)
+			std::fill(chunk, chunk + INTS_PER_CHUNK, word);
+	}
+};
+
 #if defined(CGOGN_USE_EXTERNAL_TEMPLATES) && (!defined(CGOGN_CORE_CONTAINER_CHUNK_ARRAY_CPP_))
 extern template class CGOGN_CORE_API ChunkArray<CGOGN_CHUNK_SIZE, bool>;
 extern template class CGOGN_CORE_API ChunkArray<CGOGN_CHUNK_SIZE, uint32>;
@@ -787,6 +1119,8 @@ extern template class CGOGN_CORE_API ChunkArray<CGOGN_CHUNK_SIZE, unsigned char>
 extern template class CGOGN_CORE_API ChunkArray<CGOGN_CHUNK_SIZE, std::array<float32, 3>>;
 extern template class CGOGN_CORE_API ChunkArray<CGOGN_CHUNK_SIZE, std::array<float64, 3>>;
 extern template class CGOGN_CORE_API ChunkArrayBool<CGOGN_CHUNK_SIZE>;
+extern template class CGOGN_CORE_API ChunkArrayPacked<CGOGN_CHUNK_SIZE, 4>;
+extern template class CGOGN_CORE_API ChunkArrayPacked<CGOGN_CHUNK_SIZE, 8>;
 #endif // defined(CGOGN_USE_EXTERNAL_TEMPLATES) && (!defined(CGOGN_CORE_CONTAINER_CHUNK_ARRAY_CPP_))
 
 } // namespace cgogn
@@ -31,6 +31,10 @@
 #include <string>
 #include <memory>
 #include <climits>
+#include <algorithm>
+#include <numeric>
+#include <atomic>
+#include <mutex>
 
 #include <cgogn/core/utils/logger.h>
 #include <cgogn/core/dll.h>
@@ -66,6 +70,8 @@ public:
 	template <class T>
 	using ChunkArray = cgogn::ChunkArray<CHUNK_SIZE, T>;
 	using ChunkArrayBool = cgogn::ChunkArrayBool<CHUNK_SIZE>;
+	template <uint32 BITS>
+	using ChunkArrayPacked = cgogn::ChunkArrayPacked<CHUNK_SIZE, BITS>;
 	template <class T>
 	using ChunkStack = cgogn::ChunkStack<CHUNK_SIZE, T>;
 	using ChunkArrayFactory = cgogn::ChunkArrayFactory<CHUNK_SIZE>;
@@ -111,6 +117,31 @@ protected:
 	*/
 	uint32 nb_max_lines_;
 
+	/**
+	 * @brief block of lines owned by a thread during a concurrent insertion section
+	 */
+	struct LineReservation
+	{
+		uint32 next;	// next line to give
+		uint32 end;		// end of the block
+		uint32 nb_inserted;
+		std::vector<uint32> released;	// removed lines (first line of each primitive)
+		uint32 nb_released;
+
+		LineReservation() : next(0u), end(0u), nb_inserted(0u), nb_released(0u) {}
+	};
+
+	/**
+	 * concurrent insertion section (see begin_concurrent_insertions)
+	 */
+	bool concurrent_;
+	uint32 concurrent_first_;					// first line of the blocks
+	std::atomic<uint32> concurrent_top_;		// end of the last given block
+	std::atomic<uint32> concurrent_capacity_;	// number of lines of the allocated chunks
+	uint32 concurrent_max_chunks_;				// reserved size of the chunk tables
+	std::mutex concurrent_mutex_;				// chunks allocation
+	std::vector<LineReservation> reservations_;	// per slot
+
 	/**
 	 * @brief get chunk array index from name
 	 * @warning do not store index (not stable)
@@ -166,6 +197,41 @@ protected:
 		delete ptr_to_del;
 	}
 
+	/**
+	 * @brief the primitives p of [first, last) such that used(p*PRIM_SIZE) == is_used, in increasing order
+	 * @details the ranges of CHUNK_SIZE primitives are counted in parallel, a prefix sum of the counts
+	 * gives the position of each range in the result, which is then filled in parallel
+	 */
+	template <uint32 PRIM_SIZE>
+	std::vector<uint32> gather_primitives(uint32 first, uint32 last, bool is_used) const
+	{
+		const uint32 nb = last > first ? last - first : 0u;
+		std::vector<uint32> offsets((nb + CHUNK_SIZE - 1u) / CHUNK_SIZE + 1u, 0u);
+		parallel_foreach_chunk(nb, CHUNK_SIZE, [&] (uint32 b, uint32 e)
+		{
+			uint32 count = 0u;
+			for (uint32 p = first + b; p < first + e; ++p)
+			{
+				if (used(p * PRIM_SIZE) == is_used)
+					++count;
+			}
+			offsets[b / CHUNK_SIZE + 1u] = count;
+		});
+		std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+		std::vector<uint32> prims(offsets.back());
+		parallel_foreach_chunk(nb, CHUNK_SIZE, [&] (uint32 b, uint32 e)
+		{
+			uint32 k = offsets[b / CHUNK_SIZE];
+			for (uint32 p = first + b; p < first + e; ++p)
+			{
+				if (used(p * PRIM_SIZE) == is_used)
+					prims[k++] = p;
+			}
+		});
+		return prims;
+	}
+
 public:
 
 	/**
@@ -173,7 +239,12 @@ public:
 	 */
 	ChunkArrayContainer() :
 		nb_used_lines_(0u),
-		nb_max_lines_(0u)
+		nb_max_lines_(0u),
+		concurrent_(false),
+		concurrent_first_(0u),
+		concurrent_top_(0u),
+		concurrent_capacity_(0u),
+		concurrent_max_chunks_(0u)
 	{}
 
 	CGOGN_NOT_COPYABLE_NOR_MOVABLE(ChunkArrayContainer);
@@ -231,6 +302,19 @@ public:
 		return const_cast<const ChunkArray<T>*>(const_cast<Self*>(this)->get_chunk_array<T>(name));
 	}
 
+	template <uint32 BITS>
+	ChunkArrayPacked<BITS>* get_packed_chunk_array(const std::string& name)
+	{
+		uint32 index = array_index(name);
+		if (index == UNKNOWN)
+		{
+			cgogn_log_warning("get_packed_chunk_array") << "Chunk array of name \"" << name << "\" not found.";
+			return nullptr;
+		}
+
+		return dynamic_cast<ChunkArrayPacked<BITS>*>(table_arrays_[index]);
+	}
+
 	ChunkArrayGen* get_chunk_array(const std::string& name)
 	{
 		// first check if attribute already exists
@@ -303,6 +387,40 @@ public:
 		return carr;
 	}
 
+	/**
+	 * @brief add an attribute of unsigned integers packed on BITS bits (4 or 8)
+	 * @param name name of chunk array
+	 * @tparam BITS number of bits of the stored values
+	 * @return pointer on created ChunkArrayPacked
+	 */
+	template <uint32 BITS>
+	ChunkArrayPacked<BITS>* add_packed_chunk_array(const std::string& name)
+	{
+		cgogn_assert(name.size() != 0);
+
+		// first check if attribute already exist
+		uint32 index = array_index(name);
+		if (index != UNKNOWN)
+		{
+			cgogn_log_warning("add_packed_chunk_array") << "Chunk array of name \"" << name << "\" already exists.";
+			return nullptr;
+		}
+
+		// create the new attribute
+		ChunkArrayPacked<BITS>* carr = new ChunkArrayPacked<BITS>(name);
+		chunk_array_factory<CHUNK_SIZE>().template register_packed_CA<BITS>();
+
+		// reserve memory
+		carr->set_nb_chunks(refs_.nb_chunks());
+
+		// store pointer, name & typename.
+		table_arrays_.push_back(carr);
+		names_.push_back(name);
+		type_names_.push_back(ChunkArrayPacked<BITS>::packed_type_name());
+
+		return carr;
+	}
+
 	/**
 	 * @brief remove a chunk array by its name
 	 * @param name name of chunk array to remove
@@ -616,6 +734,8 @@ public:
 	/**
 	 * @brief container compacting
 	 * @return map_old_new vector that contains a map from old indices to new indices (holes & unchanged -> 0xffffffff)
+	 * @details the holes under nb_used_lines_ are filled by the used primitives above it (both taken in increasing order,
+	 * gathered in parallel), then the lines are moved array by array by parallel tasks that each write in one chunk
 	 */
 	template <uint32 PRIM_SIZE>
 	std::vector<uint32> compact()
@@ -623,22 +743,51 @@ public:
 		if (this->holes_stack_.empty())
 			return std::vector<uint32>();
 
-		uint32 up = rbegin();
-		uint32 down = std::numeric_limits<uint32>::max();
+		const uint32 up = rbegin();
 		std::vector<uint32> map_old_new(up+1, std::numeric_limits<uint32>::max());
-		do
+
+		const uint32 nb_used_prims = nb_used_lines_ / PRIM_SIZE;
+		const std::vector<uint32> holes = gather_primitives<PRIM_SIZE>(0u, nb_used_prims, false);
+		const std::vector<uint32> moved = gather_primitives<PRIM_SIZE>(nb_used_prims, up / PRIM_SIZE + 1u, true);
+		cgogn_message_assert(holes.size() == moved.size(), "compact: wrong number of used lines");
+
+		// destination and source of the moved lines, sorted by destination
+		const uint32 nb_moved_lines = uint32(holes.size()) * PRIM_SIZE;
+		std::vector<uint32> dst(nb_moved_lines);
+		std::vector<uint32> src(nb_moved_lines);
+		parallel_foreach_chunk(nb_moved_lines, CHUNK_SIZE, [&] (uint32 first, uint32 last)
 		{
-			down = holes_stack_.head();
-			if (down < nb_used_lines_)
-				for(uint32 i = 0u; i < PRIM_SIZE; ++i)
-				{
-					const uint32 rdown = down + PRIM_SIZE - 1u - i;
-					map_old_new[up] = rdown;
-					move_line(rdown, up,true,true);
-					rnext(up);
-				}
-			holes_stack_.pop();
-		} while (!holes_stack_.empty());
+			for (uint32 i = first; i < last; ++i)
+			{
+				const uint32 k = i % PRIM_SIZE;
+				dst[i] = holes[i / PRIM_SIZE] * PRIM_SIZE + k;
+				src[i] = moved[i / PRIM_SIZE] * PRIM_SIZE + k;
+				map_old_new[src[i]] = dst[i];
+			}
+		});
+
+		// the sources are all above nb_used_lines_ and the destinations below: the tasks are independent
+		// as long as they do not write in a same chunk (the bool & packed arrays share words between lines)
+		const uint32 nb_dst_chunks = (nb_used_lines_ + CHUNK_SIZE - 1u) / CHUNK_SIZE;
+		parallel_foreach_chunk(nb_dst_chunks, 1u, [&] (uint32 first_chunk, uint32 last_chunk)
+		{
+			const std::size_t b = std::lower_bound(dst.begin(), dst.end(), first_chunk * CHUNK_SIZE) - dst.begin();
+			const std::size_t e = std::lower_bound(dst.begin(), dst.end(), last_chunk * CHUNK_SIZE) - dst.begin();
+
+			for (auto ptr : table_arrays_)
+				for (std::size_t i = b; i < e; ++i)
+					ptr->move_element(dst[i], src[i]);
+
+			//for markers (i.e. uints) there is no gain moving, we can copy
+			for (auto ptr : table_marker_arrays_)
+				for (std::size_t i = b; i < e; ++i)
+					ptr->copy_element(dst[i], src[i]);
+
+			for (std::size_t i = b; i < e; ++i)
+				refs_[dst[i]] = refs_[src[i]];
+		});
+
+		holes_stack_.clear();
 
 		// free unused memory blocks
 		const uint32 old_nb_blocks = this->nb_max_lines_/CHUNK_SIZE + 1u;
@@ -659,6 +808,69 @@ public:
 		return map_old_new;
 	}
 
+	/**
+	 * @brief container renumbering
+	 * @param old_new the new index of each line of the container, that must be compact
+	 * (a permutation of [0,end()) that keeps the lines of a same primitive together)
+	 * @details the arrays (and the markers and refs) are permuted in parallel, one array per task,
+	 * by following the cycles of the permutation
+	 */
+	void permute(const std::vector<uint32>& old_new)
+	{
+		cgogn_message_assert(holes_stack_.empty(), "permute: the container must be compact");
+		cgogn_message_assert(old_new.size() == nb_max_lines_, "permute: wrong size of the permutation");
+
+		// decompose the permutation into transpositions: the element of i goes to old_new[i]
+		std::vector<std::pair<uint32, uint32>> transpositions;
+		transpositions.reserve(old_new.size());
+		std::vector<bool> done(old_new.size(), false);
+		for (uint32 i = 0u; i < uint32(old_new.size()); ++i)
+		{
+			if (done[i])
+				continue;
+			done[i] = true;
+			for (uint32 j = old_new[i]; j != i; j = old_new[j])
+			{
+				cgogn_message_assert(!done[j], "permute: old_new is not a permutation");
+				transpositions.emplace_back(i, j);
+				done[j] = true;
+			}
+		}
+
+		if (transpositions.empty())
+			return;
+
+		std::vector<ChunkArrayGen*> arrays(table_arrays_.begin(), table_arrays_.end());
+		arrays.insert(arrays.end(), table_marker_arrays_.begin(), table_marker_arrays_.end());
+		arrays.push_back(&refs_);
+
+		parallel_foreach_chunk(uint32(arrays.size()), 1u, [&] (uint32 first, uint32 last)
+		{
+			for (uint32 a = first; a < last; ++a)
+				for (const auto& t : transpositions)
+					arrays[a]->swap_elements(t.first, t.second);
+		});
+	}
+
+	/**
+	 * @brief reallocate each chunk of the arrays (and of the markers and refs) on the worker of the thread pool
+	 * that owns it in the range-partitioned traversals (see parallel_foreach_owned_chunk), so that its memory
+	 * is first touched, and thus placed on the NUMA node, of this worker
+	 */
+	void first_touch()
+	{
+		const uint32 nb_chunks = refs_.nb_chunks();
+		parallel_foreach_owned_chunk(nb_chunks * CHUNK_SIZE, CHUNK_SIZE, [&] (uint32 first, uint32, uint32)
+		{
+			const uint32 k = first / CHUNK_SIZE;
+			for (auto ptr : table_arrays_)
+				ptr->relocate_chunk(k);
+			for (auto ptr : table_marker_arrays_)
+				ptr->relocate_chunk(k);
+			refs_.relocate_chunk(k);
+		});
+	}
+
 	bool check_before_merge(const Self& cac)
 	{
 		for (uint32 i = 0; i < cac.names_.size(); ++i)
@@ -746,6 +958,24 @@ public:
 		return refs_[index] != 0;
 	}
 
+	/**
+	 * @brief allocate the chunks needed to store nb_lines lines
+	 * @param nb_lines number of lines
+	 * Insertions of lines below this number do not allocate memory anymore.
+	 */
+	void reserve(uint32 nb_lines)
+	{
+		const uint32 nbc = nb_lines / CHUNK_SIZE + 1u;
+		if (nbc <= refs_.nb_chunks())
+			return;
+
+		for (auto arr : table_arrays_)
+			arr->set_nb_chunks(nbc);
+		for (auto arr : table_marker_arrays_)
+			arr->set_nb_chunks(nbc);
+		refs_.set_nb_chunks(nbc);
+	}
+
 	/**
 	* @brief insert a group of PRIM_SIZE consecutive lines in the container
 	* @return index of the first line of group
@@ -759,7 +989,8 @@ public:
 
 		if (holes_stack_.empty()) // no holes -> insert at the end
 		{
-			if (nb_max_lines_ == 0) // add first chunk
+			// prim does not fit in the allocated chunks (that may have been reserved)? -> add chunk
+			if (refs_.nb_chunks() <= (nb_max_lines_ + PRIM_SIZE) / CHUNK_SIZE)
 			{
 				for (auto arr : table_arrays_)
 					arr->add_chunk();
@@ -768,17 +999,6 @@ public:
 				refs_.add_chunk();
 			}
 
-			if ((nb_max_lines_ + PRIM_SIZE) % CHUNK_SIZE < PRIM_SIZE) // prim does not fit on current chunk? -> add chunk
-			{
-				// nb_max_lines_ = refs_.nb_chunks() * CHUNK_SIZE; // next index will be at start of new chunk
-
-				for (auto arr : table_arrays_)
-					arr->add_chunk();
-				for (auto arr : table_marker_arrays_)
-					arr->add_chunk();
-				refs_.add_chunk();
-			}
-
 			index = nb_max_lines_;
 			nb_max_lines_ += PRIM_SIZE;
 		}
@@ -817,6 +1037,199 @@ public:
 		nb_used_lines_ -= PRIM_SIZE;
 	}
 
+	/**************************************
+	 *   CONCURRENT LINES MANAGEMENT      *
+	 **************************************/
+
+	/**
+	 * @brief size of the blocks of lines given to the threads of a concurrent insertion section:
+	 * a multiple of PRIM_SIZE and of 32 (the blocks of two threads do not share a word of the boolean arrays)
+	 */
+	template <uint32 PRIM_SIZE>
+	static inline uint32 concurrent_block_size()
+	{
+		return PRIM_SIZE * 32u * std::max(1u, CHUNK_SIZE / (PRIM_SIZE * 32u));
+	}
+
+	/**
+	 * @brief start a concurrent insertion section: until end_concurrent_insertions(), up to nb_slots
+	 * threads insert and remove lines at the same time with the *_concurrent methods, each one
+	 * with its own slot
+	 * @param nb_slots number of slots
+	 * @param nb_lines upper bound of the number of lines inserted during the section
+	 * @details the threads take blocks of lines after the last line (the holes are not reused) and
+	 * the removed lines are kept by their slot until the end of the section.
+	 * The chunk tables of all the arrays are reserved here: the chunks added during the section never
+	 * move them and the lines of the other threads stay accessible.
+	 */
+	template <uint32 PRIM_SIZE>
+	void begin_concurrent_insertions(uint32 nb_slots, uint32 nb_lines)
+	{
+		cgogn_message_assert(!concurrent_, "begin_concurrent_insertions: a section is already in progress");
+
+		const uint32 block = concurrent_block_size<PRIM_SIZE>();
+		concurrent_first_ = ((nb_max_lines_ + block - 1u) / block) * block;
+		concurrent_top_ = concurrent_first_;
+		concurrent_capacity_ = refs_.nb_chunks() * CHUNK_SIZE;
+
+		// each slot leaves at most one block partially used
+		const uint64 max_lines = uint64(concurrent_first_) + nb_lines + uint64(nb_slots + 1u) * block;
+		concurrent_max_chunks_ = uint32(max_lines / CHUNK_SIZE + 1u);
+		for (auto arr : table_arrays_)
+			arr->reserve_chunk_table(concurrent_max_chunks_);
+		for (auto arr : table_marker_arrays_)
+			arr->reserve_chunk_table(concurrent_max_chunks_);
+		refs_.reserve_chunk_table(concurrent_max_chunks_);
+
+		reservations_.clear();
+		reservations_.resize(nb_slots);
+		concurrent_ = true;
+	}
+
+	inline bool in_concurrent_insertions() const
+	{
+		return concurrent_;
+	}
+
+	/**
+	 * @brief insert a group of PRIM_SIZE consecutive lines from the block of the given slot
+	 * @return index of the first line of group
+	 */
+	template <uint32 PRIM_SIZE>
+	uint32 insert_lines_concurrent(uint32 slot)
+	{
+		cgogn_message_assert(concurrent_, "insert_lines_concurrent: no concurrent section in progress");
+		cgogn_message_assert(slot < reservations_.size(), "insert_lines_concurrent: invalid slot");
+
+		LineReservation& r = reservations_[slot];
+		if (r.next == r.end)
+		{
+			const uint32 block = concurrent_block_size<PRIM_SIZE>();
+			r.next = concurrent_top_.fetch_add(block);
+			r.end = r.next + block;
+			if (r.end > concurrent_capacity_.load(std::memory_order_acquire))
+				add_concurrent_chunks(r.end);
+		}
+
+		const uint32 index = r.next;
+		r.next += PRIM_SIZE;
+		for (uint32 i = 0u; i < PRIM_SIZE; ++i)
+			refs_.set_value(index + i, 1u);
+		r.nb_inserted += PRIM_SIZE;
+
+		return index;
+	}
+
+	/**
+	 * @brief remove a group of PRIM_SIZE lines, the hole is given to the container at the end of the section
+	 */
+	template <uint32 PRIM_SIZE>
+	void remove_lines_concurrent(uint32 index, uint32 slot)
+	{
+		cgogn_message_assert(concurrent_, "remove_lines_concurrent: no concurrent section in progress");
+
+		const uint32 begin_prim_idx = (index / PRIM_SIZE) * PRIM_SIZE;
+		cgogn_message_assert(used(begin_prim_idx), "Error removing non existing index");
+
+		LineReservation& r = reservations_[slot];
+		r.released.push_back(begin_prim_idx);
+		for (uint32 i = 0u; i < PRIM_SIZE; ++i)
+			refs_.set_value(begin_prim_idx + i, 0u);
+		r.nb_released += PRIM_SIZE;
+	}
+
+	/**
+	 * @brief unref_line for a concurrent section (only for PRIM_SIZE==1)
+	 * @return true if the line was removed
+	 */
+	bool unref_line_concurrent(uint32 index, uint32 slot)
+	{
+		cgogn_message_assert(concurrent_, "unref_line_concurrent: no concurrent section in progress");
+		cgogn_message_assert(refs_[index] > 1u, "Container: unref line with nb_ref == 1");
+
+		refs_[index]--;
+		if (refs_[index] == 1u)
+		{
+			refs_[index] = 0u;
+			LineReservation& r = reservations_[slot];
+			r.released.push_back(index);
+			++r.nb_released;
+			return true;
+		}
+		return false;
+	}
+
+	/**
+	 * @brief end the concurrent insertion section: the unused lines of the blocks and the removed lines
+	 * become holes of the container
+	 */
+	template <uint32 PRIM_SIZE>
+	void end_concurrent_insertions()
+	{
+		cgogn_message_assert(concurrent_, "end_concurrent_insertions: no concurrent section in progress");
+		concurrent_ = false;
+
+		const uint32 top = concurrent_top_.load();
+		if (top == concurrent_first_)
+		{
+			// no block was given
+			for (const LineReservation& r : reservations_)
+			{
+				for (uint32 index : r.released)
+					holes_stack_.push(index);
+				nb_used_lines_ -= r.nb_released;
+			}
+			reservations_.clear();
+			return;
+		}
+
+		// the lines before the first block and the unused lines of the blocks
+		auto add_holes = [this] (uint32 first, uint32 last)
+		{
+			for (uint32 i = first; i < last; i += PRIM_SIZE)
+			{
+				for (uint32 j = 0u; j < PRIM_SIZE; ++j)
+					refs_.set_value(i + j, 0u);
+				holes_stack_.push(i);
+			}
+		};
+		add_holes(nb_max_lines_, concurrent_first_);
+		for (const LineReservation& r : reservations_)
+		{
+			add_holes(r.next, r.end);
+			for (uint32 index : r.released)
+				holes_stack_.push(index);
+			nb_used_lines_ += r.nb_inserted;
+			nb_used_lines_ -= r.nb_released;
+		}
+		nb_max_lines_ = top;
+		reservations_.clear();
+	}
+
+protected:
+
+	/**
+	 * @brief add chunks to all arrays until they hold the given number of lines (concurrent section)
+	 */
+	void add_concurrent_chunks(uint32 nb_lines)
+	{
+		std::lock_guard<std::mutex> lock(concurrent_mutex_);
+		uint32 capacity = concurrent_capacity_.load(std::memory_order_relaxed);
+		while (capacity < nb_lines)
+		{
+			cgogn_message_assert(capacity / CHUNK_SIZE < concurrent_max_chunks_, "add_concurrent_chunks: more lines than announced");
+			for (auto arr : table_arrays_)
+				arr->add_chunk();
+			for (auto arr : table_marker_arrays_)
+				arr->add_chunk();
+			refs_.add_chunk();
+			capacity += CHUNK_SIZE;
+		}
+		concurrent_capacity_.store(capacity, std::memory_order_release);
+	}
+
+public:
+
 	/**
 	 * @brief initialize a line of the container (an element of each attribute)
 	 * @param index line index
@@ -72,6 +72,17 @@ public:
 			map_CA_[std::move(keyType)] = make_unique<ChunkArray<CHUNK_SIZE, T>>();
 	}
 
+	/**
+	 * @brief register the chunk arrays of unsigned integers packed on BITS bits
+	 */
+	template <uint32 BITS>
+	void register_packed_CA()
+	{
+		std::string keyType(ChunkArrayPacked<CHUNK_SIZE, BITS>::packed_type_name());
+		if(map_CA_.find(keyType) == map_CA_.end())
+			map_CA_[std::move(keyType)] = make_unique<ChunkArrayPacked<CHUNK_SIZE, BITS>>();
+	}
+
 	void register_known_types()
 	{
 		if (known_types_initialized_)
@@ -92,6 +103,8 @@ public:
 		register_CA<std::string>();
 		register_CA<std::array<float32, 3>>();
 		register_CA<std::array<float64, 3>>();
+		register_packed_CA<4>();
+		register_packed_CA<8>();
 		// NOT TODO : add Eigen.
 
 		known_types_initialized_ = true;
@@ -26,6 +26,7 @@
 
 #include <cgogn/core/utils/serialization.h>
 #include <cgogn/core/dll.h>
+#include <cgogn/core/container/chunk_allocator.h>
 
 #include <cgogn/core/cmap/map_traits.h>
 
@@ -33,6 +34,7 @@
 #include <iostream>
 #include <algorithm>
 #include <memory>
+#include <new>
 
 namespace cgogn
 {
@@ -53,10 +55,12 @@ public:
 
 	inline ChunkArrayGen(const std::string& name, const std::string& type_name) :
 		name_(name),
-		type_name_(type_name)
+		type_name_(type_name),
+		allocator_(chunk_allocator())
 	{}
 
-	inline ChunkArrayGen()
+	inline ChunkArrayGen() :
+		allocator_(chunk_allocator())
 	{}
 
 	CGOGN_NOT_COPYABLE_NOR_MOVABLE(ChunkArrayGen);
@@ -69,6 +73,32 @@ protected:
 
 	std::string type_name_;
 
+	// allocator of the chunks (the current one at creation)
+	ChunkAllocator* allocator_;
+
+	/**
+	 * @brief allocate a chunk with the allocator of the array and initialize its elements with T()
+	 */
+	template <typename T>
+	inline T* allocate_chunk(uint32 nb_elements)
+	{
+		T* chunk = static_cast<T*>(allocator_->allocate(nb_elements * sizeof(T)));
+		for (uint32 i = 0u; i < nb_elements; ++i)
+			new (chunk + i) T();
+		return chunk;
+	}
+
+	/**
+	 * @brief destroy the elements of a chunk and give it back to the allocator of the array
+	 */
+	template <typename T>
+	inline void deallocate_chunk(T* chunk, uint32 nb_elements)
+	{
+		for (uint32 i = 0u; i < nb_elements; ++i)
+			chunk[i].~T();
+		allocator_->deallocate(chunk, nb_elements * sizeof(T));
+	}
+
 public:
 
 	/**
@@ -110,6 +140,8 @@ public:
 
 	inline const std::string& type_name() const { return type_name_; }
 
+	inline ChunkAllocator* allocator() const { return allocator_; }
+
 	virtual std::string nested_type_name() const = 0;
 
 	virtual uint32 nb_components() const = 0;
@@ -159,6 +191,12 @@ public:
 	 */
 	virtual void set_nb_chunks(uint32 nbb) = 0;
 
+	/**
+	 * @brief reserve the table of chunk pointers: adding chunks up to nbc chunks does not move it
+	 * @param nbc number of chunks
+	 */
+	virtual void reserve_chunk_table(uint32 nbc) = 0;
+
 	/**
 	 * @brief clear the array
 	 */
@@ -202,6 +240,13 @@ public:
 	 */
 	virtual void swap_elements(uint32 idx1, uint32 idx2) = 0;
 
+	/**
+	 * @brief reallocate a chunk from the calling thread (which first touches the new memory)
+	 * and move its elements in it
+	 * @param k index of the chunk
+	 */
+	virtual void relocate_chunk(uint32 k) = 0;
+
 	/**
 	 * @brief save
 	 * @param fs file stream
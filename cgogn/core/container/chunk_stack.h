@@ -131,7 +131,7 @@ public:
 		const uint32 keep = (stack_size_+CHUNK_SIZE-1u) / CHUNK_SIZE;
 		while (this->table_data_.size() > keep)
 		{
-			delete[] this->table_data_.back();
+			this->template deallocate_chunk<T>(this->table_data_.back(), CHUNK_SIZE);
 			this->table_data_.pop_back();
 		}
 	}
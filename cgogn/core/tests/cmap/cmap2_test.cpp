@@ -217,6 +217,27 @@ TEST_F(CMap2Test, flip_edge)
 	EXPECT_TRUE(cmap_.check_map_integrity());
 }
 
+/**
+ * \brief Removing degenerated faces preserves the cell indexation
+ */
+TEST_F(CMap2Test, collapse_degenerated_face)
+{
+	add_closed_surfaces();
+
+	for (Dart d : darts_)
+	{
+		if (cmap_.codegree(Face(d)) > 2u)
+		{
+			// cut a face of co-degree 2 along the edge of d and remove it
+			const Edge e = cmap_.cut_face(d, cmap_.phi1(d));
+			const Face f = cmap_.codegree(Face(e.dart)) == 2u ? Face(e.dart) : Face(cmap_.phi2(e.dart));
+			cmap_.collapse_degenerated_face(f);
+		}
+	}
+
+	EXPECT_TRUE(cmap_.check_map_integrity());
+}
+
 /**
  * \brief Cutting faces preserves the cell indexation
  */
@@ -360,6 +381,160 @@ TEST_F(CMap2Test, compact_map)
 //	});
 }
 
+TEST_F(CMap2Test, reorder_map)
+{
+	CMap2::VertexAttribute<int32> att_v = cmap_.get_attribute<int32, Vertex>("vertices");
+	CMap2::FaceAttribute<int32> att_f = cmap_.get_attribute<int32, Face>("faces");
+
+	for (uint32 i = 0; i < 100; ++i)
+	{
+		Face f = cmap_.add_face(5);
+		uint32 vc = 0;
+		cmap_.foreach_incident_vertex(f, [&] (Vertex v) { att_v[v] = 1000*i + vc++; });
+		att_f[f] = 10*i;
+		darts_.push_back(f.dart);
+	}
+
+	for (uint32 i = 0; i < 100; i += 2)
+		cmap_.collapse_edge(Edge(cmap_.phi1(darts_[i])));
+
+	// sum of the vertex values of each face, identified by its value
+	auto face_signatures = [&] () -> std::vector<int32>
+	{
+		std::vector<int32> sig(1000, 0);
+		cmap_.foreach_cell([&] (Face f)
+		{
+			cmap_.foreach_incident_vertex(f, [&] (Vertex v) { sig[att_f[f] / 10] += att_v[v]; });
+		});
+		return sig;
+	};
+
+	const std::vector<int32> sig = face_signatures();
+	const uint32 nb_faces = cmap_.nb_cells<Face::ORBIT>();
+
+	cmap_.reorder();
+	EXPECT_TRUE(cmap_.check_map_integrity());
+	EXPECT_EQ(cmap_.nb_cells<Face::ORBIT>(), nb_faces);
+	EXPECT_EQ(cmap_.topology_container().size(), cmap_.topology_container().end());
+	EXPECT_TRUE(face_signatures() == sig);
+
+	cmap_.reorder([&] (Dart d) -> uint64 { return uint64(att_v[Vertex(d)]) % 7u; });
+	EXPECT_TRUE(cmap_.check_map_integrity());
+	EXPECT_EQ(cmap_.nb_cells<Face::ORBIT>(), nb_faces);
+	EXPECT_TRUE(face_signatures() == sig);
+}
+
+TEST_F(CMap2Test, numa_first_touch)
+{
+	CMap2::FaceAttribute<int32> att_f = cmap_.get_attribute<int32, Face>("faces");
+
+	for (uint32 i = 0; i < 1000; ++i)
+	{
+		Face f = cmap_.add_face(3 + std::rand() % 8);
+		att_f[f] = int32(i);
+	}
+
+	cmap_.numa_first_touch();
+	EXPECT_TRUE(cmap_.is_numa_aware());
+	EXPECT_TRUE(cmap_.check_map_integrity());
+
+	std::vector<uint32> nb_darts_per_thread(MAX_NB_THREADS, 0u);
+	cmap_.parallel_foreach_dart([&] (Dart, uint32 th_id) { ++nb_darts_per_thread[th_id]; });
+	uint32 nb_darts = 0u;
+	for (uint32 n : nb_darts_per_thread)
+		nb_darts += n;
+	EXPECT_EQ(nb_darts, cmap_.nb_darts());
+
+	std::vector<int32> sum_per_thread(MAX_NB_THREADS, 0);
+	cmap_.parallel_foreach_cell([&] (Face f, uint32 th_id) { sum_per_thread[th_id] += att_f[f]; });
+	int32 sum = 0;
+	for (int32 n : sum_per_thread)
+		sum += n;
+	EXPECT_EQ(sum, 999 * 1000 / 2);
+}
+
+/**
+ * \brief Cutting edges and faces in a topology transaction gives the same indexation, once committed
+ */
+TEST_F(CMap2Test, topology_transaction)
+{
+	add_closed_surfaces();
+
+	CMap2::FaceAttribute<int32> att_f = cmap_.get_attribute<int32, Face>("faces");
+	int32 count = 0;
+	cmap_.foreach_cell([&] (Face f) { att_f[f] = count++; });
+
+	CellCache<CMap2> cache(cmap_);
+	cache.build<Face>();
+
+	const uint32 nb_vertices = cmap_.nb_cells<Vertex::ORBIT>();
+	const uint32 nb_edges = cmap_.nb_cells<Edge::ORBIT>();
+	const uint32 nb_faces = cmap_.nb_cells<Face::ORBIT>();
+
+	std::vector<Edge> edges;
+	cmap_.foreach_cell([&] (Edge e) { edges.push_back(e); });
+	std::vector<int32> face_values;
+	for (Dart d : darts_)
+		face_values.push_back(att_f[Face(d)]);
+
+	cmap_.begin_topology_transaction();
+	for (Edge e : edges)
+		cmap_.cut_edge(e);
+	uint32 nb_cuts = 0u;
+	for (Dart d : darts_)
+	{
+		if (cmap_.codegree(Face(d)) >= 4u)
+		{
+			cmap_.cut_face(d, cmap_.phi1(cmap_.phi1(d)));
+			++nb_cuts;
+		}
+	}
+	cmap_.commit_topology_transaction(cache);
+
+	EXPECT_FALSE(cmap_.in_topology_transaction());
+	EXPECT_TRUE(cmap_.check_map_integrity());
+	EXPECT_EQ(cmap_.nb_cells<Vertex::ORBIT>(), nb_vertices + nb_edges);
+	EXPECT_EQ(cmap_.nb_cells<Edge::ORBIT>(), 2u * nb_edges + nb_cuts);
+	EXPECT_EQ(cmap_.nb_cells<Face::ORBIT>(), nb_faces + nb_cuts);
+	EXPECT_EQ(cache.size<Face>(), std::size_t(nb_faces + nb_cuts));
+	for (uint32 i = 0u; i < darts_.size(); ++i)
+		EXPECT_EQ(att_f[Face(darts_[i])], face_values[i]);
+}
+
+/**
+ * \brief Cutting the edges of disjoint triangles from several threads in a concurrent editing section
+ */
+TEST_F(CMap2Test, concurrent_editing)
+{
+	std::vector<Dart> faces;
+	for (uint32 i = 0u; i < 1000u; ++i)
+		faces.push_back(cmap_.add_face(3u).dart);
+	const uint32 nb_darts = cmap_.nb_darts();
+
+	cmap_.begin_concurrent_editing(1000u * 6u);
+	EXPECT_TRUE(cmap_.in_concurrent_editing());
+	parallel_foreach_chunk(uint32(faces.size()), 16u, [&] (uint32 first, uint32 last)
+	{
+		for (uint32 i = first; i < last; ++i)
+		{
+			const Dart d = faces[i];
+			const std::array<Dart, 3> edges = {{ d, cmap_.phi1(d), cmap_.phi_1(d) }};
+			for (Dart e : edges)
+				cmap_.cut_edge(Edge(e));
+		}
+	});
+	cmap_.end_concurrent_editing();
+
+	EXPECT_TRUE(cmap_.check_map_integrity());
+	EXPECT_EQ(cmap_.nb_darts(), nb_darts + 1000u * 6u);
+	EXPECT_EQ(cmap_.nb_cells<Vertex::ORBIT>(), 1000u * 6u);
+	EXPECT_EQ(cmap_.nb_cells<Edge::ORBIT>(), 1000u * 6u);
+	EXPECT_EQ(cmap_.nb_cells<Face::ORBIT>(), 1000u);
+
+	cmap_.add_face(4u);
+	EXPECT_TRUE(cmap_.check_map_integrity());
+}
+
 TEST_F(CMap2Test, merge_map)
 {
 	using CDart = CMap2::CDart;
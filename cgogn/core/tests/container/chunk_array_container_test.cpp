@@ -21,9 +21,12 @@
 *                                                                              *
 *******************************************************************************/
 
+#include <thread>
+
 #include <gtest/gtest.h>
 
 #include <cgogn/core/container/chunk_array_container.h>
+#include <cgogn/core/container/chunk_allocator.h>
 
 namespace cgogn
 {
@@ -201,6 +204,130 @@ TEST_F(ChunkArrayContainerTest, test_compact_tri)
 //		std::cout << i++ << " : "<< x << std::endl;
 }
 
+TEST_F(ChunkArrayContainerTest, test_compact_chunks)
+{
+	using DATA = uint32;
+
+	ChunkArrayContainer ca_cont;
+	ChunkArray<DATA>* indices = ca_cont.add_chunk_array<DATA>("indices");
+	auto ids = ca_cont.add_packed_chunk_array<4>("ids");
+
+	// 300 triangles over about 56 chunks
+	for (uint32 i = 0; i < 300; ++i)
+		ca_cont.insert_lines<3>();
+	for (uint32 i = 0; i < 900; ++i)
+	{
+		indices->operator[](i) = i;
+		ids->set_value(i, i % 16u);
+	}
+
+	for (uint32 i = 0; i < 300; i += 3)
+		ca_cont.remove_lines<3>(i * 3);
+	for (uint32 i = 250; i < 300; i += 3)
+		ca_cont.remove_lines<3>((i + 1) * 3);
+
+	const uint32 nb_lines = ca_cont.size();
+	EXPECT_EQ(nb_lines, 900u - 100u * 3u - 17u * 3u);
+
+	std::vector<uint32> old_new = ca_cont.compact<3>();
+	EXPECT_EQ(ca_cont.size(), nb_lines);
+	EXPECT_EQ(ca_cont.end(), nb_lines);
+
+	for (uint32 i = 0; i < nb_lines; ++i)
+	{
+		const DATA x = indices->operator[](i);
+		EXPECT_EQ(ids->operator[](i), x % 16u);
+		// the lines of a primitive stay together
+		EXPECT_EQ(x % 3u, i % 3u);
+		// the moved lines are given by old_new
+		if (x >= nb_lines)
+			EXPECT_EQ(old_new[x], i);
+		else
+			EXPECT_EQ(x, i);
+	}
+}
+
+TEST_F(ChunkArrayContainerTest, test_concurrent_insertions)
+{
+	using DATA = uint32;
+
+	ChunkArrayContainer ca_cont;
+	ChunkArray<DATA>* indices = ca_cont.add_chunk_array<DATA>("indices");
+	for (uint32 i = 0; i < 10; ++i)
+		ca_cont.insert_lines<3>();
+
+	const uint32 nb_threads = 4u;
+	ca_cont.begin_concurrent_insertions<3>(nb_threads, nb_threads * 500u * 3u);
+	std::vector<std::thread> threads;
+	for (uint32 t = 0u; t < nb_threads; ++t)
+	{
+		threads.emplace_back([&, t] ()
+		{
+			for (uint32 k = 0u; k < 500u; ++k)
+			{
+				const uint32 index = ca_cont.insert_lines_concurrent<3>(t);
+				for (uint32 j = 0u; j < 3u; ++j)
+					indices->operator[](index + j) = t * 30000u + k * 3u + j;
+				if (k % 5u == 0u)
+					ca_cont.remove_lines_concurrent<3>(index, t);
+			}
+		});
+	}
+	for (std::thread& th : threads)
+		th.join();
+	ca_cont.end_concurrent_insertions<3>();
+
+	EXPECT_EQ(ca_cont.size(), 30u + nb_threads * 400u * 3u);
+
+	std::vector<uint32> nb_lines_per_thread(nb_threads, 0u);
+	for (uint32 i = ca_cont.begin(); i != ca_cont.end(); ca_cont.next(i))
+	{
+		if (i < 30u)
+			continue;
+		const DATA x = indices->operator[](i);
+		EXPECT_EQ(x % 3u, i % 3u);
+		EXPECT_NE((x % 30000u) / 3u % 5u, 0u);
+		++nb_lines_per_thread[x / 30000u];
+	}
+	for (uint32 n : nb_lines_per_thread)
+		EXPECT_EQ(n, 400u * 3u);
+
+	// the unused lines are holes
+	const uint32 end = ca_cont.end();
+	for (uint32 i = 0; i < 100; ++i)
+		ca_cont.insert_lines<3>();
+	EXPECT_EQ(ca_cont.end(), end);
+}
+
+TEST_F(ChunkArrayContainerTest, test_allocator)
+{
+	PooledChunkAllocator pool;
+	set_chunk_allocator(&pool);
+	{
+		ChunkArrayContainer ca_cont;
+		ChunkArray<uint32>* indices = ca_cont.add_chunk_array<uint32>("indices");
+		set_chunk_allocator(nullptr);
+		EXPECT_EQ(indices->allocator(), &pool);
+
+		for (uint32 i = 0; i < 100; ++i)
+		{
+			ca_cont.insert_lines<1>();
+			indices->operator[](i) = i;
+		}
+		for (uint32 i = 0; i < 100; ++i)
+			EXPECT_EQ(indices->operator[](i), i);
+
+		// the given back chunks are reused
+		const std::size_t reserved = pool.reserved_bytes();
+		ca_cont.clear_chunk_arrays();
+		for (uint32 i = 0; i < 100; ++i)
+			ca_cont.insert_lines<1>();
+		EXPECT_EQ(pool.reserved_bytes(), reserved);
+		EXPECT_EQ(indices->operator[](42), 0u);
+	}
+	EXPECT_NE(chunk_allocator(), &pool);
+}
+
 TEST_F(ChunkArrayContainerTest, test_merge)
 {
 	using VEC3F = std::array<float32,3>;
@@ -395,6 +522,51 @@ TEST_F(ChunkArrayContainerTest, test_merge_tri)
 
 }
 
+TEST_F(ChunkArrayContainerTest, test_packed)
+{
+	ChunkArrayContainer ca_cont;
+	auto levels = ca_cont.add_packed_chunk_array<8>("levels");
+	auto ids = ca_cont.add_packed_chunk_array<4>("ids");
+
+	for (uint32 i = 0; i < 40; ++i)
+	{
+		ca_cont.insert_lines<1>();
+		levels->set_value(i, (i * 7u) % 256u);
+		ids->set_value(i, i % 16u);
+	}
+
+	for (uint32 i = 0; i < 40; ++i)
+	{
+		EXPECT_EQ(levels->operator[](i), (i * 7u) % 256u);
+		EXPECT_EQ(ids->operator[](i), i % 16u);
+	}
+
+	ids->set_value(5, 15u);
+	ids->set_value(5, 2u);
+	EXPECT_EQ(ids->operator[](4), 4u);
+	EXPECT_EQ(ids->operator[](5), 2u);
+	EXPECT_EQ(ids->operator[](6), 6u);
+	ids->set_value(5, 5u);
 
+	ca_cont.remove_lines<1>(0);
+	ca_cont.remove_lines<1>(17);
+	ca_cont.remove_lines<1>(33);
+	ca_cont.compact<1>();
+	EXPECT_EQ(ca_cont.size(), 37u);
+
+	uint32 nb_consistent = 0u;
+	for (uint32 i = ca_cont.begin(); i != ca_cont.end(); ca_cont.next(i))
+	{
+		// the values of a line are moved together
+		const uint32 l = levels->operator[](i);
+		const uint32 id = ids->operator[](i);
+		for (uint32 k = 0; k < 40; ++k)
+		{
+			if ((k * 7u) % 256u == l && k % 16u == id)
+				++nb_consistent;
+		}
+	}
+	EXPECT_EQ(nb_consistent, 37u);
+}
 
 } // namespace cgogn
@@ -0,0 +1,107 @@
+/*******************************************************************************
+* CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+* Copyright (C) 2015, IGG Group, ICube, University of Strasbourg, France       *
+*                                                                              *
+* This library is free software; you can redistribute it and/or modify it      *
+* under the terms of the GNU Lesser General Public License as published by the *
+* Free Software Foundation; either version 2.1 of the License, or (at your     *
+* option) any later version.                                                   *
+*                                                                              *
+* This library is distributed in the hope that it will be useful, but WITHOUT  *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+* for more details.                                                            *
+*                                                                              *
+* You should have received a copy of the GNU Lesser General Public License     *
+* along with this library; if not, write to the Free Software Foundation,      *
+* Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+*                                                                              *
+* Web site: http://cgogn.unistra.fr/                                           *
+* Contact information: cgogn@unistra.fr                                        *
+*                                                                              *
+*******************************************************************************/
+
+#ifndef CGOGN_CORE_UTILS_CLAIMS_H_
+#define CGOGN_CORE_UTILS_CLAIMS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include <cgogn/core/utils/numerics.h>
+#include <cgogn/core/utils/thread_pool.h>
+#include <cgogn/core/basic/dart.h>
+
+namespace cgogn
+{
+
+/**
+ * @brief Lock-free selection of non conflicting local operations.
+ * Each candidate claims the elements (vertices, volumes, ...) of its stencil with its rank (atomic min).
+ * The candidates that own all the elements of their stencil are selected: their stencils are
+ * pairwise disjoint and the selection does not depend on the number of threads.
+ * The ranks must be unique: they are either positions in a sorted list of candidates
+ * or keys that pack a priority (high bits) and a candidate index (low bits).
+ */
+class Claims
+{
+public:
+
+	static const uint64 INVALID_RANK = UINT64_MAX;
+
+	Claims() : size_(0u)
+	{}
+
+	void reset(uint32 nb_elements)
+	{
+		if (nb_elements > size_)
+		{
+			claims_.reset(new std::atomic<uint64>[nb_elements]);
+			size_ = nb_elements;
+		}
+		parallel_foreach_chunk(nb_elements, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+		{
+			for (uint32 i = first; i < last; ++i)
+				claims_[i].store(INVALID_RANK, std::memory_order_relaxed);
+		});
+	}
+
+	// releases a single element (cheaper than a full reset when few elements were claimed)
+	inline void release(uint32 index)
+	{
+		claims_[index].store(INVALID_RANK, std::memory_order_relaxed);
+	}
+
+	inline void claim(uint32 index, uint64 rank)
+	{
+		std::atomic<uint64>& c = claims_[index];
+		uint64 current = c.load(std::memory_order_relaxed);
+		while (rank < current && !c.compare_exchange_weak(current, rank, std::memory_order_relaxed))
+		{}
+	}
+
+	inline bool owns(uint32 index, uint64 rank) const
+	{
+		return claims_[index].load(std::memory_order_relaxed) == rank;
+	}
+
+private:
+
+	std::unique_ptr<std::atomic<uint64>[]> claims_;
+	uint32 size_;
+};
+
+// scrambles the order of the candidates of same key so that the conflicts are resolved in few rounds
+inline uint32 claim_priority(uint32 x)
+{
+	x ^= x >> 16;
+	x *= 0x85ebca6bu;
+	x ^= x >> 13;
+	x *= 0xc2b2ae35u;
+	x ^= x >> 16;
+	return x;
+}
+
+} // namespace cgogn
+
+#endif // CGOGN_CORE_UTILS_CLAIMS_H_
@@ -170,6 +170,18 @@ public:
 		qt_attributes_[ORBIT][c.dart] = c.dart;
 	}
 
+	/**
+	 * @brief update the traversor with newly created (and embedded) cells
+	 */
+	template <typename CellType>
+	inline void add_cells(const std::vector<Dart>& cells)
+	{
+		if (!this->template is_traversed<CellType>())
+			return;
+		for (Dart d : cells)
+			update(CellType(d));
+	}
+
 private:
 
 	MAP& map_;
@@ -238,6 +250,18 @@ public:
 		traversed_cells_ |= orbit_mask<CellType>();
 	}
 
+	/**
+	 * @brief append newly created cells to the cache (the filter given to build is not applied)
+	 */
+	template <typename CellType>
+	inline void add_cells(const std::vector<Dart>& cells)
+	{
+		if (!this->template is_traversed<CellType>())
+			return;
+		std::vector<Dart>& cache = cells_[CellType::ORBIT];
+		cache.insert(cache.end(), cells.begin(), cells.end());
+	}
+
 private:
 
 	const MAP& map_;
@@ -22,12 +22,63 @@
 *******************************************************************************/
 
 
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#endif
+
 #include <cgogn/core/utils/thread_pool.h>
 
 namespace cgogn
 
 {
 
+#if defined(__linux__)
+namespace
+{
+
+// the processors of each NUMA node, read in /sys (a single node with all the processors if not available)
+std::vector<std::vector<uint32>> numa_nodes_cpus()
+{
+	std::vector<std::vector<uint32>> nodes;
+	for (uint32 n = 0u; ; ++n)
+	{
+		std::ifstream file("/sys/devices/system/node/node" + std::to_string(n) + "/cpulist");
+		if (!file.good())
+			break;
+		// a list of ranges: 0-3,8-11
+		std::vector<uint32> cpus;
+		std::string range;
+		while (std::getline(file, range, ','))
+		{
+			std::istringstream iss(range);
+			uint32 first = 0u, last = 0u;
+			char dash = 0;
+			if (!(iss >> first))
+				continue;
+			last = (iss >> dash >> last) ? last : first;
+			for (uint32 c = first; c <= last && c < CPU_SETSIZE; ++c)
+				cpus.push_back(c);
+		}
+		if (!cpus.empty())
+			nodes.push_back(std::move(cpus));
+	}
+
+	if (nodes.empty())
+	{
+		nodes.emplace_back();
+		for (uint32 c = 0u; c < std::thread::hardware_concurrency(); ++c)
+			nodes.back().push_back(c);
+	}
+	return nodes;
+}
+
+} // namespace
+#endif
+
 std::vector<std::thread::id> ThreadPool::threads_ids() const
 {
 	std::vector<std::thread::id> res;
@@ -37,6 +88,29 @@ std::vector<std::thread::id> ThreadPool::threads_ids() const
 	return res;
 }
 
+bool ThreadPool::pin_workers()
+{
+#if defined(__linux__)
+	const std::vector<std::vector<uint32>> nodes = numa_nodes_cpus();
+	if (nodes.empty() || workers_.empty())
+		return false;
+
+	bool pinned = true;
+	for (std::size_t i = 0u; i < workers_.size(); ++i)
+	{
+		const std::vector<uint32>& cpus = nodes[i * nodes.size() / workers_.size()];
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		for (uint32 c : cpus)
+			CPU_SET(c, &set);
+		pinned &= (pthread_setaffinity_np(workers_[i].native_handle(), sizeof(cpu_set_t), &set) == 0);
+	}
+	return pinned;
+#else
+	return false;
+#endif
+}
+
 ThreadPool::~ThreadPool()
 {
 	{
@@ -53,7 +127,11 @@ ThreadPool::~ThreadPool()
 ThreadPool::ThreadPool()
 	: stop_(false)
 {
-	for(uint32 i = 0u; i< cgogn::nb_threads() -1u;++i)
+	// keep at least one worker: the parallel algorithms wait for the tasks they enqueue
+	const uint32 nb_cores = cgogn::nb_threads();
+	const uint32 nb_workers = nb_cores > 2u ? nb_cores - 1u : 1u;
+	worker_tasks_ = std::vector<std::queue<PackagedTask>>(nb_workers);
+	for(uint32 i = 0u; i < nb_workers; ++i)
 	{
 		workers_.emplace_back(
 		[this, i]
@@ -64,18 +142,21 @@ ThreadPool::ThreadPool()
 				PackagedTask task;
 				{
 					std::unique_lock<std::mutex> lock(this->queue_mutex_);
+					std::queue<PackagedTask>& own_tasks = this->worker_tasks_[i];
 					this->condition_.wait(
 						lock,
-						[this] { return this->stop_ || !this->tasks_.empty(); }
+						[this, &own_tasks] { return this->stop_ || !own_tasks.empty() || !this->tasks_.empty(); }
 					);
-					if(this->stop_ && this->tasks_.empty())
+					if(this->stop_ && own_tasks.empty() && this->tasks_.empty())
 					{
 						cgogn::thread_stop();
 						return;
 					}
 
-					task = std::move(this->tasks_.front());
-					this->tasks_.pop();
+					// the tasks given to this worker first
+					std::queue<PackagedTask>& queue = own_tasks.empty() ? this->tasks_ : own_tasks;
+					task = std::move(queue.front());
+					queue.pop();
 				}
 #if defined(_MSC_VER) && _MSC_VER < 1900
 				(*task)(i);
@@ -56,6 +56,7 @@
 #ifndef CGOGN_CORE_UTILS_THREADPOOL_H_
 #define CGOGN_CORE_UTILS_THREADPOOL_H_
 
+#include <algorithm>
 #include <vector>
 #include <queue>
 #include <memory>
@@ -85,9 +86,24 @@ public:
 	using PackagedTask = std::packaged_task<void(uint32)>;
 #endif
 
+	static const uint32 ANY_WORKER = 0xffffffff;
+
 	template <class F, class... Args>
 	std::future<void> enqueue(const F& f, Args&&... args);
 
+	/**
+	 * @brief add a task that is executed by the given worker (or by any worker if ANY_WORKER)
+	 */
+	template <class F, class... Args>
+	std::future<void> enqueue_on(uint32 worker, const F& f, Args&&... args);
+
+	/**
+	 * @brief pin the workers to the processors of the NUMA nodes (sockets), the workers
+	 * being distributed in contiguous blocks over the nodes (only on Linux)
+	 * @return true if all the workers have been pinned
+	 */
+	bool pin_workers();
+
 	std::vector<std::thread::id> threads_ids() const;
 	~ThreadPool();
 
@@ -102,6 +118,8 @@ private:
 	std::vector<std::thread> workers_;
 	// the task queue
 	std::queue<PackagedTask> tasks_;
+	// the task queue of each worker
+	std::vector<std::queue<PackagedTask>> worker_tasks_;
 
 	// synchronization
 	std::mutex queue_mutex_;
@@ -114,6 +132,12 @@ private:
 
 template <class F, class... Args>
 std::future<void> ThreadPool::enqueue(const F& f, Args&&... args)
+{
+	return enqueue_on(ANY_WORKER, f, std::forward<Args>(args)...);
+}
+
+template <class F, class... Args>
+std::future<void> ThreadPool::enqueue_on(uint32 worker, const F& f, Args&&... args)
 {
 	static_assert(std::is_same<typename std::result_of<F(uint32, Args...)>::type,void>::value,"The thread pool only accept non-returning functions.");
 
@@ -137,13 +161,96 @@ std::future<void> ThreadPool::enqueue(const F& f, Args&&... args)
 			cgogn_assert_not_reached("enqueue on stopped ThreadPool");
 		}
 		// Push work back on the queue
-		tasks_.push(std::move(task));
+		if (worker == ANY_WORKER)
+			tasks_.push(std::move(task));
+		else
+		{
+			cgogn_message_assert(worker < worker_tasks_.size(), "enqueue_on: unknown worker");
+			worker_tasks_[worker].push(std::move(task));
+		}
 	}
-	// Notify a thread that there is new work to perform
-	condition_.notify_one();
+	// Notify a thread that there is new work to perform (all of them for a given worker)
+	if (worker == ANY_WORKER)
+		condition_.notify_one();
+	else
+		condition_.notify_all();
 	return res;
 }
 
+/**
+ * @brief apply f(first, last) on the consecutive ranges [first, last) of (at most) chunk_size
+ * indices of [0, nb) using the threads of the pool and wait for the end of all the calls.
+ * The ranges are processed on the calling thread if there is only one or if the pool is empty.
+ */
+template <typename FUNC>
+void parallel_foreach_chunk(uint32 nb, uint32 chunk_size, const FUNC& f)
+{
+	ThreadPool* pool = thread_pool();
+	const uint32 nb_chunks = (nb + chunk_size - 1u) / chunk_size;
+
+	if (nb_chunks <= 1u || pool->nb_threads() == 0u)
+	{
+		for (uint32 first = 0u; first < nb; first += chunk_size)
+			f(first, std::min(nb, first + chunk_size));
+		return;
+	}
+
+	std::vector<std::future<void>> futures;
+	futures.reserve(nb_chunks);
+	for (uint32 first = 0u; first < nb; first += chunk_size)
+	{
+		const uint32 last = std::min(nb, first + chunk_size);
+		futures.push_back(pool->enqueue([&f, first, last] (uint32)
+		{
+			f(first, last);
+		}));
+	}
+	for (auto& fu : futures)
+		fu.wait();
+}
+
+/**
+ * @brief the worker of the pool that owns the range k in the range-partitioned traversals
+ * (the ranges are distributed cyclically so that their owner does not change when the indices grow)
+ */
+inline uint32 chunk_owner(uint32 k, uint32 nb_workers)
+{
+	return k % nb_workers;
+}
+
+/**
+ * @brief apply f(first, last, th_id) on the consecutive ranges [first, last) of (at most) chunk_size
+ * indices of [0, nb), each one on the worker of the pool that owns it (see chunk_owner),
+ * and wait for the end of all the calls.
+ * The ranges are processed on the calling thread if the pool is empty.
+ */
+template <typename FUNC>
+void parallel_foreach_owned_chunk(uint32 nb, uint32 chunk_size, const FUNC& f)
+{
+	ThreadPool* pool = thread_pool();
+	const uint32 nb_workers = uint32(pool->nb_threads());
+
+	if (nb_workers == 0u)
+	{
+		for (uint32 first = 0u; first < nb; first += chunk_size)
+			f(first, std::min(nb, first + chunk_size), 0u);
+		return;
+	}
+
+	std::vector<std::future<void>> futures;
+	futures.reserve((nb + chunk_size - 1u) / chunk_size);
+	for (uint32 first = 0u, k = 0u; first < nb; first += chunk_size, ++k)
+	{
+		const uint32 last = std::min(nb, first + chunk_size);
+		futures.push_back(pool->enqueue_on(chunk_owner(k, nb_workers), [&f, first, last] (uint32 th_id)
+		{
+			f(first, last, th_id);
+		}));
+	}
+	for (auto& fu : futures)
+		fu.wait();
+}
+
 } // namespace cgogn
 
 #endif // CGOGN_CORE_UTILS_THREADPOOL_H_
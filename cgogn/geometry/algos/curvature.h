@@ -24,12 +24,17 @@
 #ifndef CGOGN_GEOMETRY_ALGOS_CURVATURE_H_
 #define CGOGN_GEOMETRY_ALGOS_CURVATURE_H_
 
+#include <functional>
+#include <vector>
+
 #include <cgogn/geometry/types/geometry_traits.h>
 #include <cgogn/geometry/algos/selection.h>
 #include <cgogn/geometry/algos/length.h>
 #include <cgogn/geometry/functions/intersection.h>
 #include <cgogn/core/cmap/attribute.h>
 #include <cgogn/core/utils/masks.h>
+#include <cgogn/core/utils/unique_ptr.h>
+#include <cgogn/core/utils/thread_pool.h>
 
 namespace cgogn
 {
@@ -37,6 +42,72 @@ namespace cgogn
 namespace geometry
 {
 
+/**
+ * \brief compute the principal curvatures and directions of the vertex v from its normal cycle tensor
+ * (the tensor is projected on the tangent plane defined by normal[v] before the eigen analysis)
+ */
+template <typename VEC3>
+void curvature_from_tensor(
+	const Cell<Orbit::PHI21> v,
+	Eigen::Matrix3d tensor,
+	const Attribute<VEC3, Orbit::PHI21>& normal,
+	Attribute<typename vector_traits<VEC3>::Scalar, Orbit::PHI21>& kmax,
+	Attribute<typename vector_traits<VEC3>::Scalar, Orbit::PHI21>& kmin,
+	Attribute<VEC3, Orbit::PHI21>& Kmax,
+	Attribute<VEC3, Orbit::PHI21>& Kmin,
+	Attribute<VEC3, Orbit::PHI21>& Knormal
+)
+{
+	using Scalar = typename vector_traits<VEC3>::Scalar;
+
+	const VEC3& normal_v = normal[v];
+	Eigen::Vector3d e_normal_v(normal_v[0], normal_v[1], normal_v[2]);
+
+	// project the tensor
+	Eigen::Matrix3d proj;
+	proj.setIdentity();
+	proj -= e_normal_v * e_normal_v.transpose();
+	tensor = proj * tensor * proj;
+
+	// solve eigen problem
+	Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver(tensor);
+	const Eigen::Vector3d& ev = solver.eigenvalues();
+	const Eigen::Matrix3d& evec = solver.eigenvectors();
+
+	// sort eigen components : ev[inormal] has minimal absolute value ; kmin = ev[imin] <= ev[imax] = kmax
+	uint32 inormal = 0, imin, imax;
+	if (fabs(ev[1]) < fabs(ev[inormal])) inormal = 1;
+	if (fabs(ev[2]) < fabs(ev[inormal])) inormal = 2;
+	imin = (inormal + 1) % 3;
+	imax = (inormal + 2) % 3;
+	if (ev[imax] < ev[imin]) { std::swap(imin, imax); }
+
+	// set curvatures from sorted eigen components
+	// warning : Kmin and Kmax are switched w.r.t. kmin and kmax
+
+	// normal direction : minimal absolute eigen value
+	VEC3& Knormal_v = Knormal[v];
+	Knormal_v[0] = evec(0, inormal);
+	Knormal_v[1] = evec(1, inormal);
+	Knormal_v[2] = evec(2, inormal);
+	if (Knormal_v.dot(normal_v) < 0)
+		Knormal_v *= Scalar(-1); // change orientation
+
+	// min curvature
+	kmin[v] = ev[imin];
+	VEC3& Kmin_v = Kmin[v];
+	Kmin_v[0] = evec(0, imax);
+	Kmin_v[1] = evec(1, imax);
+	Kmin_v[2] = evec(2, imax);
+
+	// max curvature
+	kmax[v] = ev[imax];
+	VEC3& Kmax_v = Kmax[v];
+	Kmax_v[0] = evec(0, imin);
+	Kmax_v[1] = evec(1, imin);
+	Kmax_v[2] = evec(2, imin);
+}
+
 template <typename VEC3, typename MAP>
 void curvature(
 	const MAP& map,
@@ -88,54 +159,106 @@ void curvature(
 
 	tensor /= neighborhood.area(position);
 
-	const VEC3& normal_v = normal[v];
-	Eigen::Vector3d e_normal_v(normal_v[0], normal_v[1], normal_v[2]);
+	curvature_from_tensor<VEC3>(v, tensor, normal, kmax, kmin, Kmax, Kmin, Knormal);
+}
 
-	// project the tensor
-	Eigen::Matrix3d proj;
-	proj.setIdentity();
-	proj -= e_normal_v * e_normal_v.transpose();
-	tensor = proj * tensor * proj;
+/**
+ * \brief compute the normal cycle tensor contribution of each edge : (e * e^T) * angle(e) / |e|
+ * The result is stored in a vector indexed by the edge embeddings (edges are embedded since edge_angle exists).
+ * This allows to evaluate each contribution once instead of once per vertex neighborhood it belongs to.
+ */
+template <typename VEC3, typename MAP>
+void compute_edge_normal_cycle_tensor(
+	const MAP& map,
+	const Attribute<VEC3, Orbit::PHI21>& position,
+	const Attribute<typename vector_traits<VEC3>::Scalar, Orbit::PHI2>& edge_angle,
+	std::vector<Eigen::Matrix3d>& edge_tensor
+)
+{
+	using Scalar = typename vector_traits<VEC3>::Scalar;
+	using Vertex2 = Cell<Orbit::PHI21>;
+	using Edge2 = Cell<Orbit::PHI2>;
 
-	// solve eigen problem
-	Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver(tensor);
-	const Eigen::Vector3d& ev = solver.eigenvalues();
-	const Eigen::Matrix3d& evec = solver.eigenvectors();
+	edge_tensor.resize(map.template const_attribute_container<Orbit::PHI2>().end());
 
-	// sort eigen components : ev[inormal] has minimal absolute value ; kmin = ev[imin] <= ev[imax] = kmax
-	uint32 inormal = 0, imin, imax;
-	if (fabs(ev[1]) < fabs(ev[inormal])) inormal = 1;
-	if (fabs(ev[2]) < fabs(ev[inormal])) inormal = 2;
-	imin = (inormal + 1) % 3;
-	imax = (inormal + 2) % 3;
-	if (ev[imax] < ev[imin]) { std::swap(imin, imax); }
+	map.parallel_foreach_cell([&] (Edge2 e, uint32)
+	{
+		std::pair<Vertex2, Vertex2> vv = map.vertices(e);
+		const VEC3& p1 = position[vv.first];
+		const VEC3& p2 = position[vv.second];
+		Eigen::Vector3d ev = Eigen::Vector3d(p2[0], p2[1], p2[2]) - Eigen::Vector3d(p1[0], p1[1], p1[2]);
+		edge_tensor[map.embedding(e)] = (ev * ev.transpose()) * edge_angle[e] * (Scalar(1) / ev.norm());
+	});
+}
 
-	// set curvatures from sorted eigen components
-	// warning : Kmin and Kmax are switched w.r.t. kmin and kmax
+namespace internal
+{
 
-	// normal direction : minimal absolute eigen value
-	VEC3& Knormal_v = Knormal[v];
-	Knormal_v[0] = evec(0, inormal);
-	Knormal_v[1] = evec(1, inormal);
-	Knormal_v[2] = evec(2, inormal);
-	if (Knormal_v.dot(normal_v) < 0)
-		Knormal_v *= Scalar(-1); // change orientation
+/**
+ * \brief compute the curvature of all the vertices selected by mask from precomputed edge tensors
+ * Each thread of the pool owns a collector and a DartMarkerStore that are reused from one vertex to the next.
+ * COLLECTOR must provide a collect(Vertex, DartMarkerStore&) method.
+ */
+template <typename VEC3, typename MAP, typename MASK, typename COLLECTOR, typename BORDER_WEIGHT>
+void compute_curvature_from_edge_tensors(
+	const MAP& map,
+	const MASK& mask,
+	const std::function<COLLECTOR*()>& new_collector,
+	const BORDER_WEIGHT& border_weight,
+	const Attribute<VEC3, Orbit::PHI21>& position,
+	const Attribute<VEC3, Orbit::PHI21>& normal,
+	const Attribute<typename vector_traits<VEC3>::Scalar, Orbit::PHI2>& edge_angle,
+	Attribute<typename vector_traits<VEC3>::Scalar, Orbit::PHI21>& kmax,
+	Attribute<typename vector_traits<VEC3>::Scalar, Orbit::PHI21>& kmin,
+	Attribute<VEC3, Orbit::PHI21>& Kmax,
+	Attribute<VEC3, Orbit::PHI21>& Kmin,
+	Attribute<VEC3, Orbit::PHI21>& Knormal
+)
+{
+	using Vertex2 = Cell<Orbit::PHI21>;
+	using Edge2 = Cell<Orbit::PHI2>;
+	using DartMarkerStore = typename MAP::DartMarkerStore;
 
-	// min curvature
-	kmin[v] = ev[imin];
-	VEC3& Kmin_v = Kmin[v];
-	Kmin_v[0] = evec(0, imax);
-	Kmin_v[1] = evec(1, imax);
-	Kmin_v[2] = evec(2, imax);
+	std::vector<Eigen::Matrix3d> edge_tensor;
+	compute_edge_normal_cycle_tensor<VEC3>(map, position, edge_angle, edge_tensor);
 
-	// max curvature
-	kmax[v] = ev[imax];
-	VEC3& Kmax_v = Kmax[v];
-	Kmax_v[0] = evec(0, imin);
-	Kmax_v[1] = evec(1, imin);
-	Kmax_v[2] = evec(2, imin);
+	// per thread scratch data (created on first use by the thread that owns it)
+	const std::size_t nb_threads_pool = cgogn::thread_pool()->nb_threads();
+	std::vector<std::unique_ptr<COLLECTOR>> collectors(nb_threads_pool);
+	std::vector<std::unique_ptr<DartMarkerStore>> markers(nb_threads_pool);
+
+	map.parallel_foreach_cell([&] (Vertex2 v, uint32 th_id)
+	{
+		if (!collectors[th_id])
+		{
+			collectors[th_id] = std::unique_ptr<COLLECTOR>(new_collector());
+			markers[th_id] = make_unique<DartMarkerStore>(map);
+		}
+		COLLECTOR& neighborhood = *collectors[th_id];
+		neighborhood.collect(v, *markers[th_id]);
+
+		Eigen::Matrix3d tensor;
+		tensor.setZero();
+
+		neighborhood.foreach_cell([&] (Edge2 e)
+		{
+			tensor += edge_tensor[map.embedding(e)];
+		});
+
+		neighborhood.foreach_border([&] (Dart d)
+		{
+			tensor += edge_tensor[map.embedding(Edge2(d))] * border_weight(v, d);
+		});
+
+		tensor /= neighborhood.area(position);
+
+		curvature_from_tensor<VEC3>(v, tensor, normal, kmax, kmin, Kmax, Kmin, Knormal);
+	},
+	mask);
 }
 
+} // namespace internal
+
 template <typename VEC3, typename MAP, typename MASK>
 void compute_curvature(
 	const MAP& map,
@@ -152,11 +275,24 @@ void compute_curvature(
 	Attribute<VEC3, Orbit::PHI21>& Knormal
 )
 {
-	map.parallel_foreach_cell([&] (Cell<Orbit::PHI21> v, uint32)
-	{
-		curvature<VEC3>(map, v, radius, position, normal, edge_angle, edge_area, kmax, kmin, Kmax, Kmin, Knormal);
-	},
-	mask);
+	using Scalar = typename vector_traits<VEC3>::Scalar;
+	using Vertex2 = Cell<Orbit::PHI21>;
+	using Collector = geometry::Collector_WithinSphere<VEC3, MAP>;
+
+	unused_parameters(edge_area);
+
+	internal::compute_curvature_from_edge_tensors<VEC3>(
+		map, mask,
+		std::function<Collector*()>([&] () { return new Collector(map, radius, position); }),
+		[&] (Vertex2 v, Dart d) -> Scalar
+		{
+			// the border edges are clipped by the sphere
+			Scalar alpha;
+			geometry::intersection_sphere_segment<VEC3>(position[v], radius, position[Vertex2(d)], position[Vertex2(map.phi1(d))], alpha);
+			return alpha;
+		},
+		position, normal, edge_angle, kmax, kmin, Kmax, Kmin, Knormal
+	);
 }
 
 template <typename VEC3, typename MAP>
@@ -177,6 +313,54 @@ void compute_curvature(
 	compute_curvature<VEC3>(map, AllCellsFilter(), radius, position, normal, edge_angle, edge_area, kmax, kmin, Kmax, Kmin, Knormal);
 }
 
+/**
+ * \brief approximation of compute_curvature where the neighborhood of each vertex is its k-ring
+ * instead of the exact intersection of the surface with a sphere (no clipping of the border edges).
+ */
+template <typename VEC3, typename MAP, typename MASK>
+void compute_curvature_k_ring(
+	const MAP& map,
+	const MASK& mask,
+	uint32 k,
+	const Attribute<VEC3, Orbit::PHI21>& position,
+	const Attribute<VEC3, Orbit::PHI21>& normal,
+	const Attribute<typename vector_traits<VEC3>::Scalar, Orbit::PHI2>& edge_angle,
+	Attribute<typename vector_traits<VEC3>::Scalar, Orbit::PHI21>& kmax,
+	Attribute<typename vector_traits<VEC3>::Scalar, Orbit::PHI21>& kmin,
+	Attribute<VEC3, Orbit::PHI21>& Kmax,
+	Attribute<VEC3, Orbit::PHI21>& Kmin,
+	Attribute<VEC3, Orbit::PHI21>& Knormal
+)
+{
+	using Scalar = typename vector_traits<VEC3>::Scalar;
+	using Vertex2 = Cell<Orbit::PHI21>;
+	using Collector = geometry::Collector_KRing<VEC3, MAP>;
+
+	internal::compute_curvature_from_edge_tensors<VEC3>(
+		map, mask,
+		std::function<Collector*()>([&] () { return new Collector(map, k); }),
+		[] (Vertex2, Dart) -> Scalar { return Scalar(0); },
+		position, normal, edge_angle, kmax, kmin, Kmax, Kmin, Knormal
+	);
+}
+
+template <typename VEC3, typename MAP>
+void compute_curvature_k_ring(
+	const MAP& map,
+	uint32 k,
+	const Attribute<VEC3, Orbit::PHI21>& position,
+	const Attribute<VEC3, Orbit::PHI21>& normal,
+	const Attribute<typename vector_traits<VEC3>::Scalar, Orbit::PHI2>& edge_angle,
+	Attribute<typename vector_traits<VEC3>::Scalar, Orbit::PHI21>& kmax,
+	Attribute<typename vector_traits<VEC3>::Scalar, Orbit::PHI21>& kmin,
+	Attribute<VEC3, Orbit::PHI21>& Kmax,
+	Attribute<VEC3, Orbit::PHI21>& Kmin,
+	Attribute<VEC3, Orbit::PHI21>& Knormal
+)
+{
+	compute_curvature_k_ring<VEC3>(map, AllCellsFilter(), k, position, normal, edge_angle, kmax, kmin, Kmax, Kmin, Knormal);
+}
+
 } // namespace geometry
 
 } // namespace cgogn
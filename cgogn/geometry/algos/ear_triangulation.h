@@ -24,11 +24,18 @@
 #ifndef CGOGN_GEOMETRY_ALGOS_EAR_TRIANGULATION_H_
 #define CGOGN_GEOMETRY_ALGOS_EAR_TRIANGULATION_H_
 
-#include <set>
+#include <algorithm>
+#include <future>
+#include <memory>
+#include <vector>
 
 #include <cgogn/geometry/types/geometry_traits.h>
 #include <cgogn/geometry/algos/normal.h>
 #include <cgogn/geometry/functions/inclusion.h>
+#include <cgogn/core/utils/masks.h>
+#include <cgogn/core/utils/thread.h>
+#include <cgogn/core/utils/thread_pool.h>
+#include <cgogn/core/utils/unique_ptr.h>
 
 namespace cgogn
 {
@@ -43,44 +50,17 @@ class EarTriangulation
 	using Face   = typename MAP::Face;
 	using Scalar = typename vector_traits<VEC3>::Scalar;
 
-	class VertexPoly
+	struct VertexPoly
 	{
-	public:
-
-		using VPMS = std::multiset<VertexPoly*, bool(*)(VertexPoly*,VertexPoly*)>;
-
-		int32 id;
 		Vertex vert_;
 		Scalar value_;
 		Scalar length_;
-		VertexPoly* prev_;
-		VertexPoly* next_;
-		typename VPMS::iterator ear_;
-
-		VertexPoly(Vertex ve, Scalar va, Scalar l, VertexPoly* p = nullptr) : vert_(ve), value_(va), length_(l), prev_(p), next_(nullptr)
-		{
-			if (prev_ != nullptr)
-				prev_->next_ = this;
-		}
-
-		static void close(VertexPoly* first, VertexPoly* last)
-		{
-			last->next_ = first;
-			first->prev_ = last;
-		}
-
-		static VertexPoly* erase(VertexPoly* vp)
-		{
-			VertexPoly* tmp = vp->prev_;
-			tmp->next_ = vp->next_;
-			vp->next_->prev_ = tmp;
-			delete vp;
-			return tmp;
-		}
+		uint32 prev_;
+		uint32 next_;
+		uint32 heap_pos_;	// position in heap of ears (INVALID_INDEX if not in heap)
+		bool reflex_;		// already stored in reflex_ vector
 	};
 
-	using VPMS = typename VertexPoly::VPMS;
-
 	// normal to polygon (for orientation of angles)
 	VEC3 normalPoly_;
 
@@ -90,8 +70,17 @@ class EarTriangulation
 	// ref on position attribute
 	const typename MAP::template VertexAttribute<VEC3>& positions_;
 
-	// map of ears
-	VPMS ears_;
+	// pool of vertices of the polygon (kept allocated from one face to the next)
+	std::vector<VertexPoly> vertices_;
+
+	// indexed binary heap of ears (indices in vertices_), best ear on top
+	std::vector<uint32> ears_;
+
+	// concave vertices ever encountered (the only ones that can be inside an ear)
+	std::vector<uint32> reflex_;
+
+	// number of vertices of the heap that are not ears (value >= 5)
+	uint32 nb_not_ears_;
 
 	// is current polygin convex
 	bool convex_;
@@ -102,22 +91,117 @@ class EarTriangulation
 	// initial face
 	Face face_;
 
-	inline static bool cmp_VP(VertexPoly* lhs, VertexPoly* rhs)
+	inline bool cmp_VP(uint32 lhs, uint32 rhs) const
+	{
+		const VertexPoly& l = vertices_[lhs];
+		const VertexPoly& r = vertices_[rhs];
+		if (std::abs(l.value_ - r.value_) < Scalar(0.2))
+			return l.length_ < r.length_;
+		return l.value_ < r.value_;
+	}
+
+	inline void heap_set(uint32 pos, uint32 vp)
+	{
+		ears_[pos] = vp;
+		vertices_[vp].heap_pos_ = pos;
+	}
+
+	void heap_sift_up(uint32 pos)
+	{
+		const uint32 vp = ears_[pos];
+		while (pos > 0u)
+		{
+			const uint32 parent = (pos - 1u) / 2u;
+			if (!cmp_VP(vp, ears_[parent]))
+				break;
+			heap_set(pos, ears_[parent]);
+			pos = parent;
+		}
+		heap_set(pos, vp);
+	}
+
+	void heap_sift_down(uint32 pos)
+	{
+		const uint32 vp = ears_[pos];
+		const uint32 size = uint32(ears_.size());
+		for (;;)
+		{
+			uint32 child = 2u * pos + 1u;
+			if (child >= size)
+				break;
+			if (child + 1u < size && cmp_VP(ears_[child + 1u], ears_[child]))
+				++child;
+			if (!cmp_VP(ears_[child], vp))
+				break;
+			heap_set(pos, ears_[child]);
+			pos = child;
+		}
+		heap_set(pos, vp);
+	}
+
+	void heap_push(uint32 vp)
+	{
+		if (vertices_[vp].value_ >= Scalar(5))
+			++nb_not_ears_;
+		ears_.push_back(vp);
+		heap_sift_up(uint32(ears_.size()) - 1u);
+	}
+
+	void heap_remove(uint32 vp)
 	{
-		if (std::abs(lhs->value_ - rhs->value_) < Scalar(0.2))
-			return lhs->length_ < rhs->length_;
-		return lhs->value_ < rhs->value_;
+		const uint32 pos = vertices_[vp].heap_pos_;
+		cgogn_assert(pos != INVALID_INDEX);
+		if (vertices_[vp].value_ >= Scalar(5))
+			--nb_not_ears_;
+		vertices_[vp].heap_pos_ = INVALID_INDEX;
+
+		const uint32 last = ears_.back();
+		ears_.pop_back();
+		if (last != vp)
+		{
+			heap_set(pos, last);
+			heap_sift_up(pos);
+			heap_sift_down(vertices_[last].heap_pos_);
+		}
 	}
 
-	void recompute_2_ears(VertexPoly* vp)
+	// remove vertex from polygon, return its previous
+	inline uint32 erase(uint32 vp)
 	{
-		VertexPoly* vprev = vp->prev_;
-		VertexPoly* vp2 = vp->next_;
-		VertexPoly* vnext = vp2->next_;
-		const VEC3& Ta = positions_[vp->vert_];
-		const VEC3& Tb = positions_[vp2->vert_];
-		const VEC3& Tc = positions_[vprev->vert_];
-		const VEC3& Td = positions_[vnext->vert_];
+		VertexPoly& v = vertices_[vp];
+		vertices_[v.prev_].next_ = v.next_;
+		vertices_[v.next_].prev_ = v.prev_;
+		return v.prev_;
+	}
+
+	inline void add_reflex(uint32 vp)
+	{
+		VertexPoly& v = vertices_[vp];
+		if (v.value_ > Scalar(5) && !v.reflex_)
+		{
+			v.reflex_ = true;
+			reflex_.push_back(vp);
+		}
+	}
+
+	/**
+	 * ear value without trigonometric function: 1 - cos(angle) is in [0,2]
+	 * and is increasing with angle like the (normalized) angle itself
+	 */
+	static inline Scalar ear_value(const VEC3& v1, const VEC3& v2)
+	{
+		return Scalar(1) - v1.dot(v2);
+	}
+
+	void recompute_2_ears(uint32 vp)
+	{
+		const uint32 vprev = vertices_[vp].prev_;
+		const uint32 vp2 = vertices_[vp].next_;
+		const uint32 vnext = vertices_[vp2].next_;
+		const VEC3& Ta = positions_[vertices_[vp].vert_];
+		const VEC3& Tb = positions_[vertices_[vp2].vert_];
+		const VEC3& Tc = positions_[vertices_[vprev].vert_];
+		const VEC3& Td = positions_[vertices_[vnext].vert_];
 
 		// compute angle
 		VEC3 v1 = Tb - Ta;
@@ -128,8 +212,8 @@ class EarTriangulation
 		v2.normalize();
 		v3.normalize();
 
-		Scalar dotpr1 = std::acos(v1.dot(v2)) / Scalar(M_PI_2);
-		Scalar dotpr2 = std::acos(-(v1.dot(v3))) / Scalar(M_PI_2);
+		Scalar dotpr1 = ear_value(v1, v2);
+		Scalar dotpr2 = ear_value(-v1, v3);
 
 		if (!convex_)	// if convex no need to test if vertex is an ear (yes)
 		{
@@ -141,33 +225,43 @@ class EarTriangulation
 			if (nv2.dot(normalPoly_) < Scalar(0))
 				dotpr2 = Scalar(10) - dotpr2;// not an ear (concave)
 
+			const Dart dprev = vertices_[vprev].vert_.dart;
+			const Dart dnext = vertices_[vnext].vert_.dart;
+
 			bool finished = (dotpr1 >= Scalar(5)) && (dotpr2 >= Scalar(5));
-			for (auto it = ears_.rbegin(); (!finished) && (it != ears_.rend()) && ((*it)->value_ > Scalar(5)); ++it)
+			for (uint32 i = 0u, end = uint32(reflex_.size()); (!finished) && (i < end); ++i)
 			{
-				Vertex id = (*it)->vert_;
+				const VertexPoly& r = vertices_[reflex_[i]];
+				// removed from polygon, being recomputed or no more concave
+				if (r.heap_pos_ == INVALID_INDEX || r.value_ <= Scalar(5))
+					continue;
+
+				const Vertex id = r.vert_;
 				const VEC3& P = positions_[id];
 
-				if ((dotpr1 < Scalar(5)) && (id.dart != vprev->vert_.dart))
+				if ((dotpr1 < Scalar(5)) && (id.dart != dprev))
 					if (in_triangle(P, normalPoly_, Tb, Tc, Ta))
 						dotpr1 = Scalar(5); // not an ear !
 
-				if ((dotpr2 < Scalar(5)) && (id.dart != vnext->vert_.dart) )
-					if (in_triangle(P, normalPoly_,Td,Ta,Tb))
+				if ((dotpr2 < Scalar(5)) && (id.dart != dnext))
+					if (in_triangle(P, normalPoly_, Td, Ta, Tb))
 						dotpr2 = Scalar(5); // not an ear !
 
 				finished = (dotpr1 >= Scalar(5)) && (dotpr2 >= Scalar(5));
 			}
 		}
 
-		vp->value_ = dotpr1;
-		vp->length_ = Scalar((Tb-Tc).squaredNorm());
-		vp->ear_ = ears_.insert(vp);
-		vp2->value_ = dotpr2;
-		vp->length_ = Scalar((Td-Ta).squaredNorm());
-		vp2->ear_ = ears_.insert(vp2);
+		vertices_[vp].value_ = dotpr1;
+		vertices_[vp].length_ = Scalar((Tb-Tc).squaredNorm());
+		add_reflex(vp);
+		heap_push(vp);
+		vertices_[vp2].value_ = dotpr2;
+		vertices_[vp2].length_ = Scalar((Td-Ta).squaredNorm());
+		add_reflex(vp2);
+		heap_push(vp2);
 
 		// polygon if convex only if all vertices have convex angle (last have ...)
-		convex_ = (*(ears_.rbegin()))->value_ < Scalar(5);
+		convex_ = nb_not_ears_ == 0u;
 	}
 
 	Scalar ear_angle(const VEC3& P1, const VEC3& P2, const VEC3& P3)
@@ -177,7 +271,7 @@ class EarTriangulation
 		v1.normalize();
 		v2.normalize();
 
-		Scalar dotpr = std::acos(v1.dot(v2)) / Scalar(M_PI_2);
+		Scalar dotpr = ear_value(v1, v2);
 
 		VEC3 vn = v1.cross(v2);
 		if (vn.dot(normalPoly_) > Scalar(0))
@@ -186,31 +280,61 @@ class EarTriangulation
 		return dotpr;
 	}
 
-	bool ear_intersection(VertexPoly* vp)
+	bool ear_intersection(uint32 vp)
 	{
-		VertexPoly* endV = vp->prev_;
-		VertexPoly* curr = vp->next_;
-		const VEC3& Ta = positions_[vp->vert_];
-		const VEC3& Tb = positions_[curr->vert_];
-		const VEC3& Tc = positions_[endV->vert_];
-		curr = curr->next_;
+		const uint32 endV = vertices_[vp].prev_;
+		uint32 curr = vertices_[vp].next_;
+		const VEC3& Ta = positions_[vertices_[vp].vert_];
+		const VEC3& Tb = positions_[vertices_[curr].vert_];
+		const VEC3& Tc = positions_[vertices_[endV].vert_];
+		curr = vertices_[curr].next_;
 
 		while (curr != endV)
 		{
-			if (in_triangle(positions_[curr->vert_], normalPoly_, Tb, Tc, Ta))
+			if (in_triangle(positions_[vertices_[curr].vert_], normalPoly_, Tb, Tc, Ta))
 			{
-				vp->value_ = Scalar(5); // not an ear !
+				vertices_[vp].value_ = Scalar(5); // not an ear !
 				return false;
 			}
-			curr = curr->next_;
+			curr = vertices_[curr].next_;
 		}
 		return true;
 	}
 
+	// take the best ear, remove it from the polygon and update its neighbors
+	// return the index of the previous of the removed ear
+	uint32 remove_best_ear()
+	{
+		const uint32 be = ears_.front();
+		--nb_verts_;
+		if (nb_verts_ > 3u)	// no need to update ears if only one triangle left
+		{
+			// remove ears and two sided ears
+			heap_remove(be);
+			heap_remove(vertices_[be].next_);
+			heap_remove(vertices_[be].prev_);
+		}
+		return erase(be);
+	}
+
 public:
 
 	CGOGN_NOT_COPYABLE_NOR_MOVABLE(EarTriangulation);
 
+	/**
+	 * @brief EarTriangulation constructor (call reset before use)
+	 * The memory allocated for a face is kept and reused for the next ones.
+	 * @param map ref on map
+	 * @param position attribute of position to use
+	 */
+	EarTriangulation(MAP& map, const typename MAP::template VertexAttribute<VEC3>& position) :
+		map_(map),
+		positions_(position),
+		nb_not_ears_(0u),
+		convex_(true),
+		nb_verts_(0u)
+	{}
+
 	/**
 	 * @brief EarTriangulation constructor
 	 * @param map ref on map
@@ -218,23 +342,33 @@ public:
 	 * @param position attribute of position to use
 	 */
 	EarTriangulation(MAP& map, const typename MAP::Face f, const typename MAP::template VertexAttribute<VEC3>& position) :
-		map_(map),
-		positions_(position),
-		ears_(cmp_VP)
+		EarTriangulation(map, position)
 	{
+		reset(f);
+	}
+
+	/**
+	 * @brief initialize the triangulation of a new face
+	 * @param f the face to tringulate
+	 */
+	void reset(const Face f)
+	{
+		face_ = f;
+		vertices_.clear();
+		ears_.clear();
+		reflex_.clear();
+		nb_not_ears_ = 0u;
+
 		if (map_.codegree(f) == 3)
 		{
-			face_ = f;
 			nb_verts_ = 3;
 			return;
 		}
 
 		// compute normals for orientation
-		normalPoly_ = normal<VEC3>(map_, Cell<Orbit::PHI1>(f.dart), position);
+		normalPoly_ = normal<VEC3>(map_, Cell<Orbit::PHI1>(f.dart), positions_);
 
 		// first pass create polygon in chained list with angle computation
-		VertexPoly* vpp = nullptr;
-		VertexPoly* prem = nullptr;
 		nb_verts_ = 0;
 		convex_ = true;
 
@@ -243,64 +377,72 @@ public:
 		Dart c = map_.phi1(b);
 		do
 		{
-			const VEC3& P1 = position[Vertex(a)];
-			const VEC3& P2 = position[Vertex(b)];
-			const VEC3& P3 = position[Vertex(c)];
-
-			Scalar val = ear_angle(P1, P2, P3);
-			VertexPoly* vp = new VertexPoly(Vertex(b), val, Scalar((P3-P1).squaredNorm()), vpp);
-
-			if (vp->value_ > Scalar(5))  // concav angle
+			const VEC3& P1 = positions_[Vertex(a)];
+			const VEC3& P2 = positions_[Vertex(b)];
+			const VEC3& P3 = positions_[Vertex(c)];
+
+			VertexPoly vp;
+			vp.vert_ = Vertex(b);
+			vp.value_ = ear_angle(P1, P2, P3);
+			vp.length_ = Scalar((P3-P1).squaredNorm());
+			vp.prev_ = nb_verts_ - 1u;
+			vp.next_ = nb_verts_ + 1u;
+			vp.heap_pos_ = INVALID_INDEX;
+			vp.reflex_ = false;
+			vertices_.push_back(vp);
+
+			if (vp.value_ > Scalar(5))  // concav angle
 				convex_ = false;
 
-			if (vpp == nullptr)
-				prem = vp;
-			vpp = vp;
 			a = b;
 			b = c;
 			c = map_.phi1(c);
 			nb_verts_++;
 		} while (a != f.dart);
 
-		VertexPoly::close(prem, vpp);
+		// close the polygon
+		vertices_.front().prev_ = nb_verts_ - 1u;
+		vertices_.back().next_ = 0u;
 
+		ears_.reserve(nb_verts_);
 		if (convex_)
 		{
 			// second pass with no test of intersections with polygons
-			vpp = prem;
 			for (uint32 i = 0; i < nb_verts_; ++i)
-			{
-				vpp->ear_ = ears_.insert(vpp);
-				vpp = vpp->next_;
-			}
+				heap_push(i);
 		}
 		else
 		{
 			// second pass test intersections with polygons
-			vpp = prem;
 			for (uint32 i = 0; i < nb_verts_; ++i)
 			{
-				if (vpp->value_ < Scalar(5))
-					ear_intersection(vpp);
-				vpp->ear_ = ears_.insert(vpp);
-				vpp = vpp->next_;
+				if (vertices_[i].value_ < Scalar(5))
+					ear_intersection(i);
+				add_reflex(i);
+				heap_push(i);
 			}
 		}
 	}
 
 	/**
-	 * @brief compute table of vertices indices (embeddings) of triangulation
-	 * @param table_indices
+	 * @return the number of indices of the triangulation of the current face
 	 */
-	void append_indices(std::vector<uint32>& table_indices)
+	inline uint32 nb_indices() const
 	{
-		table_indices.reserve((nb_verts_ - 2) * 3);
+		return (nb_verts_ - 2u) * 3u;
+	}
 
-		if (nb_verts_ == 3)
+	/**
+	 * @brief write the vertices indices (embeddings) of the triangulation
+	 * @param table_indices pointer on a buffer of (at least) nb_indices() elements
+	 */
+	void write_indices(uint32* table_indices)
+	{
+		if (ears_.empty())
 		{
 			map_.foreach_incident_vertex(face_, [&] (Vertex v)
 			{
-				table_indices.push_back(map_.embedding(v));
+				*table_indices++ = map_.embedding(v);
 			});
 			return;
 		}
@@ -308,39 +450,35 @@ public:
 		while (nb_verts_ > 3)
 		{
 			// take best (and valid!) ear
-			typename VPMS::iterator be_it = ears_.begin(); // best ear
-			VertexPoly* be = *be_it;
+			const VertexPoly& be = vertices_[ears_.front()];
 
-			table_indices.push_back(map_.embedding(be->vert_));
-			table_indices.push_back(map_.embedding(be->next_->vert_));
-			table_indices.push_back(map_.embedding(be->prev_->vert_));
-			--nb_verts_;
+			*table_indices++ = map_.embedding(be.vert_);
+			*table_indices++ = map_.embedding(vertices_[be.next_].vert_);
+			*table_indices++ = map_.embedding(vertices_[be.prev_].vert_);
 
-			if (nb_verts_ > 3)	// do not recompute if only one triangle left
+			const uint32 vp = remove_best_ear();
+			if (nb_verts_ > 3)
+				recompute_2_ears(vp);
+			else // last triangle
 			{
-				// remove ears and two sided ears
-				ears_.erase(be_it);				// from map of ears
-				ears_.erase(be->next_->ear_);
-				ears_.erase(be->prev_->ear_);
-				be = VertexPoly::erase(be); 	// and remove ear vertex from polygon
-				recompute_2_ears(be);
-			}
-			else // finish (no need to update ears)
-			{
-				// remove ear from polygon
-				be = VertexPoly::erase(be);
-				// last triangle
-				table_indices.push_back(map_.embedding(be->vert_));
-				table_indices.push_back(map_.embedding(be->next_->vert_));
-				table_indices.push_back(map_.embedding(be->prev_->vert_));
-				// release memory of last triangle in polygon
-				delete be->next_;
-				delete be->prev_;
-				delete be;
+				*table_indices++ = map_.embedding(vertices_[vp].vert_);
+				*table_indices++ = map_.embedding(vertices_[vertices_[vp].next_].vert_);
+				*table_indices++ = map_.embedding(vertices_[vertices_[vp].prev_].vert_);
 			}
 		}
 	}
 
+	/**
+	 * @brief compute table of vertices indices (embeddings) of triangulation
+	 * @param table_indices
+	 */
+	void append_indices(std::vector<uint32>& table_indices)
+	{
+		const std::size_t first = table_indices.size();
+		table_indices.resize(first + nb_indices());
+		write_indices(table_indices.data() + first);
+	}
+
 	/**
 	 * @brief apply the ear triangulation the face
 	 */
@@ -349,30 +487,16 @@ public:
 		while (nb_verts_ > 3)
 		{
 			// take best (and valid!) ear
-			typename VPMS::iterator be_it = ears_.begin(); // best ear
-			VertexPoly* be = *be_it;
+			VertexPoly& be = vertices_[ears_.front()];
 
-			map_.cut_face(be->prev_->vert_.dart, be->next_->vert_.dart);
-			--nb_verts_;
+			map_.cut_face(vertices_[be.prev_].vert_.dart, vertices_[be.next_].vert_.dart);
+			// replace dart to be in remaining poly
+			Vertex& vprev = vertices_[be.prev_].vert_;
+			vprev = Vertex(map_.phi2(map_.phi_1(vprev.dart)));
 
-			if (nb_verts_ > 3)	// do not recompute if only one triangle left
-			{
-				// remove ears and two sided ears
-				ears_.erase(be_it);				// from map of ears
-				ears_.erase(be->next_->ear_);
-				ears_.erase(be->prev_->ear_);
-				// replace dart to be in remaining poly
-				be ->prev_->vert_ = Vertex(map_.phi2(map_.phi_1(be ->prev_->vert_.dart)));
-				be = VertexPoly::erase(be); 	// and remove ear vertex from polygon
-				recompute_2_ears(be);
-			}
-			else // finish (no need to update ears)
-			{
-				// release memory of last triangle in polygon
-				delete be->next_;
-				delete be->prev_;
-				delete be;
-			}
+			const uint32 vp = remove_best_ear();
+			if (nb_verts_ > 3)
+				recompute_2_ears(vp);
 		}
 	}
 };
@@ -425,16 +549,108 @@ static void apply_ear_triangulation(
 	const typename MAP::template VertexAttribute<VEC3>& position
 )
 {
+	EarTriangulation<VEC3, MAP> tri(map, position);
 	map.template foreach_cell([&] (typename MAP::Face f)
 	{
 		if (!map.has_codegree(f, 3))
 		{
-			EarTriangulation<VEC3, MAP> tri(map, f, position);
+			tri.reset(f);
 			tri.apply();
 		}
 	});
 }
 
+/**
+ * @brief compute the ear triangulation of the faces of a map in parallel
+ * The indices of all the triangles are appended to table_indices (in the order
+ * of traversal of the faces) which is resized once. Each thread of the pool
+ * reuses its own triangulator and writes directly to its part of the buffer.
+ * @param map
+ * @param mask filter of the traversed faces
+ * @param position
+ * @param table_indices table of indices (vertex embedding) to append
+ */
+template <typename VEC3, typename MAP, typename MASK>
+void compute_ear_triangulation(
+	MAP& map,
+	const MASK& mask,
+	const typename MAP::template VertexAttribute<VEC3>& position,
+	std::vector<uint32>& table_indices
+)
+{
+	using Vertex = typename MAP::Vertex;
+	using Face = typename MAP::Face;
+	using Triangulation = EarTriangulation<VEC3, MAP>;
+
+	// faces to triangulate and position of their triangles in the buffer
+	std::vector<Face> faces;
+	std::vector<uint32> offsets;
+	uint32 offset = uint32(table_indices.size());
+	map.foreach_cell([&] (Face f)
+	{
+		faces.push_back(f);
+		offsets.push_back(offset);
+		offset += (map.codegree(f) - 2u) * 3u;
+	},
+	mask);
+
+	table_indices.resize(offset);
+	uint32* indices = table_indices.data();
+
+	ThreadPool* pool = cgogn::thread_pool();
+	std::vector<std::unique_ptr<Triangulation>> triangulations(pool->nb_threads());
+	std::vector<std::future<void>> futures;
+
+	const uint32 nb_faces = uint32(faces.size());
+	futures.reserve(nb_faces / PARALLEL_BUFFER_SIZE + 1u);
+	for (uint32 first = 0u; first < nb_faces; first += PARALLEL_BUFFER_SIZE)
+	{
+		const uint32 last = std::min(first + PARALLEL_BUFFER_SIZE, nb_faces);
+		futures.push_back(pool->enqueue([&, first, last] (uint32 th_id)
+		{
+			if (!triangulations[th_id])
+				triangulations[th_id] = make_unique<Triangulation>(map, position);
+			Triangulation& tri = *triangulations[th_id];
+
+			for (uint32 i = first; i < last; ++i)
+			{
+				const Face f = faces[i];
+				uint32* ind = indices + offsets[i];
+				if (map.has_codegree(f, 3))
+				{
+					ind[0] = map.embedding(Vertex(f.dart));
+					ind[1] = map.embedding(Vertex(map.phi1(f.dart)));
+					ind[2] = map.embedding(Vertex(map.phi1(map.phi1(f.dart))));
+				}
+				else
+				{
+					tri.reset(f);
+					tri.write_indices(ind);
+				}
+			}
+		}));
+	}
+
+	for (auto& fu : futures)
+		fu.wait();
+}
+
+/**
+ * @brief compute the ear triangulation of all the faces of a map in parallel
+ * @param map
+ * @param position
+ * @param table_indices table of indices (vertex embedding) to append
+ */
+template <typename VEC3, typename MAP>
+void compute_ear_triangulation(
+	MAP& map,
+	const typename MAP::template VertexAttribute<VEC3>& position,
+	std::vector<uint32>& table_indices
+)
+{
+	compute_ear_triangulation<VEC3>(map, AllCellsFilter(), position, table_indices);
+}
+
 } // namespace geometry
 
 } // namespace cgogn
@@ -0,0 +1,99 @@
+/*******************************************************************************
+* CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+* Copyright (C) 2015, IGG Group, ICube, University of Strasbourg, France       *
+*                                                                              *
+* This library is free software; you can redistribute it and/or modify it      *
+* under the terms of the GNU Lesser General Public License as published by the *
+* Free Software Foundation; either version 2.1 of the License, or (at your     *
+* option) any later version.                                                   *
+*                                                                              *
+* This library is distributed in the hope that it will be useful, but WITHOUT  *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+* for more details.                                                            *
+*                                                                              *
+* You should have received a copy of the GNU Lesser General Public License     *
+* along with this library; if not, write to the Free Software Foundation,      *
+* Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+*                                                                              *
+* Web site: http://cgogn.unistra.fr/                                           *
+* Contact information: cgogn@unistra.fr                                        *
+*                                                                              *
+*******************************************************************************/
+
+#ifndef CGOGN_GEOMETRY_ALGOS_REORDER_H_
+#define CGOGN_GEOMETRY_ALGOS_REORDER_H_
+
+#include <algorithm>
+
+#include <cgogn/core/utils/numerics.h>
+#include <cgogn/geometry/types/geometry_traits.h>
+#include <cgogn/geometry/algos/bounding_box.h>
+
+namespace cgogn
+{
+
+namespace geometry
+{
+
+namespace internal
+{
+
+// spreads the 21 lowest bits of x: bit i goes to bit 3i
+inline uint64 morton_spread(uint64 x)
+{
+	x &= 0x1fffffull;
+	x = (x | (x << 32)) & 0x1f00000000ffffull;
+	x = (x | (x << 16)) & 0x1f0000ff0000ffull;
+	x = (x | (x << 8)) & 0x100f00f00f00f00full;
+	x = (x | (x << 4)) & 0x10c30c30c30c30c3ull;
+	x = (x | (x << 2)) & 0x1249249249249249ull;
+	return x;
+}
+
+} // namespace internal
+
+/**
+ * @brief Morton code (Z-order) of the point p in the box [bb_min, bb_max], 21 bits per coordinate
+ */
+template <typename VEC3>
+inline uint64 morton_code(const VEC3& p, const VEC3& bb_min, const VEC3& bb_max)
+{
+	using Scalar = typename vector_traits<VEC3>::Scalar;
+
+	const Scalar max_coord = Scalar((1u << 21) - 1u);
+	uint64 code = 0u;
+	for (uint32 i = 0u; i < 3u; ++i)
+	{
+		const Scalar extent = bb_max[i] - bb_min[i];
+		const Scalar x = extent > Scalar(0) ? (p[i] - bb_min[i]) / extent : Scalar(0);
+		const uint64 c = uint64(std::min(std::max(x, Scalar(0)), Scalar(1)) * max_coord);
+		code |= internal::morton_spread(c) << i;
+	}
+	return code;
+}
+
+/**
+ * @brief renumber the darts and the cells of the map in the Morton order of the positions of their vertex
+ */
+template <typename VEC3, typename MAP>
+void morton_reorder(MAP& map, const typename MAP::template VertexAttribute<VEC3>& position)
+{
+	using Vertex = typename MAP::Vertex;
+
+	AABB<VEC3> bb;
+	compute_AABB(position, bb);
+	const VEC3 bb_min = bb.min();
+	const VEC3 bb_max = bb.max();
+
+	map.reorder([&] (Dart d) -> uint64
+	{
+		return morton_code(position[Vertex(d)], bb_min, bb_max);
+	});
+}
+
+} // namespace geometry
+
+} // namespace cgogn
+
+#endif // CGOGN_GEOMETRY_ALGOS_REORDER_H_
@@ -39,6 +39,8 @@ template CGOGN_GEOMETRY_API class Collector_WithinSphere<Eigen::Vector3f, CMap2>
 template CGOGN_GEOMETRY_API class Collector_WithinSphere<Eigen::Vector3d, CMap2>;
 template CGOGN_GEOMETRY_API class Collector_WithinSphere<Eigen::Vector3f, CMap3>;
 template CGOGN_GEOMETRY_API class Collector_WithinSphere<Eigen::Vector3d, CMap3>;
+template CGOGN_GEOMETRY_API class Collector_KRing<Eigen::Vector3f, CMap2>;
+template CGOGN_GEOMETRY_API class Collector_KRing<Eigen::Vector3d, CMap2>;
 
 } // namespace geometry
 } // namespace cgogn
@@ -132,6 +132,51 @@ public:
 
 protected:
 
+	/**
+	 * \brief mark the darts of the vertex v with dm and collect the edges and faces
+	 * whose darts are now all marked (i.e. whose vertices are all in the neighborhood)
+	 */
+	void mark_vertex(const Vertex v, typename MAP::DartMarkerStore& dm)
+	{
+		this->map_.foreach_dart_of_orbit(v, [&] (Dart d)
+		{
+			// mark a dart of the vertex
+			dm.mark(d);
+
+			// check if the edge of d is now completely marked
+			// (which means all the vertices of the edge are in the neighborhood)
+			Edge e(d);
+			bool all_in = true;
+			this->map_.foreach_dart_of_orbit(e, [&] (Dart dd) -> bool
+			{
+				if (!dm.is_marked(dd))
+				{
+					all_in = false;
+					return false;
+				}
+				return true;
+			});
+			if (all_in)
+				this->cells_[Edge::ORBIT].push_back(d);
+
+			// check if the face of d is now completely marked
+			// (which means all the vertices of the face are in the neighborhood)
+			Face f(d);
+			all_in = true;
+			this->map_.foreach_dart_of_orbit(f, [&] (Dart dd) -> bool
+			{
+				if (!dm.is_marked(dd))
+				{
+					all_in = false;
+					return false;
+				}
+				return true;
+			});
+			if (all_in)
+				this->cells_[Face::ORBIT].push_back(d);
+		});
+	}
+
 	const MAP& map_;
 };
 
@@ -211,57 +256,25 @@ public:
 	Collector_WithinSphere& operator=(Collector_WithinSphere&&) = delete;
 
 	void collect(const Vertex center) override
+	{
+		typename MAP::DartMarkerStore dm(this->map_);
+		collect(center, dm);
+	}
+
+	/**
+	 * \brief collect the neighborhood of center using the given (unmarked) DartMarkerStore
+	 * The marker is unmarked before returning, so that it can be reused for the next call.
+	 * This allows batch computations to avoid the allocation of a marker for each collect.
+	 */
+	void collect(const Vertex center, typename MAP::DartMarkerStore& dm)
 	{
 		this->clear();
 		this->center_ = center.dart;
 
 		const VEC3& center_position = position_[center];
 
-		typename MAP::DartMarkerStore dm(this->map_);
-
-		auto mark_vertex = [&] (Vertex v)
-		{
-			this->map_.foreach_dart_of_orbit(v, [&] (Dart d)
-			{
-				// mark a dart of the vertex
-				dm.mark(d);
-
-				// check if the edge of d is now completely marked
-				// (which means all the vertices of the edge are in the sphere)
-				Edge e(d);
-				bool all_in = true;
-				this->map_.foreach_dart_of_orbit(e, [&] (Dart dd) -> bool
-				{
-					if (!dm.is_marked(dd))
-					{
-						all_in = false;
-						return false;
-					}
-					return true;
-				});
-				if (all_in)
-					this->cells_[Edge::ORBIT].push_back(d);
-
-				// check if the face of d is now completely marked
-				// (which means all the vertices of the face are in the sphere)
-				Face f(d);
-				all_in = true;
-				this->map_.foreach_dart_of_orbit(f, [&] (Dart dd) -> bool
-				{
-					if (!dm.is_marked(dd))
-					{
-						all_in = false;
-						return false;
-					}
-					return true;
-				});
-				if (all_in)
-					this->cells_[Face::ORBIT].push_back(d);
-			});
-		};
-
 		this->cells_[Vertex::ORBIT].push_back(center.dart);
-		mark_vertex(center);
+		this->mark_vertex(center, dm);
 
 		uint32 i = 0;
 		while (i < this->cells_[Vertex::ORBIT].size())
@@ -277,7 +290,7 @@ public:
 					if (!dm.is_marked(d2))
 					{
 						this->cells_[Vertex::ORBIT].push_back(d2);
-						mark_vertex(Vertex(d2));
+						this->mark_vertex(Vertex(d2), dm);
 					}
 				}
 				// if it is not in the sphere, put the dart in the border list
@@ -287,6 +300,8 @@ public:
 
 			++i;
 		}
+
+		dm.unmark_all();
 	}
 
 	Scalar area(const typename MAP::template VertexAttribute<VEC3>& position) const override
@@ -327,6 +342,96 @@ protected:
 	const typename MAP::template VertexAttribute<VEC3>& position_;
 };
 
+template <typename VEC3, typename MAP>
+class Collector_KRing : public Collector<VEC3, MAP>
+{
+public:
+
+	using Self = Collector_KRing<VEC3, MAP>;
+	using Inherit = Collector<VEC3, MAP>;
+
+	using Scalar = typename vector_traits<VEC3>::Scalar;
+	using Vertex = typename MAP::Vertex;
+	using Edge = typename MAP::Edge;
+	using Face = typename MAP::Face;
+
+	using Inherit::collect;
+	using Inherit::area;
+
+	Collector_KRing(const MAP& map, uint32 k) : Inherit(map),
+		k_(k)
+	{}
+
+	Collector_KRing& operator=(const Collector_KRing&) = delete;
+	Collector_KRing& operator=(Collector_KRing&&) = delete;
+
+	void collect(const Vertex center) override
+	{
+		typename MAP::DartMarkerStore dm(this->map_);
+		collect(center, dm);
+	}
+
+	/**
+	 * \brief collect the k-ring of center using the given (unmarked) DartMarkerStore
+	 * The marker is unmarked before returning, so that it can be reused for the next call.
+	 */
+	void collect(const Vertex center, typename MAP::DartMarkerStore& dm)
+	{
+		this->clear();
+		this->center_ = center.dart;
+
+		this->cells_[Vertex::ORBIT].push_back(center.dart);
+		this->mark_vertex(center, dm);
+
+		// breadth-first traversal, one ring at a time
+		std::size_t ring_begin = 0u;
+		for (uint32 ring = 0u; ring < k_; ++ring)
+		{
+			const std::size_t ring_end = this->cells_[Vertex::ORBIT].size();
+			for (std::size_t i = ring_begin; i < ring_end; ++i)
+			{
+				this->map_.foreach_dart_of_orbit(Vertex(this->cells_[Vertex::ORBIT][i]), [&] (Dart d)
+				{
+					Dart d2 = this->map_.phi2(d);
+					if (!dm.is_marked(d2))
+					{
+						this->cells_[Vertex::ORBIT].push_back(d2);
+						this->mark_vertex(Vertex(d2), dm);
+					}
+				});
+			}
+			ring_begin = ring_end;
+		}
+
+		// the darts of the last ring that lead to a vertex outside of the k-ring form the border
+		for (std::size_t i = ring_begin, end = this->cells_[Vertex::ORBIT].size(); i < end; ++i)
+		{
+			this->map_.foreach_dart_of_orbit(Vertex(this->cells_[Vertex::ORBIT][i]), [&] (Dart d)
+			{
+				if (!dm.is_marked(this->map_.phi2(d)))
+					this->border_.push_back(d);
+			});
+		}
+
+		dm.unmark_all();
+	}
+
+	Scalar area(const typename MAP::template VertexAttribute<VEC3>& position) const override
+	{
+		Scalar result = 0;
+		for (Dart d : this->cells_[Face::ORBIT])
+		{
+			if (!this->map_.is_boundary(d))
+				result += geometry::area<VEC3>(this->map_, Face(d), position);
+		}
+		return result;
+	}
+
+protected:
+
+	uint32 k_;
+};
+
 #if defined(CGOGN_USE_EXTERNAL_TEMPLATES) && (!defined(CGOGN_GEOMETRY_ALGOS_SELECTION_CPP_))
 extern template CGOGN_GEOMETRY_API class Collector_OneRing<Eigen::Vector3f, CMap2>;
 extern template CGOGN_GEOMETRY_API class Collector_OneRing<Eigen::Vector3d, CMap2>;
@@ -336,6 +441,8 @@ extern template CGOGN_GEOMETRY_API class Collector_WithinSphere<Eigen::Vector3f,
 extern template CGOGN_GEOMETRY_API class Collector_WithinSphere<Eigen::Vector3d, CMap2>;
 extern template CGOGN_GEOMETRY_API class Collector_WithinSphere<Eigen::Vector3f, CMap3>;
 extern template CGOGN_GEOMETRY_API class Collector_WithinSphere<Eigen::Vector3d, CMap3>;
+extern template CGOGN_GEOMETRY_API class Collector_KRing<Eigen::Vector3f, CMap2>;
+extern template CGOGN_GEOMETRY_API class Collector_KRing<Eigen::Vector3d, CMap2>;
 #endif // defined(CGOGN_USE_EXTERNAL_TEMPLATES) && (!defined(CGOGN_GEOMETRY_ALGOS_SELECTION_CPP_))
 
 } // namespace geometry
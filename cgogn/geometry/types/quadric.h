@@ -0,0 +1,189 @@
+/*******************************************************************************
+* CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+* Copyright (C) 2015, IGG Group, ICube, University of Strasbourg, France       *
+*                                                                              *
+* This library is free software; you can redistribute it and/or modify it      *
+* under the terms of the GNU Lesser General Public License as published by the *
+* Free Software Foundation; either version 2.1 of the License, or (at your     *
+* option) any later version.                                                   *
+*                                                                              *
+* This library is distributed in the hope that it will be useful, but WITHOUT  *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+* for more details.                                                            *
+*                                                                              *
+* You should have received a copy of the GNU Lesser General Public License     *
+* along with this library; if not, write to the Free Software Foundation,      *
+* Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+*                                                                              *
+* Web site: http://cgogn.unistra.fr/                                           *
+* Contact information: cgogn@unistra.fr                                        *
+*                                                                              *
+*******************************************************************************/
+
+#ifndef CGOGN_GEOMETRY_TYPES_QUADRIC_H_
+#define CGOGN_GEOMETRY_TYPES_QUADRIC_H_
+
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <type_traits>
+
+#include <cgogn/core/utils/numerics.h>
+
+#include <cgogn/geometry/dll.h>
+#include <cgogn/geometry/types/geometry_traits.h>
+
+namespace cgogn
+{
+
+namespace geometry
+{
+
+/**
+ * @brief Quadric error metric (Garland & Heckbert 1997): the sum of the squared distances
+ * to a set of planes, stored as the 10 coefficients of a symmetric 4x4 matrix.
+ */
+template <typename VEC_T>
+class Quadric
+{
+	static_assert(vector_traits<VEC_T>::SIZE == 3ul, "The size of the vector must be equal to 3.");
+
+public:
+
+	using Vec = VEC_T;
+	using Scalar = typename vector_traits<Vec>::Scalar;
+	using Self = Quadric<Vec>;
+
+	static const bool eigen_make_aligned = std::is_same<Eigen::AlignedVector3<Scalar>, Vec>::value;
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW_IF(eigen_make_aligned)
+
+	// the null quadric
+	inline Quadric()
+	{
+		q_.fill(Scalar(0));
+	}
+
+	Quadric(const Self&) = default;
+	Self& operator=(const Self&) = default;
+
+	// squared distance to the plane n.p + d = 0 (with n normalized), scaled by weight
+	inline Quadric(const Vec& n, Scalar d, Scalar weight = Scalar(1))
+	{
+		const Scalar a = n[0], b = n[1], c = n[2];
+		q_ = {{ a*a, a*b, a*c, a*d, b*b, b*c, b*d, c*c, c*d, d*d }};
+		for (Scalar& x : q_)
+			x *= weight;
+	}
+
+	// squared distance to the plane of the triangle p1,p2,p3, weighted by its area
+	static inline Self triangle(const Vec& p1, const Vec& p2, const Vec& p3)
+	{
+		Vec n = (p2-p1).cross(p3-p1);
+		const Scalar l = n.norm();
+		if (l == Scalar(0))
+			return Self();
+		n /= l;
+		return Self(n, -(p1.dot(n)), Scalar(0.5) * l);
+	}
+
+	inline Self& operator+=(const Self& q)
+	{
+		for (std::size_t i = 0u; i < 10u; ++i)
+			q_[i] += q.q_[i];
+		return *this;
+	}
+
+	inline Self operator+(const Self& q) const
+	{
+		Self res(*this);
+		res += q;
+		return res;
+	}
+
+	inline Self& operator*=(Scalar s)
+	{
+		for (Scalar& x : q_)
+			x *= s;
+		return *this;
+	}
+
+	// the error of the point p: pT.A.p + 2.bT.p + c
+	inline Scalar operator()(const Vec& p) const
+	{
+		const Scalar x = p[0], y = p[1], z = p[2];
+		return
+			q_[0]*x*x + Scalar(2)*q_[1]*x*y + Scalar(2)*q_[2]*x*z + Scalar(2)*q_[3]*x +
+			q_[4]*y*y + Scalar(2)*q_[5]*y*z + Scalar(2)*q_[6]*y +
+			q_[7]*z*z + Scalar(2)*q_[8]*z +
+			q_[9];
+	}
+
+	/**
+	 * @brief computes the point of minimal error (solution of A.p = -b)
+	 * @param p the optimal point
+	 * @return false if the system is ill-conditioned (p is left unchanged)
+	 */
+	inline bool optimized(Vec& p) const
+	{
+		const Scalar a00 = q_[0], a01 = q_[1], a02 = q_[2];
+		const Scalar a11 = q_[4], a12 = q_[5], a22 = q_[7];
+
+		// cofactors of the symmetric 3x3 matrix A
+		const Scalar c00 = a11*a22 - a12*a12;
+		const Scalar c01 = a02*a12 - a01*a22;
+		const Scalar c02 = a01*a12 - a02*a11;
+		const Scalar det = a00*c00 + a01*c01 + a02*c02;
+
+		const Scalar scale = std::abs(a00) + std::abs(a11) + std::abs(a22);
+		if (std::abs(det) <= Scalar(1e-6) * scale * scale * scale)
+			return false;
+
+		const Scalar c11 = a00*a22 - a02*a02;
+		const Scalar c12 = a01*a02 - a00*a12;
+		const Scalar c22 = a00*a11 - a01*a01;
+		const Scalar inv = Scalar(-1) / det;
+		const Scalar bx = q_[3], by = q_[6], bz = q_[8];
+		p[0] = inv * (c00*bx + c01*by + c02*bz);
+		p[1] = inv * (c01*bx + c11*by + c12*bz);
+		p[2] = inv * (c02*bx + c12*by + c22*bz);
+		return true;
+	}
+
+	inline friend std::ostream& operator<<(std::ostream& o, const Self& q)
+	{
+		for (std::size_t i = 0u; i < 9u; ++i)
+			o << q.q_[i] << " ";
+		o << q.q_[9];
+		return o;
+	}
+
+	inline friend std::istream& operator>>(std::istream& i, Self& q)
+	{
+		for (Scalar& x : q.q_)
+			i >> x;
+		return i;
+	}
+
+	static std::string cgogn_name_of_type()
+	{
+		return std::string("cgogn::geometry::Quadric<") + name_of_type(Vec()) + std::string(">");
+	}
+
+private:
+
+	// upper triangle of the matrix, row by row: xx xy xz xd yy yz yd zz zd dd
+	std::array<Scalar, 10> q_;
+};
+
+#if defined(CGOGN_USE_EXTERNAL_TEMPLATES) && (!defined(CGOGN_GEOMETRY_TYPES_QUADRIC_CPP_))
+extern template class CGOGN_GEOMETRY_API Quadric<Eigen::Vector3d>;
+extern template class CGOGN_GEOMETRY_API Quadric<Eigen::Vector3f>;
+#endif // defined(CGOGN_USE_EXTERNAL_TEMPLATES) && (!defined(CGOGN_GEOMETRY_TYPES_QUADRIC_CPP_))
+
+} // namespace geometry
+
+} // namespace cgogn
+
+#endif // CGOGN_GEOMETRY_TYPES_QUADRIC_H_
@@ -33,8 +33,12 @@ namespace modeling
 
 template CGOGN_MODELING_API CMap2::Vertex quadrangule_face<CMap2>(CMap2&, CMap2::Face);
 template CGOGN_MODELING_API CMap3::Vertex quadrangule_face<CMap3>(CMap3&, CMap3::Face);
-template CGOGN_MODELING_API void catmull_clark<Eigen::Vector3f, CMap2>(CMap2&, CMap2::VertexAttribute<Eigen::Vector3f>&);
-template CGOGN_MODELING_API void catmull_clark<Eigen::Vector3d, CMap2>(CMap2&, CMap2::VertexAttribute<Eigen::Vector3d>&);
+template CGOGN_MODELING_API void catmull_clark<Eigen::Vector3f, CMap2>(CMap2&, CMap2::VertexAttribute<Eigen::Vector3f>&, uint32);
+template CGOGN_MODELING_API void catmull_clark<Eigen::Vector3d, CMap2>(CMap2&, CMap2::VertexAttribute<Eigen::Vector3d>&, uint32);
+template CGOGN_MODELING_API void catmull_clark<Eigen::Vector3f, CMap2, CMap2Quad>(CMap2&, const CMap2::VertexAttribute<Eigen::Vector3f>&, CMap2Quad&, uint32);
+template CGOGN_MODELING_API void catmull_clark<Eigen::Vector3d, CMap2, CMap2Quad>(CMap2&, const CMap2::VertexAttribute<Eigen::Vector3d>&, CMap2Quad&, uint32);
+template CGOGN_MODELING_API void catmull_clark<Eigen::Vector3f, CMap2Quad, CMap2Quad>(CMap2Quad&, const CMap2Quad::VertexAttribute<Eigen::Vector3f>&, CMap2Quad&, uint32);
+template CGOGN_MODELING_API void catmull_clark<Eigen::Vector3d, CMap2Quad, CMap2Quad>(CMap2Quad&, const CMap2Quad::VertexAttribute<Eigen::Vector3d>&, CMap2Quad&, uint32);
 
 } // namespace modeling
 
@@ -27,8 +27,11 @@
 #include <vector>
 
 #include <cgogn/modeling/dll.h>
-#include <cgogn/core/basic/dart_marker.h>
+#include <cgogn/core/utils/thread_pool.h>
+#include <cgogn/core/utils/unique_ptr.h>
+#include <cgogn/core/cmap/cmap2_quad.h>
 #include <cgogn/core/cmap/cmap3.h>
+#include <cgogn/modeling/algos/subdivision.h>
 #include <cgogn/geometry/algos/centroid.h>
 #include <cgogn/geometry/types/geometry_traits.h>
 
@@ -63,108 +66,311 @@ typename MAP::Vertex quadrangule_face(MAP& map, typename MAP::Face f)
 	return Vertex(map.phi2(x));	// Return a dart of the central vertex
 }
 
+namespace internal
+{
+
+/**
+ * @brief compute the Catmull-Clark points of a surface (in parallel, from the unmodified map)
+ * @param cells the gathered cells of the map
+ * @param vertex_points new positions of the vertices
+ * @param edge_points positions of the edge points
+ * @param face_points positions of the face points
+ */
 template <typename VEC3, typename MAP>
-void catmull_clark(MAP& map, typename MAP::template VertexAttribute<VEC3>& position)
+void catmull_clark_points(
+	const MAP& map,
+	const typename MAP::template VertexAttribute<VEC3>& position,
+	const SubdivisionCells<MAP>& cells,
+	std::vector<VEC3>& vertex_points,
+	std::vector<VEC3>& edge_points,
+	std::vector<VEC3>& face_points
+)
 {
 	using Scalar = typename geometry::vector_traits<VEC3>::Scalar;
 	using Vertex = typename MAP::Vertex;
-	using Edge = typename MAP::Edge;
-	using Face = typename MAP::Face;
 
-	DartMarker<MAP> initial_edge_marker(map);
+	const uint32 nb_vertices = uint32(cells.vertices.size());
+	const uint32 nb_edges = uint32(cells.edges.size());
+	const uint32 nb_faces = uint32(cells.faces.size());
+	const std::vector<uint32>& dart_face = cells.dart_face;
 
-	std::vector<Edge>* initial_edges = cgogn::dart_buffers()->cell_buffer<Edge>();
-	map.foreach_cell([&] (Edge e)
+	face_points.resize(nb_faces);
+	parallel_foreach_chunk(nb_faces, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
 	{
-		initial_edges->push_back(e);
-		initial_edge_marker.mark_orbit(e);
+		for (uint32 i = first; i < last; ++i)
+			face_points[i] = geometry::centroid<VEC3>(map, cells.faces[i], position);
 	});
 
-	std::vector<Vertex>* initial_vertices = cgogn::dart_buffers()->cell_buffer<Vertex>();
-	map.foreach_cell([&] (Vertex v)
+	// edge point of the edge of d
+	auto edge_point = [&] (Dart d) -> VEC3
+	{
+		const Dart d2 = map.phi2(d);
+		if (map.is_boundary(d) || map.is_boundary(d2))
+			return (position[Vertex(d)] + position[Vertex(d2)]) / Scalar(2);
+		return (position[Vertex(d)] + position[Vertex(d2)] + face_points[dart_face[d.index]] + face_points[dart_face[d2.index]]) / Scalar(4);
+	};
+
+	edge_points.resize(nb_edges);
+	parallel_foreach_chunk(nb_edges, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
 	{
-		initial_vertices->push_back(v);
+		for (uint32 i = first; i < last; ++i)
+			edge_points[i] = edge_point(cells.edges[i].dart);
 	});
 
-	for (Edge e : *initial_edges)
+	vertex_points.resize(nb_vertices);
+	parallel_foreach_chunk(nb_vertices, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
 	{
-		std::pair<Vertex,Vertex> ve = map.vertices(e);
-		Vertex middle = map.cut_edge(e);
-		position[middle] = (position[ve.first] + position[ve.second]) / Scalar(2);
-	}
+		for (uint32 i = first; i < last; ++i)
+		{
+			const Vertex v = cells.vertices[i];
+			const VEC3& p = position[v];
+
+			VEC3 sum_face; // Sum_F
+			sum_face.setZero();
+			VEC3 sum_edge; // Sum_E
+			sum_edge.setZero();
+			VEC3 sum_boundary;
+			sum_boundary.setZero();
+
+			uint32 nb_f = 0u;
+			uint32 nb_boundary = 0u;
+			SubdivisionCells<MAP>::foreach_dart_of_vertex(map, v, [&] (Dart d)
+			{
+				if (SubdivisionCells<MAP>::is_inner_boundary_edge(map, d))
+					return;
+				sum_edge += edge_point(d);
+				if (!map.is_boundary(d))
+				{
+					++nb_f;
+					sum_face += face_points[dart_face[d.index]];
+				}
+				if (map.is_boundary(d) || map.is_boundary(map.phi2(d)))
+				{
+					++nb_boundary;
+					sum_boundary += position[Vertex(map.phi2(d))];
+				}
+			});
 
-	map.foreach_cell([&] (Face f)
+			if (nb_boundary == 0u)
+			{
+				VEC3 delta = p * Scalar(-3 * int32(nb_f));
+				delta += sum_face + Scalar(2) * sum_edge;
+				delta /= Scalar(nb_f * nb_f);
+				vertex_points[i] = p + delta;
+			}
+			else if (nb_boundary == 2u) // boundary case
+				vertex_points[i] = Scalar(3.0/4.0) * p + Scalar(1.0/8.0) * sum_boundary;
+			else
+				vertex_points[i] = p;
+		}
+	});
+}
+
+/**
+ * @brief one level of Catmull-Clark subdivision
+ * The positions of all the new vertices are first computed in parallel from the unmodified map.
+ * The topology is then refined (after reservation of the memory of the new darts and vertices)
+ * and the positions are finally scattered in parallel on the vertices of the refined map.
+ */
+template <typename VEC3, typename MAP>
+void catmull_clark_level(MAP& map, typename MAP::template VertexAttribute<VEC3>& position)
+{
+	using Vertex = typename MAP::Vertex;
+
+	SubdivisionCells<MAP> cells;
+	cells.gather(map);
+
+	const uint32 nb_vertices = uint32(cells.vertices.size());
+	const uint32 nb_edges = uint32(cells.edges.size());
+	const uint32 nb_faces = uint32(cells.faces.size());
+
+	std::vector<VEC3> vertex_points;
+	std::vector<VEC3> edge_points;
+	std::vector<VEC3> face_points;
+	catmull_clark_points<VEC3>(map, position, cells, vertex_points, edge_points, face_points);
+
+	// refine the topology
+	const uint32 nb_darts = map.nb_darts();
+	map.reserve_darts(map.topology_container().end() + 2u * (nb_edges + nb_darts));
+	map.template reserve_cells<Vertex>(map.template const_attribute_container<Vertex::ORBIT>().end() + nb_edges + nb_faces);
+
+	std::vector<Vertex> edge_vertices(nb_edges);
+	for (uint32 i = 0u; i < nb_edges; ++i)
+		edge_vertices[i] = map.cut_edge(cells.edges[i]);
+
+	std::vector<Vertex> face_vertices(nb_faces);
+	for (uint32 i = 0u; i < nb_faces; ++i)
+		face_vertices[i] = quadrangule_face(map, cells.faces[i]);
+
+	// scatter the new positions
+	parallel_foreach_chunk(nb_vertices, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
 	{
-		Face ff = f;
-		if (!initial_edge_marker.is_marked(f.dart))
-			ff = Face(map.phi1(f.dart));
+		for (uint32 i = first; i < last; ++i)
+			position[cells.vertices[i]] = vertex_points[i];
+	});
+	parallel_foreach_chunk(nb_edges, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+	{
+		for (uint32 i = first; i < last; ++i)
+			position[edge_vertices[i]] = edge_points[i];
+	});
+	parallel_foreach_chunk(nb_faces, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+	{
+		for (uint32 i = first; i < last; ++i)
+			position[face_vertices[i]] = face_points[i];
+	});
+}
+
+/**
+ * @brief one level of Catmull-Clark subdivision generated in a quad map
+ * The quads are created with computed indices: the corner k of the input map (a non boundary dart d)
+ * gives the quad of darts 4k .. 4k+3 (vertex of d, edge point of d, face point, edge point of phi_1(d))
+ * and the vertices of the quad map are the vertices, the edge points and the face points of the input map.
+ */
+template <typename VEC3, typename MAP, typename QUAD_MAP>
+void catmull_clark_level(MAP& map, const typename MAP::template VertexAttribute<VEC3>& position, QUAD_MAP& quad_map)
+{
+	static_assert(QUAD_MAP::PRIM_SIZE == 4, "catmull_clark: the refined map must be a quad map");
 
-		initial_edge_marker.unmark_orbit(ff);
+	using QVertex = typename QUAD_MAP::Vertex;
+	using MapBuilder = typename QUAD_MAP::Builder;
+	using VertexContainer = typename MapBuilder::template ChunkArrayContainer<uint32>;
 
-		VEC3 center = geometry::centroid<VEC3>(map, ff, position);
-		Vertex vc = quadrangule_face(map, ff);
-		position[vc] = center;
+	SubdivisionCells<MAP> cells;
+	cells.gather(map);
+	cells.index_darts(map);
+
+	const uint32 nb_vertices = uint32(cells.vertices.size());
+	const uint32 nb_edges = uint32(cells.edges.size());
+	const uint32 nb_faces = uint32(cells.faces.size());
+	const uint32 nb_corners = cells.face_offsets.back();
+
+	std::vector<VEC3> vertex_points;
+	std::vector<VEC3> edge_points;
+	std::vector<VEC3> face_points;
+	catmull_clark_points<VEC3>(map, position, cells, vertex_points, edge_points, face_points);
+
+	// vertices of the quad map: vertices, edge points and face points
+	const uint32 edge_point_offset = nb_vertices;
+	const uint32 face_point_offset = nb_vertices + nb_edges;
+	VertexContainer vertex_container;
+	auto* quad_position = vertex_container.template add_chunk_array<VEC3>(position.name());
+	vertex_container.reserve(face_point_offset + nb_faces);
+	for (uint32 i = 0u, end = face_point_offset + nb_faces; i < end; ++i)
+		vertex_container.template insert_lines<1>();
+
+	parallel_foreach_chunk(nb_vertices, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+	{
+		for (uint32 i = first; i < last; ++i)
+			(*quad_position)[i] = vertex_points[i];
+	});
+	parallel_foreach_chunk(nb_edges, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+	{
+		for (uint32 i = first; i < last; ++i)
+			(*quad_position)[edge_point_offset + i] = edge_points[i];
+	});
+	parallel_foreach_chunk(nb_faces, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+	{
+		for (uint32 i = first; i < last; ++i)
+			(*quad_position)[face_point_offset + i] = face_points[i];
 	});
 
-	for (Edge e : *initial_edges)
+	quad_map.clear_and_remove_attributes();
+	MapBuilder mbuild(quad_map);
+	mbuild.template create_embedding<QVertex::ORBIT>();
+	mbuild.template swap_chunk_array_container<QVertex::ORBIT>(vertex_container);
+	quad_map.reserve_darts(4u * nb_corners);
+
+	// create the quads (darts 4k .. 4k+3 for the corner k)
+	for (uint32 i = 0u; i < nb_faces; ++i)
 	{
-		Dart e2 = map.phi2(e.dart);
-		if (!map.is_boundary(e.dart) && !map.is_boundary(e2))
+		SubdivisionCells<MAP>::foreach_dart_of_face(map, cells.faces[i], [&] (Dart d)
 		{
-			Vertex f1(map.template phi<11>(e.dart));
-			Vertex f2(map.phi_1(e2));
-			Vertex m(map.phi1(e.dart));
-			position[m] = (Scalar(2) * position[m] + position[f1] + position[f2]) / Scalar(4);
-		}
+			const Dart q = mbuild.add_face_topo_fp(4u);
+			cgogn_assert(q.index == 4u * cells.dart_corner[d.index]);
+			mbuild.template set_embedding<QVertex>(q, cells.dart_vertex[d.index]);
+			mbuild.template set_embedding<QVertex>(quad_map.phi1(q), edge_point_offset + cells.dart_edge[d.index]);
+			mbuild.template set_embedding<QVertex>(quad_map.template phi<11>(q), face_point_offset + i);
+			mbuild.template set_embedding<QVertex>(quad_map.phi_1(q), edge_point_offset + cells.dart_edge[map.phi_1(d).index]);
+		});
 	}
 
-	for (Vertex v : *initial_vertices)
+	// sew the quads: each pair of darts is sewn from the corner of its first dart
+	parallel_foreach_chunk(nb_faces, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
 	{
-		VEC3 sum_face; // Sum_F
-		sum_face.setZero();
-		VEC3 sum_edge;// Sum_E
-		sum_edge.setZero();
-
-		int nb_f = 0;
-		int nb_e = 0;
-		Dart bound;
-		map.foreach_incident_edge(v, [&] (Edge e)
+		for (uint32 i = first; i < last; ++i)
 		{
-			nb_e++;
-			sum_edge += position[Vertex(map.phi1(e.dart))];
-			if (!map.is_boundary(e.dart))
+			SubdivisionCells<MAP>::foreach_dart_of_face(map, cells.faces[i], [&] (Dart d)
 			{
-				nb_f++;
-				sum_face += position[Vertex(map.template phi<11>(e.dart))];
-			}
-			else
-				bound = e.dart;
-		});
-
-		if (nb_f > nb_e) // boundary case
-		{
-			Vertex e1(map.phi2(bound));
-			Vertex e2(map.phi_1(bound));
-			position[v] = Scalar(3.0/8.0) * position[v] + Scalar(1.0/4.0) * (position[e1] + position[e2]);
+				const uint32 k = cells.dart_corner[d.index];
+				// half of the edge of d, opposite to the corner of phi1(phi2(d)) in the adjacent face
+				const uint32 k_adj = cells.dart_corner[map.phi1(map.phi2(d)).index];
+				if (k_adj != INVALID_INDEX)
+					mbuild.phi2_sew(Dart(4u * k), Dart(4u * k_adj + 3u));
+				// inner edge between the face point and the edge point of d
+				mbuild.phi2_sew(Dart(4u * k + 1u), Dart(4u * cells.dart_corner[map.phi1(d).index] + 2u));
+			});
 		}
-		else
-		{
-			VEC3 delta = position[v] * Scalar(-3*nb_f);
-			delta += sum_face + Scalar(2) * sum_edge;
-			delta /= Scalar(nb_f * nb_f);
-			position[v] += delta;
-		}
-	}
+	});
 
-	cgogn::dart_buffers()->release_cell_buffer(initial_edges);
-	cgogn::dart_buffers()->release_cell_buffer(initial_vertices);
+	if (cells.has_boundary)
+		mbuild.close_map();
+}
+
+} // namespace internal
+
+/**
+ * @brief Catmull-Clark subdivision of a surface
+ * @param map the map to subdivide
+ * @param position the vertex positions
+ * @param nb_levels the number of subdivision steps
+ */
+template <typename VEC3, typename MAP>
+void catmull_clark(MAP& map, typename MAP::template VertexAttribute<VEC3>& position, uint32 nb_levels = 1u)
+{
+	for (uint32 l = 0u; l < nb_levels; ++l)
+		internal::catmull_clark_level<VEC3>(map, position);
+}
+
+/**
+ * @brief Catmull-Clark subdivision of a surface generated in a quad map (e.g. a CMap2Quad)
+ * @param map the map to subdivide (unchanged)
+ * @param position the vertex positions
+ * @param quad_map the refined map (cleared), its vertex positions are stored in an attribute of the name of position
+ * @param nb_levels the number of subdivision steps
+ * The other attributes of map are not transfered to quad_map.
+ */
+template <typename VEC3, typename MAP, typename QUAD_MAP,
+		  typename std::enable_if<QUAD_MAP::DIMENSION == 2>::type* = nullptr>
+void catmull_clark(MAP& map, const typename MAP::template VertexAttribute<VEC3>& position, QUAD_MAP& quad_map, uint32 nb_levels = 1u)
+{
+	using QVertex = typename QUAD_MAP::Vertex;
+
+	if (nb_levels == 0u)
+		return;
+
+	// the levels alternate between quad_map and a temporary map and the last one is generated in quad_map
+	std::unique_ptr<QUAD_MAP> tmp_map = nb_levels > 1u ? make_unique<QUAD_MAP>() : nullptr;
+	QUAD_MAP* target = nb_levels % 2u == 1u ? &quad_map : tmp_map.get();
+	internal::catmull_clark_level<VEC3>(map, position, *target);
+
+	for (uint32 l = 1u; l < nb_levels; ++l)
+	{
+		QUAD_MAP* source = target;
+		target = source == &quad_map ? tmp_map.get() : &quad_map;
+		const typename QUAD_MAP::template VertexAttribute<VEC3> source_position = source->template get_attribute<VEC3, QVertex>(position.name());
+		internal::catmull_clark_level<VEC3>(*source, source_position, *target);
+	}
 }
 
 #if defined(CGOGN_USE_EXTERNAL_TEMPLATES) && (!defined(CGOGN_MODELING_ALGOS_CATMULL_CLARK_CPP_))
 extern template CGOGN_MODELING_API CMap2::Vertex quadrangule_face<CMap2>(CMap2&, CMap2::Face);
 extern template CGOGN_MODELING_API CMap3::Vertex quadrangule_face<CMap3>(CMap3&, CMap3::Face);
-extern template CGOGN_MODELING_API void catmull_clark<Eigen::Vector3f, CMap2>(CMap2&, CMap2::VertexAttribute<Eigen::Vector3f>&);
-extern template CGOGN_MODELING_API void catmull_clark<Eigen::Vector3d, CMap2>(CMap2&, CMap2::VertexAttribute<Eigen::Vector3d>&);
+extern template CGOGN_MODELING_API void catmull_clark<Eigen::Vector3f, CMap2>(CMap2&, CMap2::VertexAttribute<Eigen::Vector3f>&, uint32);
+extern template CGOGN_MODELING_API void catmull_clark<Eigen::Vector3d, CMap2>(CMap2&, CMap2::VertexAttribute<Eigen::Vector3d>&, uint32);
+extern template CGOGN_MODELING_API void catmull_clark<Eigen::Vector3f, CMap2, CMap2Quad>(CMap2&, const CMap2::VertexAttribute<Eigen::Vector3f>&, CMap2Quad&, uint32);
+extern template CGOGN_MODELING_API void catmull_clark<Eigen::Vector3d, CMap2, CMap2Quad>(CMap2&, const CMap2::VertexAttribute<Eigen::Vector3d>&, CMap2Quad&, uint32);
+extern template CGOGN_MODELING_API void catmull_clark<Eigen::Vector3f, CMap2Quad, CMap2Quad>(CMap2Quad&, const CMap2Quad::VertexAttribute<Eigen::Vector3f>&, CMap2Quad&, uint32);
+extern template CGOGN_MODELING_API void catmull_clark<Eigen::Vector3d, CMap2Quad, CMap2Quad>(CMap2Quad&, const CMap2Quad::VertexAttribute<Eigen::Vector3d>&, CMap2Quad&, uint32);
 #endif // defined(CGOGN_USE_EXTERNAL_TEMPLATES) && (!defined(CGOGN_MODELING_ALGOS_CATMULL_CLARK_CPP_))
 
 } // namespace modeling
@@ -0,0 +1,626 @@
+/*******************************************************************************
+* CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+* Copyright (C) 2015, IGG Group, ICube, University of Strasbourg, France       *
+*                                                                              *
+* This library is free software; you can redistribute it and/or modify it      *
+* under the terms of the GNU Lesser General Public License as published by the *
+* Free Software Foundation; either version 2.1 of the License, or (at your     *
+* option) any later version.                                                   *
+*                                                                              *
+* This library is distributed in the hope that it will be useful, but WITHOUT  *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+* for more details.                                                            *
+*                                                                              *
+* You should have received a copy of the GNU Lesser General Public License     *
+* along with this library; if not, write to the Free Software Foundation,      *
+* Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+*                                                                              *
+* Web site: http://cgogn.unistra.fr/                                           *
+* Contact information: cgogn@unistra.fr                                        *
+*                                                                              *
+*******************************************************************************/
+
+#ifndef CGOGN_MODELING_ALGOS_DECIMATION_H_
+#define CGOGN_MODELING_ALGOS_DECIMATION_H_
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include <cgogn/modeling/dll.h>
+
+#include <cgogn/geometry/types/geometry_traits.h>
+#include <cgogn/geometry/types/quadric.h>
+
+#include <cgogn/core/cmap/cmap2.h>
+#include <cgogn/core/utils/claims.h>
+#include <cgogn/core/utils/thread_pool.h>
+
+namespace cgogn
+{
+
+namespace modeling
+{
+
+enum DecimationSchedule
+{
+	DECIMATION_GREEDY = 0,			// one collapse at a time, smallest error first
+	DECIMATION_INDEPENDENT_SETS		// rounds of collapses of edges with disjoint neighborhoods
+};
+
+namespace internal
+{
+
+/**
+ * @brief Binary min-heap of edge collapses. The position of each entry is stored by the index
+ * of the dart of the entry so that the collapse of an edge can be removed in O(log n) when its
+ * neighborhood is modified.
+ */
+template <typename VEC3>
+class CollapseHeap
+{
+public:
+
+	using Scalar = typename geometry::vector_traits<VEC3>::Scalar;
+
+	struct Entry
+	{
+		Scalar cost;
+		Dart dart;
+		VEC3 target;
+	};
+
+	void reset(uint32 nb_darts)
+	{
+		entries_.clear();
+		position_.assign(nb_darts, INVALID_INDEX);
+	}
+
+	inline bool empty() const { return entries_.empty(); }
+
+	inline const Entry& top() const { return entries_.front(); }
+
+	// builds the heap from unordered entries in linear time
+	void build(std::vector<Entry>& entries)
+	{
+		entries_.swap(entries);
+		for (uint32 i = 0u, end = uint32(entries_.size()); i < end; ++i)
+			position_[entries_[i].dart.index] = i;
+		for (uint32 i = uint32(entries_.size()) / 2u; i-- > 0u; )
+			sift_down(i);
+	}
+
+	void push(const Entry& e)
+	{
+		cgogn_message_assert(position_[e.dart.index] == INVALID_INDEX, "CollapseHeap: the dart is already in the heap");
+		entries_.push_back(e);
+		sift_up(uint32(entries_.size()) - 1u);
+	}
+
+	// removes the entry of the dart d, if any
+	void remove(Dart d)
+	{
+		const uint32 i = position_[d.index];
+		if (i == INVALID_INDEX)
+			return;
+		position_[d.index] = INVALID_INDEX;
+
+		const uint32 last = uint32(entries_.size()) - 1u;
+		if (i != last)
+		{
+			entries_[i] = entries_[last];
+			entries_.pop_back();
+			if (i > 0u && less(entries_[i], entries_[(i - 1u) / 2u]))
+				sift_up(i);
+			else
+				sift_down(i);
+		}
+		else
+			entries_.pop_back();
+	}
+
+	inline void pop()
+	{
+		remove(entries_.front().dart);
+	}
+
+private:
+
+	// the ties are broken by dart index so that the order of the collapses is deterministic
+	static inline bool less(const Entry& a, const Entry& b)
+	{
+		return a.cost < b.cost || (a.cost == b.cost && a.dart.index < b.dart.index);
+	}
+
+	inline void set(uint32 i, const Entry& e)
+	{
+		entries_[i] = e;
+		position_[e.dart.index] = i;
+	}
+
+	void sift_up(uint32 i)
+	{
+		const Entry e = entries_[i];
+		while (i > 0u)
+		{
+			const uint32 parent = (i - 1u) / 2u;
+			if (!less(e, entries_[parent]))
+				break;
+			set(i, entries_[parent]);
+			i = parent;
+		}
+		set(i, e);
+	}
+
+	void sift_down(uint32 i)
+	{
+		const Entry e = entries_[i];
+		const uint32 n = uint32(entries_.size());
+		for (uint32 child = 2u * i + 1u; child < n; child = 2u * i + 1u)
+		{
+			if (child + 1u < n && less(entries_[child + 1u], entries_[child]))
+				++child;
+			if (!less(entries_[child], e))
+				break;
+			set(i, entries_[child]);
+			i = child;
+		}
+		set(i, e);
+	}
+
+	std::vector<Entry> entries_;
+	std::vector<uint32> position_;
+};
+
+/**
+ * @brief Decimation of a triangulated surface by edge collapses driven by quadric error
+ * metrics (Garland & Heckbert 1997). The quadrics of the vertices are stored in a vertex
+ * attribute and summed by the collapses. The vertices of the boundary are kept in place.
+ * The greedy schedule collapses the edge of smallest error, maintained in an indexed heap.
+ * The independent sets schedule collapses by rounds the edges of smallest error within their
+ * neighborhood (the vertices of their incident faces, selected with Claims): the errors and the
+ * selection are computed in parallel. The collapses release darts and are applied sequentially.
+ */
+template <typename VEC3>
+class QEMDecimation
+{
+public:
+
+	using Scalar = typename geometry::vector_traits<VEC3>::Scalar;
+	using Quadric = geometry::Quadric<VEC3>;
+	using Heap = CollapseHeap<VEC3>;
+	using Entry = typename Heap::Entry;
+
+	using Vertex = CMap2::Vertex;
+	using Edge = CMap2::Edge;
+	using Face = CMap2::Face;
+
+	template <typename T>
+	using VertexAttribute = CMap2::VertexAttribute<T>;
+
+	QEMDecimation(CMap2& map, VertexAttribute<VEC3>& position) :
+		map_(map),
+		position_(position),
+		nb_faces_(0u)
+	{
+		quadric_ = map_.template add_attribute<Quadric, Vertex>("__qem_quadric__");
+	}
+
+	~QEMDecimation()
+	{
+		map_.remove_attribute(quadric_);
+	}
+
+	QEMDecimation(const QEMDecimation&) = delete;
+	QEMDecimation& operator=(const QEMDecimation&) = delete;
+
+	/**
+	 * @brief collapses edges until the surface has at most nb_faces faces or no valid collapse remains
+	 * @return the number of removed faces
+	 */
+	uint32 run(uint32 nb_faces, DecimationSchedule schedule)
+	{
+		init_quadrics();
+		const uint32 nb_initial_faces = nb_faces_;
+		if (nb_faces_ > nb_faces)
+		{
+			if (schedule == DECIMATION_GREEDY)
+				greedy(nb_faces);
+			else
+				independent_sets(nb_faces);
+		}
+		return nb_initial_faces - nb_faces_;
+	}
+
+private:
+
+	inline const VEC3& pos(Dart d) const { return position_[Vertex(d)]; }
+
+	inline uint32 vertex_index(Dart d) const { return map_.embedding(Vertex(d)); }
+
+	inline Dart canonical(Dart d) const
+	{
+		const Dart d2 = map_.phi2(d);
+		return d.index < d2.index ? d : d2;
+	}
+
+	inline bool is_boundary_vertex(Dart v) const
+	{
+		bool result = false;
+		map_.foreach_dart_of_orbit(Vertex(v), [&] (Dart d) -> bool
+		{
+			result = map_.is_boundary(d);
+			return !result;
+		});
+		return result;
+	}
+
+	// the quadric of a vertex is the sum of the (area weighted) quadrics of its incident triangles
+	void init_quadrics()
+	{
+		map_.parallel_foreach_cell([&] (Vertex v, uint32)
+		{
+			Quadric q;
+			map_.foreach_dart_of_orbit(v, [&] (Dart d)
+			{
+				if (!map_.is_boundary(d))
+					q += Quadric::triangle(pos(d), pos(map_.phi1(d)), pos(map_.phi_1(d)));
+			});
+			quadric_[v] = q;
+		});
+		nb_faces_ = map_.template nb_cells<Face::ORBIT>();
+	}
+
+	// the faces of v (except the faces of the collapsed edge) must not flip when v moves to target
+	bool folds(Dart v, Dart f1, Dart f2, const VEC3& target) const
+	{
+		bool result = false;
+		map_.foreach_dart_of_orbit(Vertex(v), [&] (Dart d) -> bool
+		{
+			if (d == f1 || d == f2 || map_.is_boundary(d))
+				return true;
+			const VEC3& p1 = pos(map_.phi1(d));
+			const VEC3& p2 = pos(map_.phi_1(d));
+			const VEC3 e = p2 - p1;
+			result = e.cross(pos(d) - p1).dot(e.cross(target - p1)) <= Scalar(0);
+			return !result;
+		});
+		return result;
+	}
+
+	/**
+	 * @brief computes the error and the position of the vertex resulting from the collapse of the edge of d
+	 * @return false if the edge cannot be collapsed (boundary edge, link condition, folded triangles)
+	 */
+	bool evaluate(Dart d, Scalar& cost, VEC3& target) const
+	{
+		if (!map_.edge_can_collapse(Edge(d)))
+			return false;
+
+		const Dart d2 = map_.phi2(d);
+		const bool ba = is_boundary_vertex(d);
+		const bool bb = is_boundary_vertex(d2);
+		if (ba && bb)
+			return false;
+
+		const Quadric q = quadric_[Vertex(d)] + quadric_[Vertex(d2)];
+		if (ba)
+			target = pos(d);
+		else if (bb)
+			target = pos(d2);
+		else if (!q.optimized(target))
+		{
+			// degenerated quadric (flat or cylindrical neighborhood): best of the ends and the midpoint
+			const VEC3 mid = Scalar(0.5) * (pos(d) + pos(d2));
+			target = mid;
+			Scalar best = q(mid);
+			for (const VEC3* p : { &pos(d), &pos(d2) })
+			{
+				const Scalar e = q(*p);
+				if (e < best)
+				{
+					best = e;
+					target = *p;
+				}
+			}
+		}
+		cost = std::max(q(target), Scalar(0));
+
+		return !folds(d, d, map_.phi1(d2), target) && !folds(d2, d2, map_.phi1(d), target);
+	}
+
+	// collapses the edge of d and its two incident triangles
+	Vertex collapse(Dart d, const VEC3& target)
+	{
+		const Dart d2 = map_.phi2(d);
+		const Quadric q = quadric_[Vertex(d)] + quadric_[Vertex(d2)];
+		const Dart f1 = map_.phi1(d);
+		const Dart f2 = map_.phi1(d2);
+
+		const Vertex v = map_.collapse_edge(Edge(d));
+		map_.collapse_degenerated_face(Face(f1));
+		map_.collapse_degenerated_face(Face(f2));
+
+		position_[v] = target;
+		quadric_[v] = q;
+		nb_faces_ -= 2u;
+		return v;
+	}
+
+	// evaluates all the edges in parallel
+	void evaluate_all_edges(std::vector<Entry>& entries) const
+	{
+		std::vector<std::vector<Entry>> thread_entries(thread_pool()->nb_threads());
+		map_.parallel_foreach_cell([&] (Edge e, uint32 th_id)
+		{
+			Entry entry;
+			entry.dart = e.dart;
+			if (evaluate(e.dart, entry.cost, entry.target))
+				thread_entries[th_id].push_back(entry);
+		});
+
+		entries.clear();
+		for (const std::vector<Entry>& te : thread_entries)
+			entries.insert(entries.end(), te.begin(), te.end());
+	}
+
+	/**
+	 * @brief the collapse of smallest error is applied first. It modifies the quadric of one vertex:
+	 * only its incident edges are evaluated again. The other entries are validated when popped.
+	 */
+	void greedy(uint32 nb_faces)
+	{
+		std::vector<Entry> entries;
+		evaluate_all_edges(entries);
+		heap_.reset(map_.topology_container().end());
+		heap_.build(entries);
+
+		Entry entry;
+		while (nb_faces_ > nb_faces && !heap_.empty())
+		{
+			const Dart d = heap_.top().dart;
+			heap_.pop();
+			if (!evaluate(d, entry.cost, entry.target))
+				continue;
+
+			// the darts of the edges of the ends are released or their error changes
+			for (Dart v : { d, map_.phi2(d) })
+			{
+				map_.foreach_dart_of_orbit(Vertex(v), [&] (Dart dv)
+				{
+					heap_.remove(dv);
+					heap_.remove(map_.phi2(dv));
+				});
+			}
+
+			const Vertex v = collapse(d, entry.target);
+
+			map_.foreach_dart_of_orbit(v, [&] (Dart dv)
+			{
+				entry.dart = dv;
+				if (evaluate(dv, entry.cost, entry.target))
+					heap_.push(entry);
+			});
+		}
+	}
+
+	// unique rank of a collapse: the error in the high bits, the dart index in the low bits
+	static inline uint64 rank(Scalar cost, Dart d)
+	{
+		const float32 c = float32(cost);
+		uint32 bits;
+		std::memcpy(&bits, &c, sizeof(bits));
+		return (uint64(bits) << 32u) | uint64(d.index);
+	}
+
+	// calls func on the vertices of the faces incident to the edge of d
+	template <typename FUNC>
+	inline void edge_stencil(Dart d, const FUNC& func) const
+	{
+		func(vertex_index(d));
+		for (Dart v : { d, map_.phi2(d) })
+			map_.foreach_dart_of_orbit(Vertex(v), [&] (Dart dv) { func(vertex_index(map_.phi1(dv))); });
+	}
+
+	/**
+	 * @brief each round collapses a maximal set of independent edges among the valid edges of
+	 * smallest error, selected by passes of Claims: the edges of smallest error within their
+	 * neighborhood are selected, then the edges that do not touch a selected edge compete again.
+	 */
+	void independent_sets(uint32 nb_faces)
+	{
+		const Scalar invalid = std::numeric_limits<Scalar>::max();
+		const uint32 nb_darts = map_.topology_container().end();
+		const uint32 nb_vertices = map_.const_attribute_container<Vertex::ORBIT>().end();
+		cost_.assign(nb_darts, invalid);
+		target_.resize(nb_darts);
+		locked_.resize(nb_vertices);
+
+		auto update = [&] (Dart d)
+		{
+			if (!evaluate(d, cost_[d.index], target_[d.index]))
+				cost_[d.index] = invalid;
+		};
+		auto rank_of = [&] (Dart d) -> uint64 { return rank(cost_[d.index], d); };
+
+		map_.parallel_foreach_cell([&] (Edge e, uint32) { update(canonical(e.dart)); });
+
+		std::vector<std::vector<Dart>> thread_candidates(thread_pool()->nb_threads());
+		std::vector<Dart> candidates;
+		std::vector<uint8> status;
+		std::vector<Dart> selected;
+		std::vector<Dart> dirty;
+
+		while (nb_faces_ > nb_faces)
+		{
+			map_.parallel_foreach_cell([&] (Edge e, uint32 th_id)
+			{
+				const Dart d = canonical(e.dart);
+				if (cost_[d.index] < invalid)
+					thread_candidates[th_id].push_back(d);
+			});
+			candidates.clear();
+			for (std::vector<Dart>& tc : thread_candidates)
+			{
+				candidates.insert(candidates.end(), tc.begin(), tc.end());
+				tc.clear();
+			}
+			if (candidates.empty())
+				break;
+
+			// only the edges of smallest error compete in a round (a pool a few times larger than
+			// the number of independent edges keeps the passes cheap and the order close to greedy)
+			const std::size_t nb_candidates = std::max(candidates.size() / 32u, std::min(candidates.size(), std::size_t(64u)));
+			if (nb_candidates < candidates.size())
+			{
+				std::nth_element(candidates.begin(), candidates.begin() + nb_candidates, candidates.end(),
+					[&] (Dart a, Dart b) { return rank_of(a) < rank_of(b); });
+				candidates.resize(nb_candidates);
+			}
+
+			claims_.reset(nb_vertices);
+			parallel_foreach_chunk(nb_vertices, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+			{
+				std::fill(locked_.begin() + first, locked_.begin() + last, uint8(0));
+			});
+
+			// 0: competing, 1: selected, 2: conflicting with a selected edge
+			selected.clear();
+			while (!candidates.empty())
+			{
+				const uint32 nb = uint32(candidates.size());
+				status.assign(nb, uint8(0));
+				parallel_foreach_chunk(nb, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+				{
+					for (uint32 i = first; i < last; ++i)
+					{
+						const uint64 r = rank_of(candidates[i]);
+						edge_stencil(candidates[i], [&] (uint32 v) { claims_.claim(v, r); });
+					}
+				});
+				// the stencils of the selected edges are disjoint: each locked vertex is written by one thread
+				parallel_foreach_chunk(nb, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+				{
+					for (uint32 i = first; i < last; ++i)
+					{
+						const uint64 r = rank_of(candidates[i]);
+						bool owner = true;
+						edge_stencil(candidates[i], [&] (uint32 v) { owner = owner && claims_.owns(v, r); });
+						if (owner)
+						{
+							status[i] = 1u;
+							edge_stencil(candidates[i], [&] (uint32 v) { locked_[v] = 1u; });
+						}
+					}
+				});
+				// the claims of the edges that are not selected are released for the next pass
+				parallel_foreach_chunk(nb, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+				{
+					for (uint32 i = first; i < last; ++i)
+					{
+						if (status[i] == 0u)
+						{
+							edge_stencil(candidates[i], [&] (uint32 v)
+							{
+								if (locked_[v])
+									status[i] = 2u;
+								else
+									claims_.release(v);
+							});
+						}
+					}
+				});
+
+				uint32 nb_remaining = 0u;
+				for (uint32 i = 0u; i < nb; ++i)
+				{
+					if (status[i] == 1u)
+						selected.push_back(candidates[i]);
+					else if (status[i] == 0u)
+						candidates[nb_remaining++] = candidates[i];
+				}
+				candidates.resize(nb_remaining);
+			}
+
+			// keep the collapses of smallest error when the round would go beyond the target
+			const uint32 budget = (nb_faces_ - nb_faces + 1u) / 2u;
+			if (selected.size() > budget)
+			{
+				std::nth_element(selected.begin(), selected.begin() + budget, selected.end(),
+					[&] (Dart a, Dart b) { return rank_of(a) < rank_of(b); });
+				selected.resize(budget);
+			}
+
+			// the errors change only for the edges incident to the new vertices: the validity of the
+			// other edges may be outdated and is checked again when they are selected
+			dirty.clear();
+			for (Dart d : selected)
+			{
+				Scalar cost;
+				VEC3 target;
+				if (!evaluate(d, cost, target))
+				{
+					cost_[d.index] = invalid;
+					continue;
+				}
+				const Vertex v = collapse(d, target);
+				map_.foreach_dart_of_orbit(v, [&] (Dart dv) { dirty.push_back(canonical(dv)); });
+			}
+
+			std::sort(dirty.begin(), dirty.end(), [] (Dart a, Dart b) { return a.index < b.index; });
+			dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+			parallel_foreach_chunk(uint32(dirty.size()), PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+			{
+				for (uint32 i = first; i < last; ++i)
+					update(dirty[i]);
+			});
+		}
+	}
+
+	CMap2& map_;
+	VertexAttribute<VEC3>& position_;
+	VertexAttribute<Quadric> quadric_;
+	uint32 nb_faces_;
+
+	Heap heap_;
+
+	Claims claims_;
+	std::vector<Scalar> cost_;
+	std::vector<VEC3> target_;
+	std::vector<uint8> locked_;
+};
+
+} // namespace internal
+
+/**
+ * @brief simplifies a triangulated surface by quadric error metric edge collapses
+ * @param map the surface
+ * @param position the vertex positions
+ * @param nb_faces the number of faces to reach
+ * @param schedule greedy (indexed heap of edges) or parallel rounds of independent collapses
+ * @return the number of removed faces
+ */
+template <typename VEC3>
+uint32 qem_decimation(
+	CMap2& map,
+	typename CMap2::template VertexAttribute<VEC3>& position,
+	uint32 nb_faces,
+	DecimationSchedule schedule = DECIMATION_GREEDY
+)
+{
+	internal::QEMDecimation<VEC3> decimation(map, position);
+	return decimation.run(nb_faces, schedule);
+}
+
+#if defined(CGOGN_USE_EXTERNAL_TEMPLATES) && (!defined(CGOGN_MODELING_ALGOS_DECIMATION_CPP_))
+extern template CGOGN_MODELING_API uint32 qem_decimation<Eigen::Vector3f>(CMap2&, CMap2::VertexAttribute<Eigen::Vector3f>&, uint32, DecimationSchedule);
+extern template CGOGN_MODELING_API uint32 qem_decimation<Eigen::Vector3d>(CMap2&, CMap2::VertexAttribute<Eigen::Vector3d>&, uint32, DecimationSchedule);
+#endif // defined(CGOGN_USE_EXTERNAL_TEMPLATES) && (!defined(CGOGN_MODELING_ALGOS_DECIMATION_CPP_))
+
+} // namespace modeling
+
+} // namespace cgogn
+
+#endif // CGOGN_MODELING_ALGOS_DECIMATION_H_
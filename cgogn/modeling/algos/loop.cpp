@@ -31,10 +31,14 @@ namespace cgogn
 namespace modeling
 {
 
-template CGOGN_MODELING_API void loop<Eigen::Vector3f, CMap2>(CMap2&, CMap2::VertexAttribute<Eigen::Vector3f>&);
-template CGOGN_MODELING_API void loop<Eigen::Vector3d, CMap2>(CMap2&, CMap2::VertexAttribute<Eigen::Vector3d>&);
-template CGOGN_MODELING_API void loop<Eigen::Vector3f, CMap3>(CMap3&, CMap3::VertexAttribute<Eigen::Vector3f>&);
-template CGOGN_MODELING_API void loop<Eigen::Vector3d, CMap3>(CMap3&, CMap3::VertexAttribute<Eigen::Vector3d>&);
+template CGOGN_MODELING_API void loop<Eigen::Vector3f, CMap2>(CMap2&, CMap2::VertexAttribute<Eigen::Vector3f>&, uint32);
+template CGOGN_MODELING_API void loop<Eigen::Vector3d, CMap2>(CMap2&, CMap2::VertexAttribute<Eigen::Vector3d>&, uint32);
+template CGOGN_MODELING_API void loop<Eigen::Vector3f, CMap3>(CMap3&, CMap3::VertexAttribute<Eigen::Vector3f>&, uint32);
+template CGOGN_MODELING_API void loop<Eigen::Vector3d, CMap3>(CMap3&, CMap3::VertexAttribute<Eigen::Vector3d>&, uint32);
+template CGOGN_MODELING_API void loop<Eigen::Vector3f, CMap2, CMap2Tri>(CMap2&, const CMap2::VertexAttribute<Eigen::Vector3f>&, CMap2Tri&, uint32);
+template CGOGN_MODELING_API void loop<Eigen::Vector3d, CMap2, CMap2Tri>(CMap2&, const CMap2::VertexAttribute<Eigen::Vector3d>&, CMap2Tri&, uint32);
+template CGOGN_MODELING_API void loop<Eigen::Vector3f, CMap2Tri, CMap2Tri>(CMap2Tri&, const CMap2Tri::VertexAttribute<Eigen::Vector3f>&, CMap2Tri&, uint32);
+template CGOGN_MODELING_API void loop<Eigen::Vector3d, CMap2Tri, CMap2Tri>(CMap2Tri&, const CMap2Tri::VertexAttribute<Eigen::Vector3d>&, CMap2Tri&, uint32);
 
 } // namespace modeling
 
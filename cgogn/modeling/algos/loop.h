@@ -27,8 +27,11 @@
 #include <vector>
 
 #include <cgogn/modeling/dll.h>
-#include <cgogn/core/basic/dart_marker.h>
+#include <cgogn/core/utils/thread_pool.h>
+#include <cgogn/core/utils/unique_ptr.h>
+#include <cgogn/core/cmap/cmap2_tri.h>
 #include <cgogn/core/cmap/cmap3.h>
+#include <cgogn/modeling/algos/subdivision.h>
 #include <cgogn/geometry/types/geometry_traits.h>
 
 namespace cgogn
@@ -37,110 +40,314 @@ namespace cgogn
 namespace modeling
 {
 
+namespace internal
+{
+
+/**
+ * @brief compute the Loop points of a triangulated surface (in parallel, from the unmodified map)
+ * @param cells the gathered cells of the map
+ * @param vertex_points new positions of the vertices
+ * @param edge_points positions of the edge points
+ */
 template <typename VEC3, typename MAP>
-void loop(MAP& map, typename MAP::template VertexAttribute<VEC3>& position)
+void loop_points(
+	const MAP& map,
+	const typename MAP::template VertexAttribute<VEC3>& position,
+	const SubdivisionCells<MAP>& cells,
+	std::vector<VEC3>& vertex_points,
+	std::vector<VEC3>& edge_points
+)
 {
 	using Scalar = typename geometry::vector_traits<VEC3>::Scalar;
 	using Vertex = typename MAP::Vertex;
-	using Edge = typename MAP::Edge;
-	using Face = typename MAP::Face;
 
-	typename MAP::template VertexAttribute<VEC3> position2 = map.template add_attribute<VEC3, Vertex>("position_tempo_loop");
+	const uint32 nb_vertices = uint32(cells.vertices.size());
+	const uint32 nb_edges = uint32(cells.edges.size());
 
-	DartMarker<MAP> initial_edge_marker(map);
-
-	std::vector<Edge>* initial_edges = cgogn::dart_buffers()->cell_buffer<Edge>();
-	map.foreach_cell([&] (Edge e)
+	// compute position of new edge points
+	edge_points.resize(nb_edges);
+	parallel_foreach_chunk(nb_edges, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
 	{
-		initial_edges->push_back(e);
-		initial_edge_marker.mark_orbit(e);
+		for (uint32 i = first; i < last; ++i)
+		{
+			const Dart d = cells.edges[i].dart;
+			const Dart d2 = map.phi2(d);
+			const VEC3& p1 = position[Vertex(d)];
+			const VEC3& p2 = position[Vertex(d2)];
+			if (map.is_boundary(d) || map.is_boundary(d2))
+				edge_points[i] = (p1 + p2) / Scalar(2);
+			else
+			{
+				const VEC3& pr = position[Vertex(map.phi_1(d))];
+				const VEC3& pl = position[Vertex(map.phi_1(d2))];
+				edge_points[i] = Scalar(3.0/8.0) * (p1 + p2) + Scalar(1.0/8.0) * (pr + pl);
+			}
+		}
 	});
 
-	std::vector<Vertex>* initial_vertices = cgogn::dart_buffers()->cell_buffer<Vertex>();
-	map.foreach_cell([&] (Vertex v)
+	// compute new position of old vertices
+	vertex_points.resize(nb_vertices);
+	parallel_foreach_chunk(nb_vertices, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
 	{
-		initial_vertices->push_back(v);
+		for (uint32 i = first; i < last; ++i)
+		{
+			const Vertex v = cells.vertices[i];
+			const VEC3& p = position[v];
+
+			VEC3 sum_edge; // Sum_E
+			sum_edge.setZero();
+			VEC3 sum_boundary;
+			sum_boundary.setZero();
+
+			uint32 nb_e = 0u;
+			uint32 nb_boundary = 0u;
+			SubdivisionCells<MAP>::foreach_dart_of_vertex(map, v, [&] (Dart d)
+			{
+				if (SubdivisionCells<MAP>::is_inner_boundary_edge(map, d))
+					return;
+				const VEC3& q = position[Vertex(map.phi2(d))];
+				++nb_e;
+				sum_edge += q;
+				if (map.is_boundary(d) || map.is_boundary(map.phi2(d)))
+				{
+					++nb_boundary;
+					sum_boundary += q;
+				}
+			});
+
+			if (nb_boundary == 0u)
+			{
+				float64 beta = 3.0 / 16.0;
+				if (nb_e > 3)
+					beta = 3.0 / (8.0 * nb_e);
+				vertex_points[i] = Scalar(beta) * sum_edge + Scalar(1.0 - beta * nb_e) * p;
+			}
+			else if (nb_boundary == 2u) // boundary case
+				vertex_points[i] = Scalar(3.0/4.0) * p + Scalar(1.0/8.0) * sum_boundary;
+			else
+				vertex_points[i] = p;
+		}
 	});
+}
+
+/**
+ * @brief one level of Loop subdivision
+ * The positions of all the new vertices are first computed in parallel from the unmodified map.
+ * The topology is then refined (after reservation of the memory of the new darts and vertices)
+ * and the positions are finally scattered in parallel on the vertices of the refined map.
+ */
+template <typename VEC3, typename MAP>
+void loop_level(MAP& map, typename MAP::template VertexAttribute<VEC3>& position)
+{
+	using Vertex = typename MAP::Vertex;
+	using Face = typename MAP::Face;
+
+	SubdivisionCells<MAP> cells;
+	cells.gather(map);
 
-	// cut edges
-	for (Edge e : *initial_edges)
+	const uint32 nb_vertices = uint32(cells.vertices.size());
+	const uint32 nb_edges = uint32(cells.edges.size());
+	const uint32 nb_faces = uint32(cells.faces.size());
+
+	std::vector<VEC3> vertex_points;
+	std::vector<VEC3> edge_points;
+	loop_points<VEC3>(map, position, cells, vertex_points, edge_points);
+
+	// refine the topology
+	map.reserve_darts(map.topology_container().end() + 2u * nb_edges + 6u * nb_faces);
+	map.template reserve_cells<Vertex>(map.template const_attribute_container<Vertex::ORBIT>().end() + nb_edges);
+
+	std::vector<Vertex> edge_vertices(nb_edges);
+	for (uint32 i = 0u; i < nb_edges; ++i)
+		edge_vertices[i] = map.cut_edge(cells.edges[i]);
+
+	// add edges inside faces (the dart of a face still starts on an old vertex)
+	for (Face f : cells.faces)
 	{
-//		std::pair<Vertex, Vertex> ve = map.vertices(e);
-		map.cut_edge(e);
+		Dart d0 = map.phi1(f.dart);
+
+		Dart d1 = map.template phi<11>(d0);
+		map.cut_face(d0, d1);
+
+		Dart d2 = map.template phi<11>(d1);
+		map.cut_face(d1, d2);
+
+		Dart d3 = map.template phi<11>(d2);
+		map.cut_face(d2, d3);
 	}
 
-	// compute position of new edge points
-	for (Edge e : *initial_edges)
+	// scatter the new positions
+	parallel_foreach_chunk(nb_vertices, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
 	{
-		Vertex v1(e.dart);
-		Vertex v2(map.template phi<12>(e.dart));
-		Vertex nve(map.phi1(e.dart));
-		Vertex vr(map.template phi<2111>(e.dart));
-		Vertex vl(map.phi_1(map.phi_1(e.dart)));
+		for (uint32 i = first; i < last; ++i)
+			position[cells.vertices[i]] = vertex_points[i];
+	});
+	parallel_foreach_chunk(nb_edges, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+	{
+		for (uint32 i = first; i < last; ++i)
+			position[edge_vertices[i]] = edge_points[i];
+	});
+}
 
-		position2[nve] = Scalar(3.0/8.0) * (position[v1] + position[v2]) + Scalar(1.0/8.0) * (position[vr] + position[vl]);
-	}
+/**
+ * @brief one level of Loop subdivision generated in a triangle map
+ * The triangles are created with computed indices: the corner k of the input map (a non boundary dart d)
+ * gives the triangle of darts 3k .. 3k+2 (vertex of d, edge point of d, edge point of phi_1(d))
+ * and the face i gives the central triangle of darts 3(nb_corners+i) .. 3(nb_corners+i)+2.
+ * The vertices of the triangle map are the vertices and the edge points of the input map.
+ */
+template <typename VEC3, typename MAP, typename TRI_MAP>
+void loop_level(MAP& map, const typename MAP::template VertexAttribute<VEC3>& position, TRI_MAP& tri_map)
+{
+	static_assert(TRI_MAP::PRIM_SIZE == 3, "loop: the refined map must be a triangle map");
 
-	// compute new position of old vertices
-	for (Vertex v : *initial_vertices)
+	using Face = typename MAP::Face;
+	using TVertex = typename TRI_MAP::Vertex;
+	using MapBuilder = typename TRI_MAP::Builder;
+	using VertexContainer = typename MapBuilder::template ChunkArrayContainer<uint32>;
+
+	SubdivisionCells<MAP> cells;
+	cells.gather(map);
+	cells.index_darts(map);
+
+	const uint32 nb_vertices = uint32(cells.vertices.size());
+	const uint32 nb_edges = uint32(cells.edges.size());
+	const uint32 nb_faces = uint32(cells.faces.size());
+	const uint32 nb_corners = cells.face_offsets.back();
+	cgogn_message_assert(nb_corners == 3u * nb_faces, "loop: the surface should be triangulated");
+
+	std::vector<VEC3> vertex_points;
+	std::vector<VEC3> edge_points;
+	loop_points<VEC3>(map, position, cells, vertex_points, edge_points);
+
+	// vertices of the triangle map: vertices and edge points
+	const uint32 edge_point_offset = nb_vertices;
+	VertexContainer vertex_container;
+	auto* tri_position = vertex_container.template add_chunk_array<VEC3>(position.name());
+	vertex_container.reserve(nb_vertices + nb_edges);
+	for (uint32 i = 0u, end = nb_vertices + nb_edges; i < end; ++i)
+		vertex_container.template insert_lines<1>();
+
+	parallel_foreach_chunk(nb_vertices, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+	{
+		for (uint32 i = first; i < last; ++i)
+			(*tri_position)[i] = vertex_points[i];
+	});
+	parallel_foreach_chunk(nb_edges, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
 	{
-		VEC3 sum_edge;// Sum_E
-		sum_edge.setZero();
+		for (uint32 i = first; i < last; ++i)
+			(*tri_position)[edge_point_offset + i] = edge_points[i];
+	});
+
+	tri_map.clear_and_remove_attributes();
+	MapBuilder mbuild(tri_map);
+	mbuild.template create_embedding<TVertex::ORBIT>();
+	mbuild.template swap_chunk_array_container<TVertex::ORBIT>(vertex_container);
+	tri_map.reserve_darts(3u * (nb_corners + nb_faces));
 
-		int nb_e = 0;
-		Dart bound;
-		map.foreach_incident_edge(v, [&] (Edge e)
+	// create the corner triangles (darts 3k .. 3k+2 for the corner k)
+	for (Face f : cells.faces)
+	{
+		SubdivisionCells<MAP>::foreach_dart_of_face(map, f, [&] (Dart d)
 		{
-			nb_e++;
-			sum_edge += position[Vertex(map.template phi<12>(e.dart))];
-			if (map.is_boundary(e.dart))
-				bound = e.dart;
+			const Dart t = mbuild.add_face_topo_fp(3u);
+			cgogn_assert(t.index == 3u * cells.dart_corner[d.index]);
+			mbuild.template set_embedding<TVertex>(t, cells.dart_vertex[d.index]);
+			mbuild.template set_embedding<TVertex>(tri_map.phi1(t), edge_point_offset + cells.dart_edge[d.index]);
+			mbuild.template set_embedding<TVertex>(tri_map.phi_1(t), edge_point_offset + cells.dart_edge[map.phi_1(d).index]);
 		});
+	}
 
-		if (!bound.is_nil()) // boundary case
-		{
-			Vertex e1(map.phi2(bound));
-			Vertex e2(map.phi_1(bound));
-			position2[v] = Scalar(3.0/4.0) * position[v] + Scalar(1.0/8.0) * (position[e1]+position[e2]);
-		}
-		else
+	// create the central triangles (the dart j goes from the edge point of dj to the one of dj+1)
+	for (Face f : cells.faces)
+	{
+		Dart t = mbuild.add_face_topo_fp(3u);
+		SubdivisionCells<MAP>::foreach_dart_of_face(map, f, [&] (Dart d)
 		{
-			float64 beta = 3.0 / 16.0;
-			if (nb_e > 3)
-				beta = 3.0 / (8.0 * nb_e);
-			position2[v] = Scalar(beta)*sum_edge + Scalar(1.0-beta*nb_e) * position[v];
-		}
+			mbuild.template set_embedding<TVertex>(t, edge_point_offset + cells.dart_edge[d.index]);
+			t = tri_map.phi1(t);
+		});
 	}
 
-	// add edges inside faces
-	map.foreach_cell([&] (Face f)
+	// sew the triangles: each pair of darts is sewn from the corner of its first dart
+	parallel_foreach_chunk(nb_faces, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
 	{
-		Dart d0 = f.dart;
-		if (initial_edge_marker.is_marked(d0))
-			d0 = map.phi1(d0);
+		for (uint32 i = first; i < last; ++i)
+		{
+			uint32 j = 0u;
+			SubdivisionCells<MAP>::foreach_dart_of_face(map, cells.faces[i], [&] (Dart d)
+			{
+				const uint32 k = cells.dart_corner[d.index];
+				// half of the edge of d, opposite to the corner of phi1(phi2(d)) in the adjacent face
+				const uint32 k_adj = cells.dart_corner[map.phi1(map.phi2(d)).index];
+				if (k_adj != INVALID_INDEX)
+					mbuild.phi2_sew(Dart(3u * k), Dart(3u * k_adj + 2u));
+				// inner edge between the corner triangle of phi1(d) and the central triangle
+				mbuild.phi2_sew(Dart(3u * (nb_corners + i) + j), Dart(3u * cells.dart_corner[map.phi1(d).index] + 1u));
+				++j;
+			});
+		}
+	});
 
-		Dart d1 = map.template phi<11>(d0);
-		map.cut_face(d0, d1);
+	if (cells.has_boundary)
+		mbuild.close_map();
+}
 
-		Dart d2 = map.template phi<11>(d1);
-		map.cut_face(d1, d2);
+} // namespace internal
 
-		Dart d3 = map.template phi<11>(d2);
-		map.cut_face(d2, d3);
-	});
+/**
+ * @brief Loop subdivision of a triangulated surface
+ * @param map the map to subdivide
+ * @param position the vertex positions
+ * @param nb_levels the number of subdivision steps
+ */
+template <typename VEC3, typename MAP>
+void loop(MAP& map, typename MAP::template VertexAttribute<VEC3>& position, uint32 nb_levels = 1u)
+{
+	for (uint32 l = 0u; l < nb_levels; ++l)
+		internal::loop_level<VEC3>(map, position);
+}
 
-	cgogn::dart_buffers()->release_cell_buffer(initial_edges);
-	cgogn::dart_buffers()->release_cell_buffer(initial_vertices);
+/**
+ * @brief Loop subdivision of a triangulated surface generated in a triangle map (e.g. a CMap2Tri)
+ * @param map the map to subdivide (unchanged)
+ * @param position the vertex positions
+ * @param tri_map the refined map (cleared), its vertex positions are stored in an attribute of the name of position
+ * @param nb_levels the number of subdivision steps
+ * The other attributes of map are not transfered to tri_map.
+ */
+template <typename VEC3, typename MAP, typename TRI_MAP,
+		  typename std::enable_if<TRI_MAP::DIMENSION == 2>::type* = nullptr>
+void loop(MAP& map, const typename MAP::template VertexAttribute<VEC3>& position, TRI_MAP& tri_map, uint32 nb_levels = 1u)
+{
+	using TVertex = typename TRI_MAP::Vertex;
 
-	map.swap_attributes(position, position2);
-	map.remove_attribute(position2);
+	if (nb_levels == 0u)
+		return;
+
+	// the levels alternate between tri_map and a temporary map and the last one is generated in tri_map
+	std::unique_ptr<TRI_MAP> tmp_map = nb_levels > 1u ? make_unique<TRI_MAP>() : nullptr;
+	TRI_MAP* target = nb_levels % 2u == 1u ? &tri_map : tmp_map.get();
+	internal::loop_level<VEC3>(map, position, *target);
+
+	for (uint32 l = 1u; l < nb_levels; ++l)
+	{
+		TRI_MAP* source = target;
+		target = source == &tri_map ? tmp_map.get() : &tri_map;
+		const typename TRI_MAP::template VertexAttribute<VEC3> source_position = source->template get_attribute<VEC3, TVertex>(position.name());
+		internal::loop_level<VEC3>(*source, source_position, *target);
+	}
 }
 
 #if defined(CGOGN_USE_EXTERNAL_TEMPLATES) && (!defined(CGOGN_MODELING_ALGOS_LOOP_CPP_))
-extern template CGOGN_MODELING_API void loop<Eigen::Vector3f, CMap2>(CMap2&, CMap2::VertexAttribute<Eigen::Vector3f>&);
-extern template CGOGN_MODELING_API void loop<Eigen::Vector3d, CMap2>(CMap2&, CMap2::VertexAttribute<Eigen::Vector3d>&);
-extern template CGOGN_MODELING_API void loop<Eigen::Vector3f, CMap3>(CMap3&, CMap3::VertexAttribute<Eigen::Vector3f>&);
-extern template CGOGN_MODELING_API void loop<Eigen::Vector3d, CMap3>(CMap3&, CMap3::VertexAttribute<Eigen::Vector3d>&);
+extern template CGOGN_MODELING_API void loop<Eigen::Vector3f, CMap2>(CMap2&, CMap2::VertexAttribute<Eigen::Vector3f>&, uint32);
+extern template CGOGN_MODELING_API void loop<Eigen::Vector3d, CMap2>(CMap2&, CMap2::VertexAttribute<Eigen::Vector3d>&, uint32);
+extern template CGOGN_MODELING_API void loop<Eigen::Vector3f, CMap3>(CMap3&, CMap3::VertexAttribute<Eigen::Vector3f>&, uint32);
+extern template CGOGN_MODELING_API void loop<Eigen::Vector3d, CMap3>(CMap3&, CMap3::VertexAttribute<Eigen::Vector3d>&, uint32);
+extern template CGOGN_MODELING_API void loop<Eigen::Vector3f, CMap2, CMap2Tri>(CMap2&, const CMap2::VertexAttribute<Eigen::Vector3f>&, CMap2Tri&, uint32);
+extern template CGOGN_MODELING_API void loop<Eigen::Vector3d, CMap2, CMap2Tri>(CMap2&, const CMap2::VertexAttribute<Eigen::Vector3d>&, CMap2Tri&, uint32);
+extern template CGOGN_MODELING_API void loop<Eigen::Vector3f, CMap2Tri, CMap2Tri>(CMap2Tri&, const CMap2Tri::VertexAttribute<Eigen::Vector3f>&, CMap2Tri&, uint32);
+extern template CGOGN_MODELING_API void loop<Eigen::Vector3d, CMap2Tri, CMap2Tri>(CMap2Tri&, const CMap2Tri::VertexAttribute<Eigen::Vector3d>&, CMap2Tri&, uint32);
 #endif // defined(CGOGN_USE_EXTERNAL_TEMPLATES) && (!defined(CGOGN_MODELING_ALGOS_LOOP_CPP_))
 
 } // namespace modeling
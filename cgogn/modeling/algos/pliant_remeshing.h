@@ -24,14 +24,24 @@
 #ifndef CGOGN_MODELING_ALGOS_PLIANT_REMESHING_H_
 #define CGOGN_MODELING_ALGOS_PLIANT_REMESHING_H_
 
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
 #include <cgogn/modeling/dll.h>
 
 #include <cgogn/geometry/functions/basics.h>
+#include <cgogn/geometry/functions/normal.h>
 #include <cgogn/geometry/types/geometry_traits.h>
 #include <cgogn/geometry/algos/length.h>
+#include <cgogn/geometry/algos/normal.h>
 
 #include <cgogn/core/cmap/cmap2.h>
 #include <cgogn/core/utils/masks.h>
+#include <cgogn/core/utils/claims.h>
+#include <cgogn/core/utils/thread_pool.h>
 
 namespace cgogn
 {
@@ -39,100 +49,598 @@ namespace cgogn
 namespace modeling
 {
 
+/**
+ * @brief Instrumentation hook of the remeshing, called at the end of each pass with
+ * the name of the pass ("features", "split", "collapse", "flip" or "smooth"), the iteration,
+ * the number of local operations applied and the duration of the pass in seconds
+ */
+using RemeshingPassHook = std::function<void(const std::string&, uint32, uint32, float64)>;
+
+struct PliantRemeshingParameters
+{
+	float64 edge_length_target;	// 0 to use the mean edge length of the input mesh
+	uint32 nb_iterations;
+	bool preserve_features;		// keep the sharp edges in place (the boundary is always kept)
+	float64 feature_angle;		// dihedral angle (radians) above which an edge is sharp
+	RemeshingPassHook pass_hook;
+
+	PliantRemeshingParameters() :
+		edge_length_target(0.0),
+		nb_iterations(5u),
+		preserve_features(false),
+		feature_angle(M_PI / 6.0)
+	{}
+};
+
+namespace internal
+{
+
+/**
+ * @brief Isotropic remesher of a triangulated surface (Botsch & Kobbelt 2004).
+ * Each iteration splits the long edges, collapses the short ones, equalizes the valences
+ * with edge flips and relaxes the vertices in their tangent plane.
+ * The candidate edges of a pass are evaluated in parallel. The flips are applied in parallel by
+ * rounds of operations with disjoint stencils (Claims) and the smoothing is a parallel
+ * Jacobi step. The splits and the collapses allocate or release darts and are applied
+ * sequentially (the splits by rounds of independent edges, longest first).
+ */
 template <typename VEC3>
-void pliant_remeshing(
-	CMap2& map,
-	typename CMap2::template VertexAttribute<VEC3>& position
-)
+class PliantRemeshing
 {
+public:
+
 	using Scalar = typename geometry::vector_traits<VEC3>::Scalar;
 	using Vertex = typename CMap2::Vertex;
 	using Edge = typename CMap2::Edge;
+	using Face = typename CMap2::Face;
+	using VertexAttribute = typename CMap2::template VertexAttribute<VEC3>;
+
+	PliantRemeshing(CMap2& map, VertexAttribute& position, const PliantRemeshingParameters& params) :
+		map_(map),
+		position_(position),
+		params_(params),
+		feature_(map)
+	{
+		Scalar l = Scalar(params.edge_length_target);
+		if (l <= Scalar(0))
+			l = geometry::mean_edge_length<VEC3>(map, position);
+		squared_max_length_ = Scalar(16.0/9.0) * l * l;	// (4/3 l)^2
+		squared_min_length_ = Scalar(16.0/25.0) * l * l;	// (4/5 l)^2
+	}
+
+	void run()
+	{
+		if (params_.preserve_features)
+			timed_pass("features", 0u, [&] () { return mark_features(); });
 
-	CellCache<CMap2> cache(map);
-	cache.template build<Edge>();
+		for (uint32 it = 0u; it < params_.nb_iterations; ++it)
+		{
+			timed_pass("split", it, [&] () { return split_long_edges(); });
+			timed_pass("collapse", it, [&] () { return collapse_short_edges(); });
+			timed_pass("flip", it, [&] () { return equalize_valences(); });
+			timed_pass("smooth", it, [&] () { return tangential_relaxation(); });
+		}
+	}
+
+private:
+
+	template <typename PASS>
+	void timed_pass(const std::string& name, uint32 iteration, const PASS& pass)
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+		const uint32 nb_operations = pass();
+		const std::chrono::duration<float64> elapsed = std::chrono::high_resolution_clock::now() - start;
+		if (params_.pass_hook)
+			params_.pass_hook(name, iteration, nb_operations, elapsed.count());
+	}
+
+	inline const VEC3& pos(Dart d) const { return position_[Vertex(d)]; }
+
+	inline uint32 vertex_index(Dart d) const { return map_.embedding(Vertex(d)); }
+
+	inline Scalar squared_length(Dart d) const { return (pos(map_.phi1(d)) - pos(d)).squaredNorm(); }
 
-	Scalar mean_edge_length = geometry::mean_edge_length<VEC3>(map, cache, position);
+	inline bool is_triangle(Dart d) const { return map_.phi1(map_.phi1(map_.phi1(d))) == d; }
 
-	const Scalar squared_max_edge_length = Scalar(0.5625) * mean_edge_length * mean_edge_length; // 0.5625 = 0.75^2
-	const Scalar squared_min_edge_length = Scalar(1.5625) * mean_edge_length * mean_edge_length; // 1.5625 = 1.25^2
+	// boundary vertices and the vertices of sharp edges are not moved
+	bool is_feature_vertex(Dart v) const
+	{
+		bool result = false;
+		map_.foreach_dart_of_orbit(Vertex(v), [&] (Dart d) -> bool
+		{
+			result = map_.is_boundary(d) || feature_.is_marked(d);
+			return !result;
+		});
+		return result;
+	}
 
-	// cut long edges (and adjacent faces)
-	map.foreach_cell([&] (Edge e)
+	uint32 mark_features()
 	{
-		std::pair<Vertex,Vertex> v = map.vertices(e);
-		const VEC3& edge = position[v.first] - position[v.second];
-		if (edge.squaredNorm() > squared_max_edge_length)
+		std::vector<std::vector<Dart>> sharp_edges(thread_pool()->nb_threads());
+		const Scalar cos_angle = Scalar(std::cos(params_.feature_angle));
+		map_.parallel_foreach_cell([&] (Edge e, uint32 th_id)
+		{
+			if (map_.is_incident_to_boundary(e))
+				return;
+			const VEC3 n1 = geometry::normal<VEC3>(map_, Face(e.dart), position_);
+			const VEC3 n2 = geometry::normal<VEC3>(map_, Face(map_.phi2(e.dart)), position_);
+			if (n1.dot(n2) < cos_angle)
+				sharp_edges[th_id].push_back(e.dart);
+		});
+
+		// dart markers are bit fields: they are set sequentially
+		uint32 nb_features = 0u;
+		for (const std::vector<Dart>& edges : sharp_edges)
 		{
-			Dart e2 = map.phi2(e.dart);
-			Vertex nv = map.cut_edge(e);
-			position[nv] = Scalar(0.5) * (position[v.first] + position[v.second]);
-			map.cut_face(nv.dart, map.phi_1(e.dart));
-			if(!map.is_boundary(e2))
-				map.cut_face(map.phi1(e2), map.phi_1(e2));
+			for (Dart d : edges)
+				feature_.mark_orbit(Edge(d));
+			nb_features += uint32(edges.size());
 		}
-	},
-	cache);
+		return nb_features;
+	}
 
-	// collapse short edges
+	/**
+	 * @brief evaluates in parallel the candidate edges and sorts them by key.
+	 * All the edges are evaluated in the first round of a pass, the next rounds only
+	 * evaluate the dirty edges: the candidates that were not applied in the previous round
+	 * and the edges around the vertices modified by the applied operations.
+	 */
+	template <typename FILTER>
+	void gather_candidates(const FILTER& filter, bool all_edges)
+	{
+		using Candidate = std::pair<Scalar, Dart>;
+
+		// the candidates are represented by the dart of lowest index of their edge
+		auto edge_dart = [&] (Dart d) -> Dart
+		{
+			const Dart d2 = map_.phi2(d);
+			return d2.index < d.index ? d2 : d;
+		};
 
-	map.foreach_cell([&] (Edge e)
+		candidates_.clear();
+		if (all_edges)
+		{
+			std::vector<std::vector<Candidate>> per_thread(thread_pool()->nb_threads());
+			map_.parallel_foreach_cell([&] (Edge e, uint32 th_id)
+			{
+				const Dart d = edge_dart(e.dart);
+				Scalar key;
+				if (filter(d, key))
+					per_thread[th_id].push_back(std::make_pair(key, d));
+			});
+			for (const std::vector<Candidate>& v : per_thread)
+				candidates_.insert(candidates_.end(), v.begin(), v.end());
+		}
+		else
+		{
+			for (Dart& d : dirty_)
+				d = edge_dart(d);
+			std::sort(dirty_.begin(), dirty_.end(), [] (Dart a, Dart b) { return a.index < b.index; });
+			dirty_.erase(std::unique(dirty_.begin(), dirty_.end()), dirty_.end());
+
+			const uint32 nb_dirty = uint32(dirty_.size());
+			std::vector<Candidate> evaluated(nb_dirty);
+			keep_.assign(nb_dirty, 0u);
+			parallel_foreach_chunk(nb_dirty, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+			{
+				for (uint32 i = first; i < last; ++i)
+				{
+					Scalar key;
+					if (filter(dirty_[i], key))
+					{
+						evaluated[i] = std::make_pair(key, dirty_[i]);
+						keep_[i] = 1u;
+					}
+				}
+			});
+			for (uint32 i = 0u; i < nb_dirty; ++i)
+				if (keep_[i])
+					candidates_.push_back(evaluated[i]);
+		}
+		dirty_.clear();
+
+		std::sort(candidates_.begin(), candidates_.end(), [] (const Candidate& a, const Candidate& b)
+		{
+			if (a.first != b.first)
+				return a.first < b.first;
+			const uint32 pa = claim_priority(a.second.index);
+			const uint32 pb = claim_priority(b.second.index);
+			return pa < pb || (pa == pb && a.second.index < b.second.index);
+		});
+		// an edge may be found from its two darts
+		candidates_.erase(std::unique(candidates_.begin(), candidates_.end(), [] (const Candidate& a, const Candidate& b)
+		{
+			return a.second == b.second;
+		}),
+		candidates_.end());
+	}
+
+	/**
+	 * @brief selects among the sorted candidates a subset whose stencils (the vertices of the faces
+	 * incident to the edge) are pairwise disjoint: a candidate is selected if its key is the lowest
+	 * among the candidates that conflict with it. The other candidates are dirty.
+	 */
+	void select_independent(std::vector<Dart>& selected)
 	{
-		std::pair<Vertex,Vertex> v = map.vertices(e);
-		const VEC3& edge = position[v.first] - position[v.second];
-		if(edge.squaredNorm() < squared_min_edge_length)
+		const uint32 nb_candidates = uint32(candidates_.size());
+		claims_.reset(map_.const_attribute_container<Vertex::ORBIT>().end());
+		parallel_foreach_chunk(nb_candidates, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
 		{
-			bool collapse = true;
-			const VEC3& p = position[v.second];
-			map.foreach_adjacent_vertex_through_edge(v.second, [&] (Vertex vv)
+			for (uint32 r = first; r < last; ++r)
+				edge_stencil(candidates_[r].second, [&] (uint32 v) { claims_.claim(v, r); });
+		});
+
+		keep_.assign(nb_candidates, 0u);
+		parallel_foreach_chunk(nb_candidates, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+		{
+			for (uint32 r = first; r < last; ++r)
 			{
-				const VEC3& vec = p - position[vv];
-				if (vec.squaredNorm() > squared_max_edge_length)
-					collapse = false;
+				bool owner = true;
+				edge_stencil(candidates_[r].second, [&] (uint32 v) { owner = owner && claims_.owns(v, r); });
+				keep_[r] = owner ? 1u : 0u;
+			}
+		});
+
+		selected.clear();
+		for (uint32 r = 0u; r < nb_candidates; ++r)
+		{
+			if (keep_[r])
+				selected.push_back(candidates_[r].second);
+			else
+				dirty_.push_back(candidates_[r].second);
+		}
+	}
+
+	// the edges of the faces incident to the vertex of v are dirty
+	void add_dirty_vertex(Dart v)
+	{
+		map_.foreach_dart_of_orbit(Vertex(v), [&] (Dart d)
+		{
+			dirty_.push_back(d);
+			dirty_.push_back(map_.phi1(d));
+		});
+	}
+
+	// the vertices of the faces incident to the edge of d
+	template <typename FUNC>
+	void edge_stencil(Dart d, const FUNC& func) const
+	{
+		const Dart d2 = map_.phi2(d);
+		func(vertex_index(d));
+		func(vertex_index(d2));
+		if (!map_.is_boundary(d))
+			func(vertex_index(map_.phi_1(d)));
+		if (!map_.is_boundary(d2))
+			func(vertex_index(map_.phi_1(d2)));
+	}
+
+	uint32 split_long_edges()
+	{
+		uint32 nb_splits = 0u;
+		for (bool all_edges = true; ; all_edges = false)
+		{
+			gather_candidates(
+				[&] (Dart d, Scalar& key) -> bool
+				{
+					key = -squared_length(d); // longest edges first
+					return -key > squared_max_length_;
+				},
+				all_edges
+			);
+			select_independent(selected_);
+			if (selected_.empty())
+				break;
+
+			for (Dart d : selected_)
+			{
+				const Dart d2 = map_.phi2(d);
+				const bool feature = feature_.is_marked(d);
+				const VEC3 mid = Scalar(0.5) * (pos(d) + pos(d2));
+
+				const Vertex nv = map_.cut_edge(Edge(d));
+				position_[nv] = mid;
+				if (!map_.is_boundary(d))
+					map_.cut_face(nv.dart, map_.phi_1(d));
+				if (!map_.is_boundary(d2))
+					map_.cut_face(map_.phi1(d2), map_.phi_1(d2));
+
+				if (feature)
+				{
+					feature_.mark_orbit(Edge(d));
+					feature_.mark_orbit(Edge(nv.dart));
+				}
+				add_dirty_vertex(nv.dart);
+			}
+			nb_splits += uint32(selected_.size());
+		}
+		return nb_splits;
+	}
+
+	/**
+	 * @brief checks that the edge of d can be collapsed and computes the position of the resulting vertex:
+	 * the two incident faces are inner triangles, the link condition holds, no long edge or
+	 * flipped triangle is created and a feature vertex is kept in place
+	 */
+	bool collapse_target(Dart d, VEC3& target) const
+	{
+		if (!map_.edge_can_collapse(Edge(d)))
+			return false;
+
+		const Dart d2 = map_.phi2(d);
+		const bool fa = is_feature_vertex(d);
+		const bool fb = is_feature_vertex(d2);
+		if (fa && fb)
+			return false;
+		if (map_.degree(Vertex(d)) + map_.degree(Vertex(d2)) < 7u)
+			return false;
+		target = fa ? pos(d) : (fb ? pos(d2) : Scalar(0.5) * (pos(d) + pos(d2)));
+
+		bool valid = true;
+		// the faces incident to one of the vertices (and not to the edge) are moved
+		auto check_vertex = [&] (Dart v, Dart f1, Dart f2) -> bool
+		{
+			map_.foreach_dart_of_orbit(Vertex(v), [&] (Dart dv) -> bool
+			{
+				if (dv == f1 || dv == f2 || map_.is_boundary(dv))
+					return true;
+				const VEC3& p1 = pos(map_.phi1(dv));
+				const VEC3& p2 = pos(map_.phi_1(dv));
+				if ((p1 - target).squaredNorm() > squared_max_length_)
+					valid = false;
+				else
+				{
+					const VEC3 n_before = geometry::normal(pos(dv), p1, p2);
+					const VEC3 n_after = geometry::normal(target, p1, p2);
+					valid = n_before.dot(n_after) > Scalar(0);
+				}
+				return valid;
 			});
-			if(collapse)
+			return valid;
+		};
+		return check_vertex(d, d, map_.phi1(d2)) && check_vertex(d2, d2, map_.phi1(d));
+	}
+
+	/**
+	 * @brief the collapses release darts and modify the neighborhoods of their vertices:
+	 * they are applied sequentially in the order of the candidates (shortest edges first)
+	 * and each candidate is validated again at the time of its application
+	 */
+	uint32 collapse_short_edges()
+	{
+		uint32 nb_collapses = 0u;
+		VEC3 target;
+		typename CMap2::DartMarker removed(map_);
+		for (bool all_edges = true; ; all_edges = false)
+		{
+			gather_candidates(
+				[&] (Dart d, Scalar& key) -> bool
+				{
+					VEC3 t;
+					key = squared_length(d); // shortest edges first
+					return key < squared_min_length_ && collapse_target(d, t);
+				},
+				all_edges
+			);
+
+			uint32 nb_round_collapses = 0u;
+			for (const std::pair<Scalar, Dart>& c : candidates_)
 			{
-//				Vertex cv = map.collapse_edge(e);
-//				position[cv] = p;
+				const Dart d = c.second;
+				// the removed darts stay marked since no dart is created during the pass
+				if (removed.is_marked(d) || squared_length(d) >= squared_min_length_ || !collapse_target(d, target))
+					continue;
+
+				const Dart d2 = map_.phi2(d);
+				const Dart f1 = map_.phi1(d);
+				const Dart f2 = map_.phi1(d2);
+				for (Dart r : { d, d2, f1, map_.phi1(f1), f2, map_.phi1(f2) })
+					removed.mark(r);
+
+				const Vertex v = map_.collapse_edge(Edge(d));
+				position_[v] = target;
+
+				for (Dart f : { f1, f2 })
+				{
+					const bool feature = feature_.is_marked(map_.phi2(f)) || feature_.is_marked(map_.phi2(map_.phi1(f)));
+					const Edge e = map_.collapse_degenerated_face(Face(f));
+					if (feature)
+						feature_.mark_orbit(e);
+				}
+
+				// the collapse modifies the degrees, the links and the geometry around the neighbors of v
+				add_dirty_vertex(v.dart);
+				map_.foreach_dart_of_orbit(v, [&] (Dart dv) { add_dirty_vertex(map_.phi1(dv)); });
+				++nb_round_collapses;
 			}
+			if (nb_round_collapses == 0u)
+				break;
+			nb_collapses += nb_round_collapses;
+
+			dirty_.erase(std::remove_if(dirty_.begin(), dirty_.end(), [&] (Dart d) { return removed.is_marked(d); }), dirty_.end());
 		}
-	});
-
-	// equalize valences with edge flips
-	typename CMap2::DartMarker dm(map);
-	map.foreach_cell(
-		[&] (Edge e)
-		{
-			map.flip_edge(e); // flip edge
-			const Dart d = e.dart;
-			const Dart d2 = map.phi2(d);
-			dm.mark_orbit(Edge(map.phi1(d)));
-			dm.mark_orbit(Edge(map.phi_1(d))); // mark adjacent
-			dm.mark_orbit(Edge(map.phi1(d2))); // edges
-			dm.mark_orbit(Edge(map.phi_1(d2)));
-		},
-		// this filter only keeps edges that are not marked
-		// and whose incident vertices' degree meet some requirements
-		[&] (Edge e) -> bool
-		{
-			if (dm.is_marked(e.dart))
-				return false;
-			std::pair<Vertex,Vertex> v = map.vertices(e);
-			const uint32 w = map.degree(v.first);
-			const uint32 x = map.degree(v.second);
-			const uint32 y = map.degree(Vertex(map.phi1(map.phi1(v.first.dart))));
-			const uint32 z = map.degree(Vertex(map.phi1(map.phi1(v.second.dart))));
-			int32 flip = 0;
-			flip += w > 6 ? 1 : (w < 6 ? -1 : 0);
-			flip += x > 6 ? 1 : (x < 6 ? -1 : 0);
-			flip += y < 6 ? 1 : (y > 6 ? -1 : 0);
-			flip += z < 6 ? 1 : (z > 6 ? -1 : 0);
-			return flip > 1;
+		return nb_collapses;
+	}
+
+	// difference between the degree of the vertex of v and its optimal valence (6 inside, 4 on the boundary)
+	inline int32 valence_deviation(Dart v, uint32& degree) const
+	{
+		bool boundary = false;
+		degree = 0u;
+		map_.foreach_dart_of_orbit(Vertex(v), [&] (Dart d)
+		{
+			++degree;
+			boundary = boundary || map_.is_boundary(d);
+		});
+		return int32(degree) - (boundary ? 4 : 6);
+	}
+
+	// an inner edge is flipped when it reduces the deviation of the valences of the 4 vertices of its faces
+	bool flip_improves(Dart d) const
+	{
+		const Dart d2 = map_.phi2(d);
+		if (map_.is_boundary(d) || map_.is_boundary(d2) || feature_.is_marked(d) || !is_triangle(d) || !is_triangle(d2))
+			return false;
+
+		const Dart c = map_.phi_1(d);
+		const Dart x = map_.phi_1(d2);
+		uint32 deg_a, deg_b, deg_c, deg_x;
+		const int32 va = valence_deviation(d, deg_a);
+		const int32 vb = valence_deviation(d2, deg_b);
+		if (deg_a <= 3u || deg_b <= 3u)
+			return false;
+		const int32 vc = valence_deviation(c, deg_c);
+		const int32 vx = valence_deviation(x, deg_x);
+
+		const int32 before = std::abs(va) + std::abs(vb) + std::abs(vc) + std::abs(vx);
+		const int32 after = std::abs(va - 1) + std::abs(vb - 1) + std::abs(vc + 1) + std::abs(vx + 1);
+		if (after >= before)
+			return false;
+
+		// c and x should not already be linked
+		const uint32 index_x = vertex_index(x);
+		bool linked = false;
+		map_.foreach_dart_of_orbit(Vertex(c), [&] (Dart dc) -> bool
+		{
+			linked = vertex_index(map_.phi1(dc)) == index_x;
+			return !linked;
+		});
+		if (linked)
+			return false;
+
+		// the new triangles (a,x,c) and (x,b,c) should not fold
+		const VEC3& pa = pos(d);
+		const VEC3& pb = pos(d2);
+		const VEC3& pc = pos(c);
+		const VEC3& px = pos(x);
+		const VEC3 n = geometry::normal(pa, pb, pc) + geometry::normal(pb, pa, px);
+		return geometry::normal(pa, px, pc).dot(n) > Scalar(0) && geometry::normal(px, pb, pc).dot(n) > Scalar(0);
+	}
+
+	uint32 equalize_valences()
+	{
+		uint32 nb_flips = 0u;
+		for (bool all_edges = true; ; all_edges = false)
+		{
+			gather_candidates(
+				[&] (Dart d, Scalar& key) -> bool
+				{
+					key = Scalar(0);
+					return flip_improves(d);
+				},
+				all_edges
+			);
+			select_independent(selected_);
+			if (selected_.empty())
+				break;
+
+			// the selected flips modify disjoint sets of faces and vertices
+			parallel_foreach_chunk(uint32(selected_.size()), PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+			{
+				for (uint32 i = first; i < last; ++i)
+					map_.flip_edge(Edge(selected_[i]));
+			});
+			for (Dart d : selected_)
+			{
+				const Dart d2 = map_.phi2(d);
+				for (Dart v : { d, map_.phi_1(d), d2, map_.phi_1(d2) })
+					add_dirty_vertex(v);
+			}
+			nb_flips += uint32(selected_.size());
 		}
-	);
+		return nb_flips;
+	}
+
+	uint32 tangential_relaxation()
+	{
+		std::vector<Vertex> vertices;
+		map_.foreach_cell([&] (Vertex v)
+		{
+			if (!is_feature_vertex(v.dart))
+				vertices.push_back(v);
+		});
+
+		const uint32 nb_vertices = uint32(vertices.size());
+		std::vector<VEC3> new_position(nb_vertices);
+		parallel_foreach_chunk(nb_vertices, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+		{
+			for (uint32 i = first; i < last; ++i)
+			{
+				const Vertex v = vertices[i];
+				VEC3 q;
+				q.setZero();
+				uint32 nb_neighbors = 0u;
+				map_.foreach_dart_of_orbit(v, [&] (Dart d)
+				{
+					q += pos(map_.phi1(d));
+					++nb_neighbors;
+				});
+				q /= Scalar(nb_neighbors);
+
+				// move the vertex toward the barycenter of its neighbors in its tangent plane
+				const VEC3 n = geometry::normal<VEC3>(map_, v, position_);
+				const VEC3& p = position_[v];
+				new_position[i] = q + n * n.dot(p - q);
+			}
+		});
+
+		parallel_foreach_chunk(nb_vertices, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+		{
+			for (uint32 i = first; i < last; ++i)
+				position_[vertices[i]] = new_position[i];
+		});
+		return nb_vertices;
+	}
+
+	CMap2& map_;
+	VertexAttribute& position_;
+	const PliantRemeshingParameters& params_;
+	typename CMap2::DartMarker feature_;
+
+	Scalar squared_max_length_;
+	Scalar squared_min_length_;
+
+	Claims claims_;
+	std::vector<std::pair<Scalar, Dart>> candidates_;
+	std::vector<uint8> keep_;
+	std::vector<Dart> selected_;
+	std::vector<Dart> dirty_;
+};
+
+} // namespace internal
+
+/**
+ * @brief isotropic remeshing of a triangulated surface
+ * @param map the surface
+ * @param position the vertex positions
+ * @param params the target edge length, the number of iterations, the feature preservation
+ * and the instrumentation hook
+ */
+template <typename VEC3>
+void pliant_remeshing(
+	CMap2& map,
+	typename CMap2::template VertexAttribute<VEC3>& position,
+	const PliantRemeshingParameters& params
+)
+{
+	internal::PliantRemeshing<VEC3> remeshing(map, position, params);
+	remeshing.run();
+}
+
+/**
+ * @brief isotropic remeshing of a triangulated surface toward its mean edge length
+ */
+template <typename VEC3>
+void pliant_remeshing(
+	CMap2& map,
+	typename CMap2::template VertexAttribute<VEC3>& position
+)
+{
+	pliant_remeshing<VEC3>(map, position, PliantRemeshingParameters());
 }
 
 #if defined(CGOGN_USE_EXTERNAL_TEMPLATES) && (!defined(CGOGN_MODELING_ALGOS_PLIANT_REMESHING_CPP_))
+extern template CGOGN_MODELING_API void pliant_remeshing<Eigen::Vector3f>(CMap2&, CMap2::VertexAttribute<Eigen::Vector3f>&, const PliantRemeshingParameters&);
+extern template CGOGN_MODELING_API void pliant_remeshing<Eigen::Vector3d>(CMap2&, CMap2::VertexAttribute<Eigen::Vector3d>&, const PliantRemeshingParameters&);
 extern template CGOGN_MODELING_API void pliant_remeshing<Eigen::Vector3f>(CMap2&, CMap2::VertexAttribute<Eigen::Vector3f>&);
 extern template CGOGN_MODELING_API void pliant_remeshing<Eigen::Vector3d>(CMap2&, CMap2::VertexAttribute<Eigen::Vector3d>&);
 #endif // defined(CGOGN_USE_EXTERNAL_TEMPLATES) && (!defined(CGOGN_MODELING_ALGOS_PLIANT_REMESHING_CPP_))
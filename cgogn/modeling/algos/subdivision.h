@@ -0,0 +1,176 @@
+/*******************************************************************************
+* CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+* Copyright (C) 2015, IGG Group, ICube, University of Strasbourg, France       *
+*                                                                              *
+* This library is free software; you can redistribute it and/or modify it      *
+* under the terms of the GNU Lesser General Public License as published by the *
+* Free Software Foundation; either version 2.1 of the License, or (at your     *
+* option) any later version.                                                   *
+*                                                                              *
+* This library is distributed in the hope that it will be useful, but WITHOUT  *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+* for more details.                                                            *
+*                                                                              *
+* You should have received a copy of the GNU Lesser General Public License     *
+* along with this library; if not, write to the Free Software Foundation,      *
+* Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+*                                                                              *
+* Web site: http://cgogn.unistra.fr/                                           *
+* Contact information: cgogn@unistra.fr                                        *
+*                                                                              *
+*******************************************************************************/
+
+#ifndef CGOGN_MODELING_ALGOS_SUBDIVISION_H_
+#define CGOGN_MODELING_ALGOS_SUBDIVISION_H_
+
+#include <vector>
+
+#include <cgogn/core/utils/thread_pool.h>
+#include <cgogn/core/basic/dart.h>
+
+namespace cgogn
+{
+
+namespace modeling
+{
+
+namespace internal
+{
+
+/**
+ * @brief The cells of a surface gathered before its subdivision.
+ * The local indices of the cells of each dart can also be computed
+ * to generate a refined map with computed indices.
+ */
+template <typename MAP>
+struct SubdivisionCells
+{
+	using Vertex = typename MAP::Vertex;
+	using Edge = typename MAP::Edge;
+	using Face = typename MAP::Face;
+
+	std::vector<Vertex> vertices;
+	std::vector<Edge> edges;
+	std::vector<Face> faces;
+	bool has_boundary;
+
+	// local index of the face of each dart (INVALID_INDEX for boundary darts)
+	std::vector<uint32> dart_face;
+
+	// filled by index_darts
+	std::vector<uint32> dart_vertex;
+	std::vector<uint32> dart_edge;
+	std::vector<uint32> dart_corner;	// position of each non boundary dart in the concatenation of the faces
+	std::vector<uint32> face_offsets;	// index of the first corner of each face
+
+	SubdivisionCells() : has_boundary(false)
+	{}
+
+	// traversal of the darts of a face (in phi1 order) available in all surface maps
+	template <typename FUNC>
+	static void foreach_dart_of_face(const MAP& map, Face f, const FUNC& func)
+	{
+		Dart it = f.dart;
+		do
+		{
+			func(it);
+			it = map.phi1(it);
+		} while (it != f.dart);
+	}
+
+	// traversal of the darts of a vertex (in phi21 order) available in all surface maps
+	template <typename FUNC>
+	static void foreach_dart_of_vertex(const MAP& map, Vertex v, const FUNC& func)
+	{
+		Dart it = v.dart;
+		do
+		{
+			func(it);
+			it = map.phi2(map.phi_1(it));
+		} while (it != v.dart);
+	}
+
+	// the edges inside the boundary fans that close the holes of CMap2Tri / CMap2Quad have two boundary darts
+	static bool is_inner_boundary_edge(const MAP& map, Dart d)
+	{
+		return map.is_boundary(d) && map.is_boundary(map.phi2(d));
+	}
+
+	void gather(const MAP& map)
+	{
+		vertices.clear();
+		edges.clear();
+		faces.clear();
+		map.foreach_cell([&] (Vertex v) { vertices.push_back(v); });
+		map.foreach_cell([&] (Edge e) { edges.push_back(e); });
+		map.foreach_cell([&] (Face f) { faces.push_back(f); });
+
+		has_boundary = false;
+		for (Edge e : edges)
+		{
+			if (map.is_boundary(e.dart) || map.is_boundary(map.phi2(e.dart)))
+			{
+				has_boundary = true;
+				break;
+			}
+		}
+
+		dart_face.assign(map.topology_container().end(), INVALID_INDEX);
+		parallel_foreach_chunk(uint32(faces.size()), PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+		{
+			for (uint32 i = first; i < last; ++i)
+				foreach_dart_of_face(map, faces[i], [&] (Dart d) { dart_face[d.index] = i; });
+		});
+	}
+
+	void index_darts(const MAP& map)
+	{
+		const uint32 nb_darts = map.topology_container().end();
+		const uint32 nb_faces = uint32(faces.size());
+
+		dart_vertex.assign(nb_darts, INVALID_INDEX);
+		parallel_foreach_chunk(uint32(vertices.size()), PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+		{
+			for (uint32 i = first; i < last; ++i)
+				foreach_dart_of_vertex(map, vertices[i], [&] (Dart d) { dart_vertex[d.index] = i; });
+		});
+
+		dart_edge.assign(nb_darts, INVALID_INDEX);
+		parallel_foreach_chunk(uint32(edges.size()), PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+		{
+			for (uint32 i = first; i < last; ++i)
+			{
+				dart_edge[edges[i].dart.index] = i;
+				dart_edge[map.phi2(edges[i].dart).index] = i;
+			}
+		});
+
+		face_offsets.assign(nb_faces + 1u, 0u);
+		parallel_foreach_chunk(nb_faces, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+		{
+			for (uint32 i = first; i < last; ++i)
+				face_offsets[i + 1u] = map.codegree(faces[i]);
+		});
+		for (uint32 i = 0u; i < nb_faces; ++i)
+			face_offsets[i + 1u] += face_offsets[i];
+
+		dart_corner.assign(nb_darts, INVALID_INDEX);
+		parallel_foreach_chunk(nb_faces, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+		{
+			for (uint32 i = first; i < last; ++i)
+			{
+				uint32 k = face_offsets[i];
+				foreach_dart_of_face(map, faces[i], [&] (Dart d) { dart_corner[d.index] = k++; });
+			}
+		});
+	}
+};
+
+} // namespace internal
+
+} // namespace modeling
+
+} // namespace cgogn
+
+#endif // CGOGN_MODELING_ALGOS_SUBDIVISION_H_
@@ -0,0 +1,449 @@
+/*******************************************************************************
+* CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+* Copyright (C) 2015, IGG Group, ICube, University of Strasbourg, France       *
+*                                                                              *
+* This library is free software; you can redistribute it and/or modify it      *
+* under the terms of the GNU Lesser General Public License as published by the *
+* Free Software Foundation; either version 2.1 of the License, or (at your     *
+* option) any later version.                                                   *
+*                                                                              *
+* This library is distributed in the hope that it will be useful, but WITHOUT  *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+* for more details.                                                            *
+*                                                                              *
+* You should have received a copy of the GNU Lesser General Public License     *
+* along with this library; if not, write to the Free Software Foundation,      *
+* Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+*                                                                              *
+* Web site: http://cgogn.unistra.fr/                                           *
+* Contact information: cgogn@unistra.fr                                        *
+*                                                                              *
+*******************************************************************************/
+
+#ifndef CGOGN_MODELING_ALGOS_TETRAHEDRAL_OPTIMIZATION_H_
+#define CGOGN_MODELING_ALGOS_TETRAHEDRAL_OPTIMIZATION_H_
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include <cgogn/modeling/dll.h>
+#include <cgogn/modeling/algos/tetrahedralization.h>
+
+#include <cgogn/geometry/types/geometry_traits.h>
+
+#include <cgogn/core/cmap/cmap3.h>
+#include <cgogn/core/utils/claims.h>
+#include <cgogn/core/utils/thread_pool.h>
+
+namespace cgogn
+{
+
+namespace modeling
+{
+
+struct TetrahedralSwapStatistics
+{
+	uint32 nb_rounds;
+	uint32 nb_swaps_23;
+	uint32 nb_swaps_32;
+	float64 min_quality_before;
+	float64 min_quality_after;
+	float64 seconds;
+
+	TetrahedralSwapStatistics() :
+		nb_rounds(0u),
+		nb_swaps_23(0u),
+		nb_swaps_32(0u),
+		min_quality_before(0.0),
+		min_quality_after(0.0),
+		seconds(0.0)
+	{}
+
+	inline uint32 nb_swaps() const { return nb_swaps_23 + nb_swaps_32; }
+
+	inline float64 swaps_per_second() const { return seconds > 0.0 ? float64(nb_swaps()) / seconds : 0.0; }
+};
+
+namespace internal
+{
+
+/**
+ * @brief Improvement of a tetrahedral mesh by 2-3 and 3-2 swaps (Klingner & Shewchuk 2007).
+ * The quality of a tetrahedron is 6.sqrt(2).V / l_rms^3: 1 for the regular tetrahedron,
+ * negative for an inverted one. A swap is a candidate if one of its tetrahedra is below the
+ * quality target and if it increases the minimal quality of the tetrahedra it replaces.
+ * The qualities and the candidates are computed in parallel. The candidates are ranked by the
+ * quality of their worst tetrahedron and claim their tetrahedra (Claims on the volumes): the
+ * selected swaps replace disjoint sets of tetrahedra. They allocate and release darts and are
+ * applied sequentially. The volumes of the map must be tetrahedra.
+ */
+template <typename VEC3>
+class TetrahedralSwaps
+{
+public:
+
+	using Scalar = typename geometry::vector_traits<VEC3>::Scalar;
+
+	using Vertex = CMap3::Vertex;
+	using Edge = CMap3::Edge;
+	using Face = CMap3::Face;
+	using Volume = CMap3::Volume;
+
+	template <typename T>
+	using VertexAttribute = CMap3::VertexAttribute<T>;
+	template <typename T>
+	using VolumeAttribute = CMap3::VolumeAttribute<T>;
+
+	TetrahedralSwaps(CMap3& map, const VertexAttribute<VEC3>& position, Scalar quality_target) :
+		map_(map),
+		position_(position),
+		quality_target_(quality_target),
+		orientation_(Scalar(-1))
+	{
+		quality_ = map_.template add_attribute<Scalar, Volume>("__tet_quality__");
+	}
+
+	~TetrahedralSwaps()
+	{
+		map_.remove_attribute(quality_);
+	}
+
+	TetrahedralSwaps(const TetrahedralSwaps&) = delete;
+	TetrahedralSwaps& operator=(const TetrahedralSwaps&) = delete;
+
+	TetrahedralSwapStatistics run(uint32 max_rounds)
+	{
+		TetrahedralSwapStatistics stats;
+		const auto start = std::chrono::high_resolution_clock::now();
+
+		compute_orientation();
+		map_.parallel_foreach_cell([&] (Volume w, uint32) { quality_[w] = tet_quality(w.dart); });
+		stats.min_quality_before = min_quality();
+		stats.min_quality_after = stats.min_quality_before;
+
+		while (stats.nb_rounds < max_rounds && stats.min_quality_after < quality_target_)
+		{
+			gather_candidates();
+			select_independent();
+			if (selected_.empty())
+				break;
+
+			for (const Candidate& c : selected_)
+				apply(c, stats);
+			++stats.nb_rounds;
+			stats.min_quality_after = min_quality();
+		}
+
+		stats.seconds = std::chrono::duration<float64>(std::chrono::high_resolution_clock::now() - start).count();
+		return stats;
+	}
+
+private:
+
+	enum SwapType : uint32
+	{
+		SWAP_23 = 0u,	// a face shared by two tetrahedra
+		SWAP_32			// an edge shared by three tetrahedra
+	};
+
+	struct Candidate
+	{
+		uint64 rank;
+		Dart dart;
+		SwapType type;
+	};
+
+	inline const VEC3& pos(Dart d) const { return position_[Vertex(d)]; }
+
+	inline uint32 volume_index(Dart d) const { return map_.embedding(Volume(d)); }
+
+	Scalar quality(const VEC3& a, const VEC3& b, const VEC3& c, const VEC3& d) const
+	{
+		const Scalar volume = orientation_ * (b - a).cross(c - a).dot(d - a) / Scalar(6);
+		const Scalar sum = (b - a).squaredNorm() + (c - a).squaredNorm() + (d - a).squaredNorm() +
+			(c - b).squaredNorm() + (d - b).squaredNorm() + (d - c).squaredNorm();
+		if (sum <= Scalar(0))
+			return Scalar(0);
+		const Scalar l_rms = std::sqrt(sum / Scalar(6));
+		return Scalar(6) * std::sqrt(Scalar(2)) * volume / (l_rms * l_rms * l_rms);
+	}
+
+	// the tetrahedron of d: the face of d and the apex of the face of phi2(d)
+	inline Scalar tet_quality(Dart d) const
+	{
+		return quality(pos(d), pos(map_.phi1(d)), pos(map_.phi_1(d)), pos(map_.phi_1(map_.phi2(d))));
+	}
+
+	// the swaps are only valid on tetrahedra: the volume of d has 4 triangular faces
+	bool is_tetrahedron(Dart d) const
+	{
+		const std::array<Dart, 3> abc = {{ d, map_.phi1(d), map_.phi_1(d) }};
+		if (map_.phi1(abc[2]) != d)
+			return false;
+		for (Dart e : abc)
+		{
+			const Dart e2 = map_.phi2(e);
+			if (map_.phi1(map_.phi1(map_.phi1(e2))) != e2 || map_.phi2(map_.phi1(e2)) != map_.phi_1(map_.phi2(map_.phi_1(e))))
+				return false;
+		}
+		return true;
+	}
+
+	Scalar min_quality() const
+	{
+		std::vector<Scalar> thread_min(thread_pool()->nb_threads(), std::numeric_limits<Scalar>::max());
+		map_.parallel_foreach_cell([&] (Volume w, uint32 th_id)
+		{
+			thread_min[th_id] = std::min(thread_min[th_id], quality_[w]);
+		});
+		return *std::min_element(thread_min.begin(), thread_min.end());
+	}
+
+	// order preserving map of the quality to 31 bits, the lowest quality first
+	static inline uint64 priority(Scalar q)
+	{
+		const float32 f = float32(q);
+		uint32 bits;
+		std::memcpy(&bits, &f, sizeof(bits));
+		bits = (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+		return uint64(bits >> 1u);
+	}
+
+	// unique rank: the priority in the high bits, the dart and the type of swap in the low bits
+	static inline uint64 rank(Scalar q, Dart d, SwapType type)
+	{
+		return (priority(q) << 33u) | (uint64(d.index) << 1u) | uint64(type);
+	}
+
+	/**
+	 * @brief 2-3 swap of the face of d (a,b,c) shared by the tetrahedra of apexes p and q:
+	 * the edge pq is created with the tetrahedra (a,b,q,p), (b,c,q,p) and (c,a,q,p)
+	 */
+	bool evaluate_23(Dart d, Scalar& old_min) const
+	{
+		const Dart d3 = map_.phi3(d);
+		if (map_.is_boundary(d) || map_.is_boundary(d3))
+			return false;
+
+		old_min = std::min(quality_[Volume(d)], quality_[Volume(d3)]);
+		if (old_min >= quality_target_ || !is_tetrahedron(d) || !is_tetrahedron(d3))
+			return false;
+
+		const std::array<Dart, 3> abc = {{ d, map_.phi1(d), map_.phi_1(d) }};
+		const VEC3& p = pos(map_.phi_1(map_.phi2(d)));
+		const VEC3& q = pos(map_.phi_1(map_.phi2(d3)));
+		const Scalar t = threshold(old_min);
+		for (uint32 i = 0u; i < 3u; ++i)
+		{
+			if (quality(pos(abc[i]), pos(abc[(i + 1u) % 3u]), q, p) <= t)
+				return false;
+		}
+		return true;
+	}
+
+	/**
+	 * @brief 3-2 swap of the edge uv of d shared by the tetrahedra (u,v,r_i,r_i+1), r_i being
+	 * the vertex of phi_1 of the i-th dart around the edge (phi3(phi2(d))):
+	 * the face r1r2r3 is created with the tetrahedra (r1,r3,r2,u) and (r1,r2,r3,v)
+	 */
+	bool evaluate_32(Dart d, Scalar& old_min) const
+	{
+		std::array<Dart, 3> ring;
+		Dart it = d;
+		for (uint32 i = 0u; i < 3u; ++i)
+		{
+			if (map_.is_boundary(it))
+				return false;
+			ring[i] = it;
+			it = map_.phi3(map_.phi2(it));
+		}
+		if (it != d)
+			return false;
+
+		old_min = std::min({ quality_[Volume(ring[0])], quality_[Volume(ring[1])], quality_[Volume(ring[2])] });
+		if (old_min >= quality_target_ || !is_tetrahedron(ring[0]) || !is_tetrahedron(ring[1]) || !is_tetrahedron(ring[2]))
+			return false;
+
+		const VEC3& u = pos(d);
+		const VEC3& v = pos(map_.phi1(d));
+		const VEC3& r1 = pos(map_.phi_1(ring[0]));
+		const VEC3& r2 = pos(map_.phi_1(ring[1]));
+		const VEC3& r3 = pos(map_.phi_1(ring[2]));
+
+		const Scalar t = threshold(old_min);
+		return quality(r1, r3, r2, u) > t && quality(r1, r2, r3, v) > t;
+	}
+
+	// the swaps must strictly improve the quality so that the process terminates
+	// and must not create inverted tetrahedra
+	static inline Scalar threshold(Scalar old_min)
+	{
+		const Scalar epsilon = Scalar(1e-6);
+		return std::max(old_min + epsilon * std::max(Scalar(1), std::abs(old_min)), epsilon);
+	}
+
+	// the orientation of the tetrahedra depends on the source of the mesh: the sign of its total volume
+	void compute_orientation()
+	{
+		std::vector<Scalar> thread_volume(thread_pool()->nb_threads(), Scalar(0));
+		orientation_ = Scalar(-1);
+		map_.parallel_foreach_cell([&] (Volume w, uint32 th_id)
+		{
+			const Dart d = w.dart;
+			thread_volume[th_id] += (pos(map_.phi1(d)) - pos(d)).cross(pos(map_.phi_1(d)) - pos(d)).dot(pos(map_.phi_1(map_.phi2(d))) - pos(d));
+		});
+		Scalar volume = Scalar(0);
+		for (Scalar v : thread_volume)
+			volume += v;
+		if (volume > Scalar(0))
+			orientation_ = Scalar(1);
+	}
+
+	void gather_candidates()
+	{
+		std::vector<std::vector<Candidate>> thread_candidates(thread_pool()->nb_threads());
+		map_.parallel_foreach_cell([&] (Face f, uint32 th_id)
+		{
+			Scalar q;
+			if (evaluate_23(f.dart, q))
+				thread_candidates[th_id].push_back({ rank(q, f.dart, SWAP_23), f.dart, SWAP_23 });
+		});
+		map_.parallel_foreach_cell([&] (Edge e, uint32 th_id)
+		{
+			Scalar q;
+			if (evaluate_32(e.dart, q))
+				thread_candidates[th_id].push_back({ rank(q, e.dart, SWAP_32), e.dart, SWAP_32 });
+		});
+
+		candidates_.clear();
+		for (const std::vector<Candidate>& tc : thread_candidates)
+			candidates_.insert(candidates_.end(), tc.begin(), tc.end());
+	}
+
+	// calls func on the (volume indices of the) tetrahedra replaced by the swap
+	template <typename FUNC>
+	inline void foreach_swapped_volume(const Candidate& c, const FUNC& func) const
+	{
+		if (c.type == SWAP_23)
+		{
+			func(volume_index(c.dart));
+			func(volume_index(map_.phi3(c.dart)));
+		}
+		else
+		{
+			Dart it = c.dart;
+			for (uint32 i = 0u; i < 3u; ++i, it = map_.phi3(map_.phi2(it)))
+				func(volume_index(it));
+		}
+	}
+
+	void select_independent()
+	{
+		claims_.reset(map_.const_attribute_container<Volume::ORBIT>().end());
+		const uint32 nb = uint32(candidates_.size());
+		parallel_foreach_chunk(nb, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+		{
+			for (uint32 i = first; i < last; ++i)
+				foreach_swapped_volume(candidates_[i], [&] (uint32 w) { claims_.claim(w, candidates_[i].rank); });
+		});
+
+		keep_.assign(nb, 0u);
+		parallel_foreach_chunk(nb, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+		{
+			for (uint32 i = first; i < last; ++i)
+			{
+				bool owner = true;
+				foreach_swapped_volume(candidates_[i], [&] (uint32 w) { owner = owner && claims_.owns(w, candidates_[i].rank); });
+				keep_[i] = owner;
+			}
+		});
+
+		selected_.clear();
+		for (uint32 i = 0u; i < nb; ++i)
+		{
+			if (keep_[i])
+				selected_.push_back(candidates_[i]);
+		}
+	}
+
+	// the darts of the faces of the boundary of the swapped region are kept by the swaps
+	void apply(const Candidate& c, TetrahedralSwapStatistics& stats)
+	{
+		std::array<Dart, 6> outer;
+		if (c.type == SWAP_23)
+		{
+			const Dart d3 = map_.phi3(c.dart);
+			outer = {{
+				map_.phi2(c.dart), map_.phi2(map_.phi1(c.dart)), map_.phi2(map_.phi_1(c.dart)),
+				map_.phi2(d3), map_.phi2(map_.phi1(d3)), map_.phi2(map_.phi_1(d3))
+			}};
+			swap_23(map_, Face(c.dart));
+			++stats.nb_swaps_23;
+		}
+		else
+		{
+			Dart it = c.dart;
+			for (uint32 i = 0u; i < 3u; ++i, it = map_.phi3(map_.phi2(it)))
+			{
+				outer[2u * i] = map_.phi2(map_.phi1(it));
+				outer[2u * i + 1u] = map_.phi2(map_.phi_1(it));
+			}
+			swap_32(map_, Edge(c.dart));
+			++stats.nb_swaps_32;
+		}
+
+		for (Dart d : outer)
+			quality_[Volume(d)] = tet_quality(d);
+	}
+
+	CMap3& map_;
+	const VertexAttribute<VEC3>& position_;
+	VolumeAttribute<Scalar> quality_;
+	Scalar quality_target_;
+	Scalar orientation_;
+
+	Claims claims_;
+	std::vector<Candidate> candidates_;
+	std::vector<uint8> keep_;
+	std::vector<Candidate> selected_;
+};
+
+} // namespace internal
+
+/**
+ * @brief improves the quality of a tetrahedral mesh by 2-3 and 3-2 swaps
+ * @param map the tetrahedral mesh
+ * @param position the vertex positions
+ * @param quality_target the swaps improve the tetrahedra of quality (6.sqrt(2).V / l_rms^3) lower than this target
+ * @param max_rounds the maximal number of rounds of independent swaps
+ * @return the number of swaps, the minimal quality before and after and the duration
+ */
+template <typename VEC3>
+TetrahedralSwapStatistics tetrahedral_swaps(
+	CMap3& map,
+	const typename CMap3::template VertexAttribute<VEC3>& position,
+	float64 quality_target = 0.5,
+	uint32 max_rounds = 100u
+)
+{
+	using Scalar = typename geometry::vector_traits<VEC3>::Scalar;
+	internal::TetrahedralSwaps<VEC3> swaps(map, position, Scalar(quality_target));
+	return swaps.run(max_rounds);
+}
+
+#if defined(CGOGN_USE_EXTERNAL_TEMPLATES) && (!defined(CGOGN_MODELING_ALGOS_TETRAHEDRAL_OPTIMIZATION_CPP_))
+extern template CGOGN_MODELING_API TetrahedralSwapStatistics tetrahedral_swaps<Eigen::Vector3f>(CMap3&, const CMap3::VertexAttribute<Eigen::Vector3f>&, float64, uint32);
+extern template CGOGN_MODELING_API TetrahedralSwapStatistics tetrahedral_swaps<Eigen::Vector3d>(CMap3&, const CMap3::VertexAttribute<Eigen::Vector3d>&, float64, uint32);
+#endif // defined(CGOGN_USE_EXTERNAL_TEMPLATES) && (!defined(CGOGN_MODELING_ALGOS_TETRAHEDRAL_OPTIMIZATION_CPP_))
+
+} // namespace modeling
+
+} // namespace cgogn
+
+#endif // CGOGN_MODELING_ALGOS_TETRAHEDRAL_OPTIMIZATION_H_
@@ -29,5 +29,12 @@ int main(int argc, char** argv)
 	cgogn::io::import_surface<Vec3>(map, surface_mesh);
 
 	VertexAttribute<Vec3> vertex_position = map.get_attribute<Vec3, Vertex>("position");
-	cgogn::modeling::pliant_remeshing<Vec3>(map, vertex_position);
+
+	cgogn::modeling::PliantRemeshingParameters params;
+	params.preserve_features = true;
+	params.pass_hook = [] (const std::string& pass, cgogn::uint32 iteration, cgogn::uint32 nb_operations, cgogn::float64 seconds)
+	{
+		cgogn_log_info("remeshing") << "iteration " << iteration << " " << pass << ": " << nb_operations << " operations in " << seconds << "s";
+	};
+	cgogn::modeling::pliant_remeshing<Vec3>(map, vertex_position, params);
 }
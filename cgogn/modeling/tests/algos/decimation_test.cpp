@@ -0,0 +1,77 @@
+/*******************************************************************************
+* CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+* Copyright (C) 2015, IGG Group, ICube, University of Strasbourg, France       *
+*                                                                              *
+* This library is free software; you can redistribute it and/or modify it      *
+* under the terms of the GNU Lesser General Public License as published by the *
+* Free Software Foundation; either version 2.1 of the License, or (at your     *
+* option) any later version.                                                   *
+*                                                                              *
+* This library is distributed in the hope that it will be useful, but WITHOUT  *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+* for more details.                                                            *
+*                                                                              *
+* You should have received a copy of the GNU Lesser General Public License     *
+* along with this library; if not, write to the Free Software Foundation,      *
+* Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+*                                                                              *
+* Web site: http://cgogn.unistra.fr/                                           *
+* Contact information: cgogn@unistra.fr                                        *
+*                                                                              *
+*******************************************************************************/
+
+#include <cgogn/core/cmap/cmap2.h>
+#include <cgogn/io/map_import.h>
+#include <cgogn/modeling/algos/decimation.h>
+
+#include <gtest/gtest.h>
+
+#define DEFAULT_MESH_PATH CGOGN_STR(CGOGN_TEST_MESHES_PATH)
+
+using namespace cgogn::numerics;
+
+using CMap2 = cgogn::CMap2;
+template <typename T>
+using VertexAttribute = CMap2::VertexAttribute<T>;
+using Vertex = CMap2::Vertex;
+using Face = CMap2::Face;
+using Vec3 = Eigen::Vector3d;
+
+class DecimationTest : public testing::Test
+{
+protected:
+
+	CMap2 map2_;
+	VertexAttribute<Vec3> vertex_position_;
+
+	void SetUp() override
+	{
+		cgogn::io::import_surface<Vec3>(map2_, std::string(DEFAULT_MESH_PATH) + std::string("off/aneurysm_3D.off"));
+		vertex_position_ = map2_.get_attribute<Vec3, Vertex>("position");
+	}
+
+	void check_decimation(cgogn::modeling::DecimationSchedule schedule)
+	{
+		const uint32 nb_faces = map2_.nb_cells<Face::ORBIT>();
+		const uint32 target = 2000u + (nb_faces % 2u);
+
+		EXPECT_EQ(nb_faces - target, cgogn::modeling::qem_decimation<Vec3>(map2_, vertex_position_, target, schedule));
+		EXPECT_EQ(target, map2_.nb_cells<Face::ORBIT>());
+		EXPECT_TRUE(map2_.check_map_integrity());
+
+		bool triangles = true;
+		map2_.foreach_cell([&] (Face f) { triangles = triangles && map2_.codegree(f) == 3u; });
+		EXPECT_TRUE(triangles);
+	}
+};
+
+TEST_F(DecimationTest, QEMGreedy)
+{
+	check_decimation(cgogn::modeling::DECIMATION_GREEDY);
+}
+
+TEST_F(DecimationTest, QEMIndependentSets)
+{
+	check_decimation(cgogn::modeling::DECIMATION_INDEPENDENT_SETS);
+}
@@ -0,0 +1,59 @@
+/*******************************************************************************
+* CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+* Copyright (C) 2015, IGG Group, ICube, University of Strasbourg, France       *
+*                                                                              *
+* This library is free software; you can redistribute it and/or modify it      *
+* under the terms of the GNU Lesser General Public License as published by the *
+* Free Software Foundation; either version 2.1 of the License, or (at your     *
+* option) any later version.                                                   *
+*                                                                              *
+* This library is distributed in the hope that it will be useful, but WITHOUT  *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+* for more details.                                                            *
+*                                                                              *
+* You should have received a copy of the GNU Lesser General Public License     *
+* along with this library; if not, write to the Free Software Foundation,      *
+* Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+*                                                                              *
+* Web site: http://cgogn.unistra.fr/                                           *
+* Contact information: cgogn@unistra.fr                                        *
+*                                                                              *
+*******************************************************************************/
+
+#include <cgogn/core/cmap/cmap3.h>
+#include <cgogn/io/map_import.h>
+#include <cgogn/modeling/algos/tetrahedral_optimization.h>
+
+#include <gtest/gtest.h>
+
+#define DEFAULT_MESH_PATH CGOGN_STR(CGOGN_TEST_MESHES_PATH)
+
+using namespace cgogn::numerics;
+
+using CMap3 = cgogn::CMap3;
+template <typename T>
+using VertexAttribute = CMap3::VertexAttribute<T>;
+using Vertex = CMap3::Vertex;
+using Face = CMap3::Face;
+using Volume = CMap3::Volume;
+using Vec3 = Eigen::Vector3d;
+
+TEST(TetrahedralOptimizationTest, Swaps)
+{
+	CMap3 map3;
+	cgogn::io::import_volume<Vec3>(map3, std::string(DEFAULT_MESH_PATH) + std::string("tet/hand.tet"));
+	VertexAttribute<Vec3> vertex_position = map3.get_attribute<Vec3, Vertex>("position");
+
+	const uint32 nb_volumes = map3.nb_cells<Volume::ORBIT>();
+	const cgogn::modeling::TetrahedralSwapStatistics stats = cgogn::modeling::tetrahedral_swaps<Vec3>(map3, vertex_position, 0.3);
+
+	EXPECT_GT(stats.nb_swaps(), 0u);
+	EXPECT_GT(stats.min_quality_after, stats.min_quality_before);
+	EXPECT_EQ(nb_volumes + stats.nb_swaps_23 - stats.nb_swaps_32, map3.nb_cells<Volume::ORBIT>());
+	EXPECT_TRUE(map3.check_map_integrity());
+
+	bool tetrahedra = true;
+	map3.foreach_cell([&] (Volume w) { tetrahedra = tetrahedra && map3.codegree(w) == 4u; });
+	EXPECT_TRUE(tetrahedra);
+}
@@ -40,16 +40,19 @@ public:
 	using ChunkArrayContainer =  typename Inherit::template ChunkArrayContainer<T>;
 	template <typename T>
 	using ChunkArray =  typename Inherit::template ChunkArray<T>;
+	template <uint32 BITS>
+	using ChunkArrayPacked = typename Inherit::template ChunkArrayPacked<BITS>;
 
 protected:
 
-	ChunkArray<uint32>* edge_id_;
+	// the edge ids are stored on 4 bits
+	ChunkArrayPacked<4>* edge_id_;
 
 public:
 
 	CPH2(ChunkArrayContainer<unsigned char>& topology) : Inherit(topology)
 	{
-		edge_id_ = topology.template add_chunk_array<uint32>("edgeId");
+		edge_id_ = topology.template add_packed_chunk_array<4>("edgeId");
 	}
 
 	CGOGN_NOT_COPYABLE_NOR_MOVABLE(CPH2);
@@ -68,7 +71,7 @@ public:
 
 	inline void set_edge_id(Dart d, uint32 i)
 	{
-		(*edge_id_)[d.index] = i ;
+		edge_id_->set_value(d.index, i) ;
 	}
 
 	uint32 get_tri_refinement_edge_id(Dart d, Dart e) const;
@@ -40,16 +40,19 @@ public:
 	using ChunkArray =  typename Inherit::template ChunkArray<T>;
 	template <typename T>
 	using ChunkArrayContainer =  typename Inherit::template ChunkArrayContainer<T>;
+	template <uint32 BITS>
+	using ChunkArrayPacked = typename Inherit::template ChunkArrayPacked<BITS>;
 
 protected:
 
-	ChunkArray<uint32>* face_id_;
+	// the face ids are stored on 4 bits
+	ChunkArrayPacked<4>* face_id_;
 
 public:
 
 	CPH3(ChunkArrayContainer<unsigned char>& topology) : Inherit(topology)
 	{
-		face_id_ = topology.template add_chunk_array<uint32>("faceId");
+		face_id_ = topology.template add_packed_chunk_array<4>("faceId");
 	}
 
 	CGOGN_NOT_COPYABLE_NOR_MOVABLE(CPH3);
@@ -68,7 +71,7 @@ public:
 
 	inline void set_face_id(Dart d, uint32 i)
 	{
-		(*face_id_)[d.index] = i ;
+		face_id_->set_value(d.index, i) ;
 	}
 
 	inline uint32 get_tri_refinement_face_id(Dart /*d*/, Dart /*e*/) const
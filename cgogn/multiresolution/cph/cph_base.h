@@ -44,6 +44,11 @@ public:
 	using ChunkArrayContainer = cgogn::ChunkArrayContainer<CGOGN_CHUNK_SIZE, T_REF>;
 	template <typename T>
 	using ChunkArray = cgogn::ChunkArray<CGOGN_CHUNK_SIZE, T>;
+	template <uint32 BITS>
+	using ChunkArrayPacked = cgogn::ChunkArrayPacked<CGOGN_CHUNK_SIZE, BITS>;
+
+	// the levels are stored on 8 bits
+	static const uint32 MAXIMUM_LEVEL = ChunkArrayPacked<8>::MAX_VALUE;
 
 protected:
 
@@ -58,7 +63,7 @@ protected:
 	 */
 	std::vector<uint32> nb_darts_per_level_;
 
-	ChunkArray<uint32>* dart_level_;
+	ChunkArrayPacked<8>* dart_level_;
 
 public:
 
@@ -68,7 +73,7 @@ public:
 	{
 		nb_darts_per_level_.reserve(32u);
 		nb_darts_per_level_.push_back(0);
-		dart_level_ = topology.template add_chunk_array<uint32>("dartLevel") ;
+		dart_level_ = topology.template add_packed_chunk_array<8>("dartLevel") ;
 	}
 
 	CGOGN_NOT_COPYABLE_NOR_MOVABLE(CPHBase);
@@ -110,11 +115,12 @@ public:
 
 	inline void set_dart_level(Dart d, uint32 l)
 	{
-		(*dart_level_)[d.index] = l ;
+		dart_level_->set_value(d.index, l) ;
 	}
 
 	inline void inc_current_level()
 	{
+		cgogn_message_assert(current_level_ < MAXIMUM_LEVEL, "inc_current_level : maximum number of levels reached");
 		current_level_++;
 
 		while (nb_darts_per_level_.size() < current_level_+1u)
@@ -141,6 +147,8 @@ public:
 
 	inline void inc_nb_darts()
 	{
+		if (nb_darts_per_level_.size() <= current_level_)
+			nb_darts_per_level_.resize(current_level_ + 1u, 0u);
 		nb_darts_per_level_[current_level_]++;
 	}
 };
@@ -24,6 +24,10 @@
 #ifndef CGOGN_MULTIRESOLUTION_CPH_IHCMAP2_H_
 #define CGOGN_MULTIRESOLUTION_CPH_IHCMAP2_H_
 
+#include <algorithm>
+#include <limits>
+#include <vector>
+
 #include <cgogn/core/cmap/cmap2.h>
 #include <cgogn/multiresolution/cph/cph2.h>
 
@@ -75,8 +79,30 @@ public:
 
 protected:
 
+	/**
+	 * \brief Navigation cache entry: phi1, phi_1 and phi2 of a dart at the level of the stamp.
+	 */
+	struct NavigationCacheEntry
+	{
+		Dart phi1_;
+		Dart phi_1_;
+		Dart phi2_;
+		uint32 stamp_;
+	};
+
+	// the stamps of the entries: the generation of the cache in the high bits, the level in the low bits
+	static const uint32 NAVIGATION_LEVEL_BITS = 8u;
+	static const uint32 NAVIGATION_MAX_GENERATION = std::numeric_limits<uint32>::max() >> NAVIGATION_LEVEL_BITS;
+
+	mutable std::vector<NavigationCacheEntry> navigation_cache_;
+	std::size_t navigation_cache_capacity_;
+	uint32 navigation_generation_;
+
 	inline void init()
-	{}
+	{
+		navigation_cache_capacity_ = 0u;
+		navigation_generation_ = 1u;
+	}
 
 public:
 
@@ -103,23 +129,142 @@ protected:
 	inline void init_dart(Dart d)
 	{
 		Inherit_CMAP::init_dart(d);
+		init_dart_level(d);
+	}
 
+	/**
+	* \brief Add the dart d to the current level of resolution
+	*/
+	inline void init_dart_level(Dart d)
+	{
 		Inherit_CPH::inc_nb_darts();
 		Inherit_CPH::set_edge_id(d, 0);
 		Inherit_CPH::set_dart_level(d, Inherit_CPH::get_current_level());
+		invalidate_navigation_cache();
+
+		// update max level if needed
+		if (Inherit_CPH::get_current_level() > Inherit_CPH::get_maximum_level())
+			Inherit_CPH::set_maximum_level(Inherit_CPH::get_current_level());
+	}
+
+	/*
+	 * The topological operations used by the refinements invalidate the navigation cache.
+	 * The darts they insert are initialized by the concrete map (CMap2): their level and
+	 * edge id are set here (the inserted darts are adjacent to the given ones in the flat map).
+	 */
+
+	inline Dart cut_edge_topo(Dart d)
+	{
+		const Dart nd = Inherit_CMAP::cut_edge_topo(d);
+		init_dart_level(nd);
+		init_dart_level(Inherit_CMAP::phi2(d));
+		return nd;
+	}
+
+	inline Dart cut_face_topo(Dart d, Dart e)
+	{
+		const Dart nd = Inherit_CMAP::cut_face_topo(d, e);
+		init_dart_level(nd);
+		init_dart_level(Inherit_CMAP::phi2(nd));
+		return nd;
+	}
+
+	inline void merge_adjacent_edges_topo(Dart d)
+	{
+		Inherit_CMAP::merge_adjacent_edges_topo(d);
+		invalidate_navigation_cache();
+	}
+
+	inline bool merge_incident_faces_topo(Dart d)
+	{
+		const bool merged = Inherit_CMAP::merge_incident_faces_topo(d);
+		invalidate_navigation_cache();
+		return merged;
 	}
 
 	/*******************************************************************************
-	 * Basic topological operations
+	 * Navigation cache
 	 *******************************************************************************/
 
 public:
 
-	inline Dart phi1(Dart d) const
+	/**
+	 * \brief Set the memory budget of the navigation cache (0 disables the cache).
+	 * When enabled, phi1, phi_1 and phi2 of the darts are memoised for the current level
+	 * the first time they are computed. The darts whose index does not fit in the budget
+	 * are not cached. As the cache is filled by const accesses, the navigation of the map
+	 * must not be shared by concurrent threads when the cache is enabled.
+	 */
+	inline void set_navigation_cache_budget(std::size_t bytes)
 	{
-		cgogn_message_assert(Inherit_CPH::get_dart_level(d) <= Inherit_CPH::get_current_level(),
-							 "Access to a dart introduced after current level") ;
+		navigation_cache_capacity_ = bytes / sizeof(NavigationCacheEntry);
+		std::vector<NavigationCacheEntry>().swap(navigation_cache_);
+		navigation_generation_ = 1u;
+	}
+
+	inline std::size_t navigation_cache_memory() const
+	{
+		return navigation_cache_.capacity() * sizeof(NavigationCacheEntry);
+	}
+
+	/**
+	 * \brief Invalidate the navigation cache after a modification of the hierarchy
+	 * (topology, dart levels or edge ids). The change of level does not need it:
+	 * an entry is only valid for the level it was computed at.
+	 */
+	inline void invalidate_navigation_cache()
+	{
+		if (++navigation_generation_ == NAVIGATION_MAX_GENERATION)
+		{
+			for (NavigationCacheEntry& e : navigation_cache_)
+				e.stamp_ = 0u;
+			navigation_generation_ = 1u;
+		}
+	}
+
+	inline void set_dart_level(Dart d, uint32 l)
+	{
+		Inherit_CPH::set_dart_level(d, l);
+		invalidate_navigation_cache();
+	}
+
+	inline void set_edge_id(Dart d, uint32 i)
+	{
+		Inherit_CPH::set_edge_id(d, i);
+		invalidate_navigation_cache();
+	}
+
+protected:
+
+	/**
+	 * \brief Return the cache entry of d at the current level (computed if needed)
+	 * or nullptr if d is not cached.
+	 */
+	inline const NavigationCacheEntry* navigation_cache_entry(Dart d) const
+	{
+		const uint32 level = Inherit_CPH::get_current_level();
+		if (d.index >= navigation_cache_capacity_ || level >= (1u << NAVIGATION_LEVEL_BITS))
+			return nullptr;
+
+		if (d.index >= navigation_cache_.size())
+			navigation_cache_.resize(std::min(navigation_cache_capacity_, std::size_t(this->topology_.end())), NavigationCacheEntry{ Dart(), Dart(), Dart(), 0u });
+
+		NavigationCacheEntry& e = navigation_cache_[d.index];
+		const uint32 stamp = (navigation_generation_ << NAVIGATION_LEVEL_BITS) | level;
+		if (e.stamp_ != stamp)
+		{
+			e.phi1_ = level_phi1(d);
+			e.phi_1_ = level_phi_1(d);
+			e.phi2_ = level_phi2(d, e.phi1_);
+			e.stamp_ = stamp;
+		}
+		return &e;
+	}
 
+	// navigation at the current level through the darts of the finer levels
+
+	inline Dart level_phi1(Dart d) const
+	{
 		bool finished = false ;
 		uint32 edge_id = Inherit_CPH::get_edge_id(d) ;
 		Dart it = d ;
@@ -137,10 +282,8 @@ public:
 		return it ;
 	}
 
-	inline Dart phi_1(Dart d) const
+	inline Dart level_phi_1(Dart d) const
 	{
-		cgogn_message_assert(Inherit_CPH::get_dart_level(d) <= Inherit_CPH::get_current_level(), "Access to a dart introduced after current level") ;
-
 		bool finished = false ;
 		Dart it = Inherit_CMAP::phi_1(d) ;
 		uint32 edge_id = Inherit_CPH::get_edge_id(d) ;
@@ -158,6 +301,37 @@ public:
 		return it ;
 	}
 
+	// d1 is phi1(d) at the current level
+	inline Dart level_phi2(Dart d, Dart d1) const
+	{
+		if(Inherit_CMAP::phi2(d) == d)
+			return d;
+		return Inherit_CMAP::phi2(Inherit_CMAP::phi_1(d1));
+	}
+
+	/*******************************************************************************
+	 * Basic topological operations
+	 *******************************************************************************/
+
+public:
+
+	inline Dart phi1(Dart d) const
+	{
+		cgogn_message_assert(Inherit_CPH::get_dart_level(d) <= Inherit_CPH::get_current_level(),
+							 "Access to a dart introduced after current level") ;
+
+		const NavigationCacheEntry* e = navigation_cache_entry(d);
+		return e ? e->phi1_ : level_phi1(d);
+	}
+
+	inline Dart phi_1(Dart d) const
+	{
+		cgogn_message_assert(Inherit_CPH::get_dart_level(d) <= Inherit_CPH::get_current_level(), "Access to a dart introduced after current level") ;
+
+		const NavigationCacheEntry* e = navigation_cache_entry(d);
+		return e ? e->phi_1_ : level_phi_1(d);
+	}
+
 	/**
 	 * \brief phi2
 	 * @param d
@@ -167,9 +341,8 @@ public:
 	{
 		cgogn_message_assert(Inherit_CPH::get_dart_level(d) <= Inherit_CPH::get_current_level(), "Access to a dart introduced after current level") ;
 
-		if(Inherit_CMAP::phi2(d) == d)
-			return d;
-		return Inherit_CMAP::phi2(Inherit_CMAP::phi_1(phi1(d)));
+		const NavigationCacheEntry* e = navigation_cache_entry(d);
+		return e ? e->phi2_ : level_phi2(d, level_phi1(d));
 	}
 
 	/*******************************************************************************
@@ -209,6 +382,13 @@ public:
 	Face add_face(uint32 size)
 	{
 		Face f(this->add_face_topo(size));
+		Dart it = f.dart;
+		do
+		{
+			init_dart_level(it);
+			init_dart_level(Inherit_CMAP::phi2(it));
+			it = Inherit_CMAP::phi1(it);
+		} while (it != f.dart);
 
 		if (this->template is_embedded<CDart>())
 			foreach_dart_of_orbit(f, [this] (Dart d)
@@ -24,6 +24,10 @@
 #ifndef CGOGN_MULTIRESOLUTION_CPH_IHCMAP2_ADAPTIVE_H_
 #define CGOGN_MULTIRESOLUTION_CPH_IHCMAP2_ADAPTIVE_H_
 
+#include <algorithm>
+#include <vector>
+
+#include <cgogn/core/utils/thread_pool.h>
 #include <cgogn/multiresolution/cph/ihcmap2.h>
 
 namespace cgogn
@@ -127,11 +131,13 @@ public:
 		uint32 nbSubd = 0;
 		it = old;
 		uint32 eId = Inherit::get_edge_id(old);
+		// the pieces of the subdivided edge of old have the same id and are younger than old
+		// (the edge ids alone do not separate the edges of the central faces of triangles)
 		do
 		{
 			++nbSubd;
 			it = Inherit::phi1(it);
-		} while(Inherit::get_edge_id(it) == eId);
+		} while(Inherit::get_edge_id(it) == eId && Inherit::get_dart_level(it) > l_old);
 
 		while(nbSubd > 1)
 		{
@@ -260,7 +266,7 @@ public:
 							 "Access to a dart introduced after current level");
 
 		uint32 fLevel = face_level(d) ;
-		if(fLevel <= Inherit::get_current_level())
+		if(fLevel < Inherit::get_current_level())
 			return false ;
 
 		bool subd = false ;
@@ -489,7 +495,7 @@ public:
 			Inherit::set_edge_id(ne, id);
 			Inherit::set_edge_id(Inherit::phi2(ne), id);			// set the edge id of the inserted
 
-			id = Inherit::get_quad_refinement_edge_id(Inherit::phi1(ne2));
+			id = Inherit::get_quad_refinement_edge_id(Inherit::phi1(Inherit::phi2(ne2)));
 			Inherit::set_edge_id(ne2, id);					// edges to the next available ids
 			Inherit::set_edge_id(Inherit::phi2(ne2), id);
 
@@ -568,6 +574,138 @@ public:
 			fit = Inherit::phi1(fit);
 		} while(fit != d);
 	}
+
+	/***************************************************
+	 *               ADAPTIVE REFINEMENT               *
+	 ***************************************************/
+
+	/**
+	 * \brief Subdivide the faces of the given darts in the current level map
+	 * and the faces needed to keep at most one level of difference between neighboring faces
+	 * \details The closure is computed once, from the finest faces to the coarsest ones,
+	 * then the faces are subdivided level by level, from the coarsest to the finest.
+	 * The faces that are already subdivided and the boundary faces are ignored.
+	 * The current level is left unchanged.
+	 * \return the number of subdivided faces
+	 */
+	uint32 refine_faces(const std::vector<Dart>& faces, bool triQuad = true)
+	{
+		const uint32 cur = Inherit::get_current_level();
+
+		// the faces to subdivide of each level, given by their dart of smallest index at this level
+		std::vector<std::vector<Dart>> level_faces;
+		auto add_level_face = [&] (Dart d, uint32 l)
+		{
+			// the oldest dart of the face exists at the level of the face
+			const Dart old = face_oldest_dart(d);
+			Inherit::set_current_level(l);
+			if (level_faces.size() <= l)
+				level_faces.resize(l + 1u);
+			level_faces[l].push_back(face_min_dart(old));
+		};
+
+		for (Dart d : faces)
+		{
+			cgogn_message_assert(Inherit::get_dart_level(d) <= cur, "refine_faces : called with a dart inserted after current level");
+			if (this->is_boundary(d))
+				continue;
+			const uint32 fLevel = face_level(d);
+			if (fLevel == cur && face_is_subdivided(d))
+				continue;
+			add_level_face(d, fLevel);
+			Inherit::set_current_level(cur);
+		}
+
+		// closure: the neighbors of a face of level l that are of level l-1 are subdivided first
+		for (uint32 l = uint32(level_faces.size()); l-- > 0u; )
+		{
+			std::vector<Dart>& lf = level_faces[l];
+			std::sort(lf.begin(), lf.end(), [] (Dart a, Dart b) { return a.index < b.index; });
+			lf.erase(std::unique(lf.begin(), lf.end()), lf.end());
+			if (l == 0u)
+				break;
+
+			for (std::size_t i = 0u; i < lf.size(); ++i)
+			{
+				Inherit::set_current_level(l);
+				const Dart f = level_faces[l][i];
+				Dart it = f;
+				do
+				{
+					const Dart nf = Inherit::phi2(it);
+					if (!this->is_boundary(nf) && face_level(nf) == l - 1u)
+					{
+						add_level_face(nf, l - 1u);
+						Inherit::set_current_level(l);
+					}
+					it = Inherit::phi1(it);
+				} while (it != f);
+			}
+		}
+
+		Inherit::set_current_level(cur);
+
+		uint32 nb_subdivided = 0u;
+		for (const std::vector<Dart>& lf : level_faces)
+		{
+			for (Dart d : lf)
+				subdivide_face(d, triQuad, false);
+			nb_subdivided += uint32(lf.size());
+		}
+
+		return nb_subdivided;
+	}
+
+	/**
+	 * \brief Subdivide the faces of the current level map that satisfy the given predicate
+	 * (and the faces needed to keep at most one level of difference between neighboring faces)
+	 * \details The predicate (bool(Face)) is evaluated in parallel on the faces of the current
+	 * level map: it must not change the current level nor use the navigation cache.
+	 * \return the number of subdivided faces
+	 */
+	template <typename FUNC>
+	uint32 refine_faces_if(const FUNC& predicate, bool triQuad = true)
+	{
+		static_assert(is_func_parameter_same<FUNC, Face>::value, "Wrong function cell parameter type");
+		static_assert(is_func_return_same<FUNC, bool>::value, "Wrong function return type");
+
+		const uint32 cur = Inherit::get_current_level();
+		const uint32 nb_threads = uint32(thread_pool()->nb_threads());
+
+		// the faces of the current level map are represented by their dart of smallest index
+		std::vector<std::vector<Dart>> thread_faces(nb_threads);
+		this->parallel_foreach_dart([&] (Dart d, uint32 th_id)
+		{
+			if (Inherit::get_dart_level(d) > cur || this->is_boundary(d))
+				return;
+			if (face_min_dart(d) == d && predicate(Face(d)))
+				thread_faces[th_id].push_back(d);
+		});
+
+		std::vector<Dart> faces;
+		for (const std::vector<Dart>& tf : thread_faces)
+			faces.insert(faces.end(), tf.begin(), tf.end());
+
+		return refine_faces(faces, triQuad);
+	}
+
+protected:
+
+	/**
+	 * Return the dart of smallest index of the face of d in the current level map
+	 */
+	Dart face_min_dart(Dart d) const
+	{
+		Dart min = d;
+		Dart it = Inherit::phi1(d);
+		while (it != d)
+		{
+			if (it.index < min.index)
+				min = it;
+			it = Inherit::phi1(it);
+		}
+		return min;
+	}
 };
 
 struct IHCMap2AdaptiveType
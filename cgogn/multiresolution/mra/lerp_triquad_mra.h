@@ -25,10 +25,19 @@
 #define MULTIRESOLUTION_MRA_LERP_TRI_QUAD_MRANALYSIS_H_
 
 #include <cgogn/core/basic/dart.h>
+#include <cgogn/core/utils/thread_pool.h>
+#include <cgogn/geometry/types/geometry_traits.h>
 #include <cgogn/multiresolution/mra/mr_analysis.h>
 
 namespace cgogn {
 
+/**
+ * \brief Linear (Lerp) multiresolution analysis of the mixed triangle/quad subdivision:
+ * the details of the new edge vertices are relative to the midpoints of the edges and the
+ * details of the new face vertices (non triangular faces) to the centroids of the faces.
+ * The filters of a level use a cache of the darts they access at this level and the next one
+ * so that they run in parallel without changing the level of the map.
+ */
 template <typename MRMAP, typename VEC3>
 class LerpTriQuadMRAnalysis : public MRAnalysis<MRMAP>
 {
@@ -38,16 +47,30 @@ public:
 	typedef MRAnalysis<MRMAP> Inherit;
 
 	using VertexAttributeHandler = typename MRMAP::template VertexAttribute<VEC3>;
+	using Scalar = typename geometry::vector_traits<VEC3>::Scalar;
 
 protected:
 	VertexAttributeHandler& va_;
 
+	struct LevelCache
+	{
+		// 3 darts per edge: its two vertices at the level and its midpoint at the next level
+		std::vector<Dart> edge_darts_;
+		// the darts of the non triangular face f are face_darts_[face_begin_[f], face_begin_[f+1]):
+		// its center at the next level then its vertices at the level and their next edge midpoint
+		std::vector<uint32> face_begin_;
+		std::vector<Dart> face_darts_;
+	};
+
+	std::vector<LevelCache> caches_;
+
 public:
 	LerpTriQuadMRAnalysis(MRMAP& map, VertexAttributeHandler& v):
 		Inherit(map),
 		va_(v)
 	{
 		this->synthesis_filters_.push_back(lerp_tri_quad_odd_synthesis_);
+		this->analysis_filters_.push_back(lerp_tri_quad_odd_analysis_);
 	}
 
 	LerpTriQuadMRAnalysis(Self const& ) = delete;
@@ -60,47 +83,173 @@ public:
 
 protected:
 
+	/**
+	 * @brief the cache of the current level (built on first use)
+	 */
+	const LevelCache& level_cache()
+	{
+		const uint32 level = this->map_.get_current_level();
+		if (caches_.size() <= level)
+			caches_.resize(level + 1u);
+		LevelCache& cache = caches_[level];
+		if (cache.face_begin_.empty())
+			build_level_cache(cache);
+		return cache;
+	}
+
+	void build_level_cache(LevelCache& cache)
+	{
+		MRMAP& map = this->map_;
+		const uint32 level = map.get_current_level();
+		const uint32 nb_threads = uint32(thread_pool()->nb_threads());
+
+		// the darts of the level: the cell traversals of the map do not depend on the level,
+		// the edges and faces of the level are represented by their dart of smallest index
+		std::vector<std::vector<Dart>> thread_edges(nb_threads);
+		std::vector<std::vector<Dart>> thread_faces(nb_threads);
+		std::vector<std::vector<uint32>> thread_degrees(nb_threads);
+		map.parallel_foreach_dart([&] (Dart d, uint32 th_id)
+		{
+			if (map.get_dart_level(d) > level)
+				return;
+
+			const Dart d2 = map.phi2(d);
+			if (d2 == d || d.index < d2.index)
+			{
+				thread_edges[th_id].push_back(d);
+				thread_edges[th_id].push_back(map.phi1(d));
+				thread_edges[th_id].push_back(Dart());
+			}
+
+			if (map.is_boundary(d))
+				return;
+			std::vector<Dart>& darts = thread_faces[th_id];
+			const std::size_t first = darts.size();
+			Dart it = d;
+			do
+			{
+				if (it.index < d.index)
+				{
+					darts.resize(first);
+					return;
+				}
+				darts.push_back(it);
+				it = map.phi1(it);
+			} while (it != d);
+			const uint32 degree = uint32(darts.size() - first);
+			if (degree == 3u)
+				darts.resize(first);
+			else
+				thread_degrees[th_id].push_back(degree);
+		});
+
+		cache.edge_darts_.clear();
+		for (const std::vector<Dart>& darts : thread_edges)
+			cache.edge_darts_.insert(cache.edge_darts_.end(), darts.begin(), darts.end());
+
+		cache.face_begin_.assign(1u, 0u);
+		cache.face_darts_.clear();
+		for (uint32 t = 0u; t < nb_threads; ++t)
+		{
+			uint32 corner = 0u;
+			for (uint32 degree : thread_degrees[t])
+			{
+				cache.face_darts_.push_back(Dart());
+				for (uint32 i = 0u; i < degree; ++i)
+				{
+					cache.face_darts_.push_back(thread_faces[t][corner++]);
+					cache.face_darts_.push_back(Dart());
+				}
+				cache.face_begin_.push_back(uint32(cache.face_darts_.size()));
+			}
+		}
+
+		// the new vertices at the next level
+		map.inc_current_level();
+		const uint32 nb_edges = uint32(cache.edge_darts_.size() / 3u);
+		parallel_foreach_chunk(nb_edges, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+		{
+			for (uint32 i = first; i < last; ++i)
+				cache.edge_darts_[3u * i + 2u] = map.phi1(cache.edge_darts_[3u * i]);
+		});
+		const uint32 nb_faces = uint32(cache.face_begin_.size()) - 1u;
+		parallel_foreach_chunk(nb_faces, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+		{
+			for (uint32 f = first; f < last; ++f)
+			{
+				const uint32 begin = cache.face_begin_[f];
+				const Dart d = cache.face_darts_[begin + 1u];
+				cache.face_darts_[begin] = map.phi1(map.phi1(d));
+				for (uint32 i = begin + 1u; i < cache.face_begin_[f + 1u]; i += 2u)
+					cache.face_darts_[i + 1u] = map.phi1(cache.face_darts_[i]);
+			}
+		});
+		map.dec_current_level();
+	}
+
+	/**
+	 * @brief the centroid of the vertices of the face f and twice the mean of the details of its edges
+	 */
+	inline VEC3 face_prediction(const LevelCache& cache, uint32 f) const
+	{
+		VEC3 vf;
+		VEC3 ef;
+		geometry::set_zero(vf);
+		geometry::set_zero(ef);
+		const uint32 begin = cache.face_begin_[f];
+		const uint32 end = cache.face_begin_[f + 1u];
+		for (uint32 i = begin + 1u; i < end; i += 2u)
+		{
+			vf += va_[cache.face_darts_[i]];
+			ef += va_[cache.face_darts_[i + 1u]];
+		}
+		const Scalar count = Scalar((end - begin - 1u) / 2u);
+		return vf / count + ef * (Scalar(2) / count);
+	}
+
+	inline VEC3 edge_prediction(const LevelCache& cache, uint32 e) const
+	{
+		return (va_[cache.edge_darts_[3u * e]] + va_[cache.edge_darts_[3u * e + 1u]]) * Scalar(0.5);
+	}
+
+	// the face filters use the details of the edges: they are applied before the edge synthesis
 	std::function<void()> lerp_tri_quad_odd_synthesis_ = [this] ()
 	{
-		// this->map_.foreach_cell([&] (typename MRMAP::Face f)
-		// {
-		// 	if(this->map_.degree(f) != 3)
-		// 	{
-		// 		VEC3 vf(0.0);
-		// 		VEC3 ef(0.0);
-
-		// 		unsigned int count = 0;
-
-		// 		this->map_.foreach_incident_edge(f, [&] (typename MRMAP::Edge e)
-		// 		{
-		// 			vf += va_[e.dart];
-		// 			this->map_.inc_current_level();
-		// 			ef += va_[this->map_.phi1(e.dart)];
-		// 			this->map_.dec_current_level();
-		// 			++count;
-		// 		});
-
-		// 		ef /= count;
-		// 		ef *= 2.0;
-
-		// 		vf /= count;
-
-		// 		this->map_.inc_current_level() ;
-		// 		Dart midF = this->map_.phi1(this->map_.phi1(f.dart));
-		// 		va_[midF] += vf + ef ;
-		// 		this->map_.dec_current_level() ;
-		// 	}
-		// });
-
-		// this->map_.foreach_cell([&] (typename MRMAP::Edge e)
-		// {
-		// 	VEC3 ve = (va_[e.dart] + va_[this->map_.phi1(e)]) * 0.5;
-
-		// 	this->map_.inc_current_level() ;
-		// 	Dart midV = this->map_.phi1(e) ;
-		// 	va_[midV] += ve ;
-		// 	this->map_.dec_current_level() ;
-		// });
+		const LevelCache& cache = level_cache();
+
+		const uint32 nb_faces = uint32(cache.face_begin_.size()) - 1u;
+		parallel_foreach_chunk(nb_faces, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+		{
+			for (uint32 f = first; f < last; ++f)
+				va_[cache.face_darts_[cache.face_begin_[f]]] += face_prediction(cache, f);
+		});
+
+		const uint32 nb_edges = uint32(cache.edge_darts_.size() / 3u);
+		parallel_foreach_chunk(nb_edges, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+		{
+			for (uint32 e = first; e < last; ++e)
+				va_[cache.edge_darts_[3u * e + 2u]] += edge_prediction(cache, e);
+		});
+	};
+
+	// and after the edge analysis
+	std::function<void()> lerp_tri_quad_odd_analysis_ = [this] ()
+	{
+		const LevelCache& cache = level_cache();
+
+		const uint32 nb_edges = uint32(cache.edge_darts_.size() / 3u);
+		parallel_foreach_chunk(nb_edges, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+		{
+			for (uint32 e = first; e < last; ++e)
+				va_[cache.edge_darts_[3u * e + 2u]] -= edge_prediction(cache, e);
+		});
+
+		const uint32 nb_faces = uint32(cache.face_begin_.size()) - 1u;
+		parallel_foreach_chunk(nb_faces, PARALLEL_BUFFER_SIZE, [&] (uint32 first, uint32 last)
+		{
+			for (uint32 f = first; f < last; ++f)
+				va_[cache.face_darts_[cache.face_begin_[f]]] -= face_prediction(cache, f);
+		});
 	};
 
 public:
@@ -108,6 +257,7 @@ public:
 	void add_level() override
 	{
 		this->map_.add_mixed_level();
+		caches_.clear();
 	}
 
 };
@@ -115,4 +265,3 @@ public:
 } //namespace cgogn
 
 #endif // MULTIRESOLUTION_MRA_LERP_TRI_QUAD_MRANALYSIS_H_
-
@@ -24,6 +24,11 @@
 #ifndef MULTIRESOLUTION_MRA_MR_ANALYSIS_H_
 #define MULTIRESOLUTION_MRA_MR_ANALYSIS_H_
 
+#include <functional>
+#include <vector>
+
+#include <cgogn/core/utils/assert.h>
+
 namespace cgogn {
 
 template <typename MRMAP>
@@ -72,6 +77,34 @@ public:
 		map_.inc_current_level();
 	}
 
+	/**
+	 * @brief reconstructs the levels one after another from the current level up to the given level
+	 * @param level the finest level to reconstruct
+	 * @param on_level called with the new current level after the synthesis of each level
+	 * (e.g. to refresh the display): returning false stops the refinement
+	 */
+	template <typename FUNC>
+	void progressive_synthesis(uint32 level, const FUNC& on_level)
+	{
+		cgogn_message_assert(level <= map_.get_maximum_level(), "progressive_synthesis : level out of the hierarchy") ;
+
+		while (map_.get_current_level() < level)
+		{
+			synthesis();
+			if (!on_level(map_.get_current_level()))
+				break;
+		}
+	}
+
+	/**
+	 * @brief decomposes the levels one after another from the current level down to the given level
+	 */
+	void analysis(uint32 level)
+	{
+		while (map_.get_current_level() > level)
+			analysis();
+	}
+
 	virtual void add_level() = 0;
 };
 
@@ -0,0 +1,78 @@
+/*******************************************************************************
+* CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+* Copyright (C) 2015, IGG Group, ICube, University of Strasbourg, France       *
+*                                                                              *
+* This library is free software; you can redistribute it and/or modify it      *
+* under the terms of the GNU Lesser General Public License as published by the *
+* Free Software Foundation; either version 2.1 of the License, or (at your     *
+* option) any later version.                                                   *
+*                                                                              *
+* This library is distributed in the hope that it will be useful, but WITHOUT  *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+* for more details.                                                            *
+*                                                                              *
+* You should have received a copy of the GNU Lesser General Public License     *
+* along with this library; if not, write to the Free Software Foundation,      *
+* Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+*                                                                              *
+* Web site: http://cgogn.unistra.fr/                                           *
+* Contact information: cgogn@unistra.fr                                        *
+*                                                                              *
+*******************************************************************************/
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include <cgogn/core/utils/logger.h>
+#include <cgogn/multiresolution/mrcmap/mr_base.h>
+
+namespace cgogn
+{
+
+namespace internal
+{
+
+CGOGN_TLS uint64 mr_level_stamps_thread_[MAX_NB_MR_HIERARCHIES];
+CGOGN_TLS uint32 mr_levels_thread_[MAX_NB_MR_HIERARCHIES];
+
+namespace
+{
+
+std::mutex mr_slots_mutex;
+std::vector<bool> mr_used_slots(MAX_NB_MR_HIERARCHIES, false);
+// the stamps are never reused so that the levels left by a destroyed hierarchy are never read
+std::atomic<uint64> mr_next_stamp(1u);
+
+} // namespace
+
+CGOGN_MULTIRESOLUTION_API uint32 mr_acquire_level_slot(uint64& stamp)
+{
+	stamp = mr_next_stamp++;
+
+	std::lock_guard<std::mutex> lock(mr_slots_mutex);
+	for (uint32 i = 0u; i < MAX_NB_MR_HIERARCHIES; ++i)
+	{
+		if (!mr_used_slots[i])
+		{
+			mr_used_slots[i] = true;
+			return i;
+		}
+	}
+	cgogn_log_warning("mr_acquire_level_slot") << "More than " << MAX_NB_MR_HIERARCHIES << " hierarchies: the current level is shared by the threads.";
+	return INVALID_INDEX;
+}
+
+CGOGN_MULTIRESOLUTION_API void mr_release_level_slot(uint32 slot)
+{
+	if (slot == INVALID_INDEX)
+		return;
+
+	std::lock_guard<std::mutex> lock(mr_slots_mutex);
+	mr_used_slots[slot] = false;
+}
+
+} // namespace internal
+
+} // namespace cgogn
@@ -25,14 +25,51 @@
 #define CGOGN_MULTIRESOLUTION_MRCMAP_MR_BASE_H_
 
 #include <deque>
+#include <memory>
 #include <stack>
 #include <vector>
 
 #include <cgogn/core/utils/numerics.h>
+#include <cgogn/core/utils/definitions.h>
+#include <cgogn/core/utils/unique_ptr.h>
+#include <cgogn/core/basic/dart.h>
+
+#include <cgogn/multiresolution/dll.h>
 
 namespace cgogn
 {
 
+/**
+ * \brief The maximum number of multiresolution hierarchies with thread-local current levels.
+ * The hierarchies created beyond this number share their current level between threads.
+ */
+const uint32 MAX_NB_MR_HIERARCHIES = 64u;
+
+namespace internal
+{
+
+/// current levels of the calling thread in each hierarchy slot,
+/// valid if the stamp of the slot is the one of the hierarchy
+extern CGOGN_TLS uint64 mr_level_stamps_thread_[MAX_NB_MR_HIERARCHIES];
+extern CGOGN_TLS uint32 mr_levels_thread_[MAX_NB_MR_HIERARCHIES];
+
+/**
+ * @brief reserve a slot for the thread-local current levels of a hierarchy
+ * @param stamp the unique (non zero) stamp of the hierarchy in the slot
+ * @return the index of the slot or INVALID_INDEX if all the slots are used
+ */
+CGOGN_MULTIRESOLUTION_API uint32 mr_acquire_level_slot(uint64& stamp);
+
+CGOGN_MULTIRESOLUTION_API void mr_release_level_slot(uint32 slot);
+
+} // namespace internal
+
+/**
+ * \brief Multiresolution hierarchy of maps: each level is a copy of its neighbor level
+ * (that can then be refined or coarsened) and the darts of consecutive levels are linked
+ * by next/previous level correspondence indices. The current level is thread-local:
+ * each thread can browse a different level of the same hierarchy.
+ */
 template <typename MAP>
 class MRBase
 {
@@ -46,21 +83,21 @@ public:
 protected:
 
 	/**
-	 * pointers to maps (one for each level)
+	 * maps (one for each level)
 	 */
-	std::deque<MAP*> maps_;
+	std::deque<std::unique_ptr<MAP>> maps_;
 
 	/**
-	 * pointers to attributs that stores next level
-	 * correspondance indices for each dart
+	 * next level correspondance indices
+	 * for each dart (indexed by the dart indices)
 	 */
-	std::deque<ChunkArray<uint32>*> next_level_indices_;
+	std::deque<std::vector<uint32>> next_level_indices_;
 
 	/**
-	 * pointers to attributs that stores previous level
-	 * correspondance indices for each dart
+	 * previous level correspondance indices
+	 * for each dart (indexed by the dart indices)
 	 */
-	std::deque<ChunkArray<uint32>*> previous_level_indices_;
+	std::deque<std::vector<uint32>> previous_level_indices_;
 
 	/**
 	 * stack for current level temporary storage
@@ -68,86 +105,218 @@ protected:
 	std::stack<uint32, std::vector<uint32>> levels_stack_ ;
 
 	/**
-	 * current level in multiresolution map
+	 * slot and stamp of the thread-local current levels
 	 */
-	uint32 current_level_;
+	uint32 level_slot_;
+	uint64 level_stamp_;
+
+	/**
+	 * level of the threads that have not set their current level
+	 * (and current level of all the threads if the hierarchy has no slot)
+	 */
+	uint32 default_level_;
+
+	static inline uint32 correspondent(const std::vector<uint32>& indices, Dart d)
+	{
+		return d.index < indices.size() ? indices[d.index] : INVALID_INDEX;
+	}
+
+	static inline void set_correspondent(std::vector<uint32>& indices, Dart d, uint32 index)
+	{
+		if (d.index >= indices.size())
+			indices.resize(d.index + 1u, INVALID_INDEX);
+		indices[d.index] = index;
+	}
 
-	//TODO le niveau courant doit etre par thread
-	//appele sur la carte et non plus un champs de
-	//la classe carte
+	/**
+	 * @brief creates a copy of the map and links the darts of the map and of the copy
+	 * the darts of the copy are created in the order of the darts of the map (see MapBase::merge)
+	 */
+	inline std::unique_ptr<MAP> copy_level(const MAP& map, std::vector<uint32>& map_to_copy, std::vector<uint32>& copy_to_map)
+	{
+		std::unique_ptr<MAP> copy = make_unique<MAP>();
+		typename MAP::DartMarker new_darts(*copy);
+		copy->merge(map, new_darts);
+
+		map_to_copy.assign(map.topology_container().end(), INVALID_INDEX);
+		copy_to_map.assign(copy->topology_container().end(), INVALID_INDEX);
+		uint32 index = 0u;
+		map.foreach_dart([&] (Dart d)
+		{
+			map_to_copy[d.index] = index;
+			copy_to_map[index] = d.index;
+			++index;
+		});
+		cgogn_assert(index == copy->nb_darts());
+
+		return copy;
+	}
 
 public:
 
-	inline MRBase() {}
+	inline MRBase() :
+		default_level_(0u)
+	{
+		level_slot_ = internal::mr_acquire_level_slot(level_stamp_);
+		maps_.push_back(make_unique<MAP>());
+		next_level_indices_.push_back(std::vector<uint32>());
+		previous_level_indices_.push_back(std::vector<uint32>());
+	}
+
 	CGOGN_NOT_COPYABLE_NOR_MOVABLE(MRBase);
-	inline ~MRBase() {}
 
+	inline ~MRBase()
+	{
+		internal::mr_release_level_slot(level_slot_);
+	}
+
+	/**
+	 * \brief add a level after the finest level as a copy of the finest level
+	 */
 	inline void add_level_back()
 	{
-		//ajouter une carte par copie dans maps_
-		//ajouter un chunkarray dans next_
-		MAP* last = maps_.back();
-		maps_.push_back(last);
+		std::vector<uint32> previous;
+		std::unique_ptr<MAP> copy = copy_level(*maps_.back(), next_level_indices_.back(), previous);
+		maps_.push_back(std::move(copy));
+		next_level_indices_.push_back(std::vector<uint32>());
+		previous_level_indices_.push_back(std::move(previous));
 	}
 
 	inline void remove_level_back()
 	{
+		cgogn_message_assert(maps_.size() > 1u, "remove_level_back: the hierarchy has a single level");
+		next_level_indices_.pop_back();
+		previous_level_indices_.pop_back();
 		maps_.pop_back();
+		next_level_indices_.back().clear();
 	}
 
+	/**
+	 * \brief add a level before the coarsest level as a copy of the coarsest level
+	 * the indices of the existing levels are shifted by one
+	 */
 	inline void add_level_front()
 	{
-		MAP* first = maps_.front();
-		maps.push_front(first);
+		std::vector<uint32> next;
+		std::unique_ptr<MAP> copy = copy_level(*maps_.front(), previous_level_indices_.front(), next);
+		maps_.push_front(std::move(copy));
+		next_level_indices_.push_front(std::move(next));
+		previous_level_indices_.push_front(std::vector<uint32>());
 	}
 
 	inline void remove_level_front()
 	{
+		cgogn_message_assert(maps_.size() > 1u, "remove_level_front: the hierarchy has a single level");
+		next_level_indices_.pop_front();
+		previous_level_indices_.pop_front();
 		maps_.pop_front();
+		previous_level_indices_.front().clear();
 	}
 
-	//1 thread par niveau = 1 thread par carte
-	//n thread par niveau = n thread par carte
-
 	inline uint32 get_maximum_level() const
 	{
-		return uint32(maps_.size());
+		return uint32(maps_.size()) - 1u;
 	}
 
+	/**
+	 * \brief current level of the calling thread
+	 */
 	inline uint32 get_current_level() const
 	{
-		return current_level_;
+		if (level_slot_ != INVALID_INDEX && internal::mr_level_stamps_thread_[level_slot_] == level_stamp_)
+			return internal::mr_levels_thread_[level_slot_];
+		return default_level_;
 	}
 
+	/**
+	 * \brief set the current level of the calling thread
+	 */
 	inline void set_current_level(uint32 l)
 	{
-		current_level_ = l;
+		cgogn_message_assert(l < maps_.size(), "set_current_level: level out of the hierarchy");
+		if (level_slot_ != INVALID_INDEX)
+		{
+			internal::mr_level_stamps_thread_[level_slot_] = level_stamp_;
+			internal::mr_levels_thread_[level_slot_] = l;
+		}
+		else
+			default_level_ = l;
+	}
+
+	/**
+	 * \brief set the level of the threads that have not set their current level
+	 */
+	inline void set_default_level(uint32 l)
+	{
+		cgogn_message_assert(l < maps_.size(), "set_default_level: level out of the hierarchy");
+		default_level_ = l;
 	}
 
 	inline void inc_current_level()
 	{
-		cgogn_debug_assert(get_current_level() < maps_.size() - 1, "incCurrentLevel : already at maximum resolution level");
-		++current_level_;
+		cgogn_message_assert(get_current_level() < get_maximum_level(), "inc_current_level : already at maximum resolution level");
+		set_current_level(get_current_level() + 1u);
 	}
 
 	inline void dec_current_level()
 	{
-		cgogn_debug_assert(get_current_level() > 0, "decCurrentLevel : already at minimum resolution level");
-		--current_level_;
+		cgogn_message_assert(get_current_level() > 0u, "dec_current_level : already at minimum resolution level");
+		set_current_level(get_current_level() - 1u);
 	}
 
-	//TODO
-	inline uint32 get_dart_level(Dart d)
+	/**
+	 * \brief level of introduction of the dart d of the current level:
+	 * the coarsest level it has a correspondent in
+	 */
+	inline uint32 get_dart_level(Dart d) const
 	{
-		return 0;
+		uint32 level = get_current_level();
+		uint32 index = d.index;
+		while (level > 0u)
+		{
+			index = correspondent(previous_level_indices_[level], Dart(index));
+			if (index == INVALID_INDEX)
+				break;
+			--level;
+		}
+		return level;
+	}
+
+	/**
+	 * \brief correspondent of the dart d of the current level in the next level (or an invalid dart)
+	 */
+	inline Dart next_level_dart(Dart d) const
+	{
+		return Dart(correspondent(next_level_indices_[get_current_level()], d));
+	}
+
+	/**
+	 * \brief correspondent of the dart d of the current level in the previous level (or an invalid dart)
+	 */
+	inline Dart previous_level_dart(Dart d) const
+	{
+		return Dart(correspondent(previous_level_indices_[get_current_level()], d));
+	}
+
+	/**
+	 * \brief links the dart d of the current level to the dart e of the next level
+	 * (to be used by the refinements of the next level)
+	 */
+	inline void link_next_level_dart(Dart d, Dart e)
+	{
+		const uint32 l = get_current_level();
+		cgogn_message_assert(l < get_maximum_level(), "link_next_level_dart: no next level");
+		set_correspondent(next_level_indices_[l], d, e.index);
+		set_correspondent(previous_level_indices_[l + 1u], e, d.index);
 	}
 
 	/**
 	 * store current resolution level on a stack
+	 * (the stack is shared by the threads)
 	 */
 	inline void push_level()
 	{
-		levels_stack_.push_back(get_current_level()) ;
+		levels_stack_.push(get_current_level()) ;
 	}
 
 	/**
@@ -155,13 +324,28 @@ public:
 	 */
 	inline void pop_level()
 	{
-		set_current_level(levels_stack_.back()) ;
-		levels_stack_.pop_back() ;
+		set_current_level(levels_stack_.top()) ;
+		levels_stack_.pop() ;
+	}
+
+	inline MAP* level(uint32 l)
+	{
+		return maps_[l].get();
+	}
+
+	inline const MAP* level(uint32 l) const
+	{
+		return maps_[l].get();
+	}
+
+	inline MAP* current()
+	{
+		return maps_[get_current_level()].get();
 	}
 
 	inline const MAP* current() const
 	{
-		return maps_[get_current_level()];
+		return maps_[get_current_level()].get();
 	}
 };
 
@@ -24,6 +24,12 @@
 #ifndef CGOGN_TOPOLOGY_DISTANCE_FIELD_H_
 #define CGOGN_TOPOLOGY_DISTANCE_FIELD_H_
 
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include <cgogn/core/utils/thread_pool.h>
+
 #include <cgogn/topology/types/adjacency_cache.h>
 
 #include <cgogn/geometry/algos/centroid.h>
@@ -62,7 +68,8 @@ public:
 		map_(map),
 		cache_(cache),
 		edge_weight_(weight),
-		intern_edge_weight_(false)
+		intern_edge_weight_(false),
+		nb_lanes_(0u)
 	{
 	}
 
@@ -70,7 +77,8 @@ public:
 				  const AdjacencyCache<MAP>& cache) :
 		map_(map),
 		cache_(cache),
-		intern_edge_weight_(true)
+		intern_edge_weight_(true),
+		nb_lanes_(0u)
 	{
 		edge_weight_ = map.template add_attribute<Scalar, Edge>("__edge_weight__");
 
@@ -93,55 +101,267 @@ public:
 
 private:
 
+	// A relaxation request : a new distance of a node for one of the distance fields (lane)
+	struct Request
+	{
+		uint32 node;
+		uint32 lane;
+		Scalar distance;
+	};
+
 	/**
-	 * Compute for each vertex of the map, the shortest path to the sources
-	 * A path is a sequence of adjacent edges whose weights are summed along the paths
-	 * The method returns the lengths of the shortest paths in a VertexAttribute.
-	 * @param[in] sources the vertices from which the shortest paths are computed
-	 * @param[out] distance_to_source : the sums of the edge weights in the shortest paths
+	 * Build the flat CSR graph of the vertex adjacencies from the adjacency cache.
+	 * Nodes are the vertex embeddings, neighbors of node i are the graph_targets_
+	 * in [graph_offsets_[i], graph_offsets_[i+1]). The graph is built once, the
+	 * topology of the map must not change during the life of the DistanceField.
 	 */
-	void dijkstra_compute_distances(
-			const std::vector<Vertex>& sources,
-			VertexAttribute<Scalar>& distance_to_source)
+	void build_graph()
 	{
-		for (auto& d : distance_to_source)
-			d = std::numeric_limits<Scalar>::max();
+		if (!graph_offsets_.empty())
+			return;
 
-		// A pair contains a scalar (the actual distance) and a vertex (the index of one of its darts)
-		using my_pair = std::pair<Scalar, uint32>;
+		const uint32 nb_nodes = map_.template const_attribute_container<Vertex::ORBIT>().end();
+		graph_offsets_.assign(nb_nodes + 1u, 0u);
 
-		// The queue is used to manage the front of the dijkstra flood that consider
-		// the vertices in the order of their estimated distance to a source
-		using my_queue = std::priority_queue<my_pair, std::vector<my_pair>, std::greater<my_pair> >;
-		my_queue vertex_queue;
+		map_.foreach_cell([&](Vertex v)
+		{
+			uint32 degree = 0u;
+			cache_.foreach_adjacent_vertex_through_edge(v, [&](Vertex) { ++degree; });
+			graph_offsets_[map_.embedding(v) + 1u] = degree;
+		});
+
+		for (uint32 i = 0u; i < nb_nodes; ++i)
+			graph_offsets_[i + 1u] += graph_offsets_[i];
+
+		graph_targets_.resize(graph_offsets_.back());
+		graph_edges_.resize(graph_offsets_.back());
+
+		map_.foreach_cell([&](Vertex v)
+		{
+			uint32 j = graph_offsets_[map_.embedding(v)];
+			cache_.foreach_adjacent_vertex_through_edge(v, [&](Vertex u)
+			{
+				graph_targets_[j] = map_.embedding(u);
+				graph_edges_[j] = map_.embedding(Edge(u.dart));
+				++j;
+			});
+		});
+	}
+
+	/**
+	 * Copy the current edge weights in the CSR graph.
+	 * @return the mean edge weight
+	 */
+	Scalar update_graph_weights()
+	{
+		const uint32 nb_arcs = uint32(graph_edges_.size());
+		graph_weights_.resize(nb_arcs);
+
+		std::vector<Scalar> sums((nb_arcs + PARALLEL_BUFFER_SIZE - 1u) / PARALLEL_BUFFER_SIZE, Scalar(0));
+		parallel_foreach_chunk(nb_arcs, PARALLEL_BUFFER_SIZE, [&](uint32 first, uint32 last)
+		{
+			Scalar sum(0);
+			for (uint32 j = first; j < last; ++j)
+			{
+				graph_weights_[j] = edge_weight_[graph_edges_[j]];
+				sum += graph_weights_[j];
+			}
+			sums[first / PARALLEL_BUFFER_SIZE] = sum;
+		});
+
+		Scalar sum(0);
+		for (Scalar s : sums)
+			sum += s;
+		return nb_arcs > 0u ? sum / Scalar(nb_arcs) : Scalar(0);
+	}
+
+	/**
+	 * Generate (in parallel) the relaxation requests of the lanes of the given nodes
+	 * whose distance lies in bucket b, through light (weight <= delta) or heavy edges.
+	 * When relaxing light edges, the lanes already relaxed with their current distance are skipped.
+	 */
+	void generate_requests(const std::vector<uint32>& nodes, std::size_t b, Scalar delta, bool light)
+	{
+		const uint32 nb_lanes = nb_lanes_;
+		const uint32 nb = uint32(nodes.size());
+		requests_.resize(std::max(requests_.size(), std::size_t((nb + PARALLEL_BUFFER_SIZE - 1u) / PARALLEL_BUFFER_SIZE)));
+
+		parallel_foreach_chunk(nb, PARALLEL_BUFFER_SIZE, [&](uint32 first, uint32 last)
+		{
+			std::vector<Request>& requests = requests_[first / PARALLEL_BUFFER_SIZE];
+			for (uint32 i = first; i < last; ++i)
+			{
+				const uint32 u = nodes[i];
+				for (uint32 k = 0u; k < nb_lanes; ++k)
+				{
+					const Scalar du = distances_[u * nb_lanes + k];
+					if (du == std::numeric_limits<Scalar>::max() || std::size_t(du / delta) != b)
+						continue;
+					if (light)
+					{
+						if (relaxed_[u * nb_lanes + k] == du)
+							continue;
+						relaxed_[u * nb_lanes + k] = du;
+					}
+					for (uint32 j = graph_offsets_[u], end = graph_offsets_[u + 1u]; j < end; ++j)
+					{
+						const Scalar w = graph_weights_[j];
+						if ((w <= delta) != light)
+							continue;
+						const uint32 v = graph_targets_[j];
+						const Scalar dv = du + w;
+						if (dv < distances_[v * nb_lanes + k])
+							requests.push_back({v, k, dv});
+					}
+				}
+			}
+		});
+	}
+
+	/**
+	 * Delta-stepping single source shortest paths (Meyer & Sanders) on the CSR graph.
+	 * Compute nb_lanes_ = sources.size() distance fields in the same sweep: distances_[i*nb_lanes_ + k]
+	 * is the distance of node i to the set of vertices sources[k].
+	 * The nodes of a bucket are relaxed in parallel, the resulting requests are applied sequentially.
+	 * @param[in] sources the sets of sources of each distance field
+	 * @param[in] delta width of the buckets (the mean edge weight is used if delta <= 0)
+	 */
+	void delta_stepping(const std::vector<std::vector<Vertex>>& sources, Scalar delta)
+	{
+		build_graph();
+		const Scalar mean_weight = update_graph_weights();
+		if (!(delta > Scalar(0)))
+			delta = mean_weight > Scalar(0) ? mean_weight : Scalar(1);
+
+		const uint32 nb_nodes = uint32(graph_offsets_.size()) - 1u;
+		const uint32 nb_lanes = uint32(sources.size());
+		nb_lanes_ = nb_lanes;
+		distances_.assign(std::size_t(nb_nodes) * nb_lanes, std::numeric_limits<Scalar>::max());
+		relaxed_.assign(std::size_t(nb_nodes) * nb_lanes, std::numeric_limits<Scalar>::max());
+
+		std::vector<std::vector<uint32>> buckets;
+		auto insert = [&] (uint32 node, Scalar d)
+		{
+			const std::size_t b = std::size_t(d / delta);
+			if (b >= buckets.size())
+				buckets.resize(b + 1u);
+			buckets[b].push_back(node);
+		};
+
+		auto apply_requests = [&] ()
+		{
+			for (std::vector<Request>& requests : requests_)
+			{
+				for (const Request& r : requests)
+				{
+					Scalar& d = distances_[r.node * nb_lanes + r.lane];
+					if (r.distance < d)
+					{
+						d = r.distance;
+						insert(r.node, r.distance);
+					}
+				}
+				requests.clear();
+			}
+		};
 
 		// Initialize the sources with a zero lenght path
-		for (auto& source : sources)
+		for (uint32 k = 0u; k < nb_lanes; ++k)
 		{
-			vertex_queue.push(std::make_pair(Scalar(0), source.dart.index));
-			distance_to_source[source] = Scalar(0);
+			for (Vertex source : sources[k])
+			{
+				const uint32 i = map_.embedding(source);
+				distances_[i * nb_lanes + k] = Scalar(0);
+				insert(i, Scalar(0));
+			}
 		}
 
-		// The dijkstra flood
-		while (!vertex_queue.empty())
-		{
-			Scalar dist = vertex_queue.top().first;
-			Vertex u = Vertex(Dart(vertex_queue.top().second));
+		// stamps used to remove the duplicates of the frontier and of the settled nodes of a bucket
+		std::vector<uint32> frontier_stamp(nb_nodes, INVALID_INDEX);
+		std::vector<std::size_t> settled_stamp(nb_nodes, std::numeric_limits<std::size_t>::max());
+		uint32 stamp = 0u;
 
-			vertex_queue.pop();
+		std::vector<uint32> frontier;
+		std::vector<uint32> settled;
 
-			cache_.foreach_adjacent_vertex_through_edge(u, [&](Vertex v)
+		for (std::size_t b = 0u; b < buckets.size(); ++b)
+		{
+			settled.clear();
+			while (!buckets[b].empty())
 			{
-				Scalar distance_through_u = dist + edge_weight_[Edge(v.dart)];
-				if (distance_through_u < distance_to_source[v])
+				frontier.clear();
+				++stamp;
+				for (uint32 u : buckets[b])
 				{
-					distance_to_source[v] = distance_through_u;
-					vertex_queue.push(std::make_pair(distance_through_u, v.dart.index));
+					if (frontier_stamp[u] != stamp)
+					{
+						frontier_stamp[u] = stamp;
+						frontier.push_back(u);
+					}
+					if (settled_stamp[u] != b)
+					{
+						settled_stamp[u] = b;
+						settled.push_back(u);
+					}
 				}
-			});
+				buckets[b].clear();
+
+				generate_requests(frontier, b, delta, true);
+				apply_requests();
+			}
+
+			// the distances of the bucket are final : relax the heavy edges
+			generate_requests(settled, b, delta, false);
+			apply_requests();
 		}
 	}
 
+	/**
+	 * Copy the distances of a lane of the last delta_stepping in a vertex attribute
+	 */
+	void copy_lane(uint32 lane, VertexAttribute<Scalar>& distance_to_source) const
+	{
+		const uint32 nb_nodes = uint32(graph_offsets_.size()) - 1u;
+		for (uint32 i = 0u; i < nb_nodes; ++i)
+			distance_to_source[i] = distances_[std::size_t(i) * nb_lanes_ + lane];
+	}
+
+public:
+
+	/**
+	 * Compute for each vertex of the map, the length of the shortest path to the sources
+	 * using a parallel delta-stepping algorithm on a CSR copy of the adjacency graph.
+	 * @param[in] sources the vertices from which the shortest paths are computed
+	 * @param[out] distance_to_source : the sums of the edge weights in the shortest paths
+	 * @param[in] delta : width of the buckets (the mean edge weight is used if delta <= 0)
+	 */
+	void delta_stepping_compute_distances(
+			const std::vector<Vertex>& sources,
+			VertexAttribute<Scalar>& distance_to_source,
+			Scalar delta = Scalar(0))
+	{
+		delta_stepping({sources}, delta);
+		copy_lane(0u, distance_to_source);
+	}
+
+	/**
+	 * Compute K distance fields in one sweep of the graph.
+	 * The k-th distance field is the distance of each vertex to the set of vertices sources[k].
+	 * @param[in] sources the K sets of vertices from which the shortest paths are computed
+	 * @param[out] distances_to_sources : the K distance fields
+	 * @param[in] delta : width of the buckets (the mean edge weight is used if delta <= 0)
+	 */
+	void batch_compute_distances(
+			const std::vector<std::vector<Vertex>>& sources,
+			std::vector<VertexAttribute<Scalar>>& distances_to_sources,
+			Scalar delta = Scalar(0))
+	{
+		cgogn_message_assert(sources.size() == distances_to_sources.size(), "batch_compute_distances: one distance field per set of sources is needed");
+		delta_stepping(sources, delta);
+		for (uint32 k = 0u; k < nb_lanes_; ++k)
+			copy_lane(k, distances_to_sources[k]);
+	}
+
 public:
 
 	/**
@@ -212,7 +432,7 @@ private:
 	 * @param[in] scalar_field : the scalar field
 	 * @param[out] morse_function : the values of the morse function
 	 * The algorithm makes a dijkstra flood of the graph using the scalar field values
-	 * in place of the shortest path distance computed in dijkstra_compute_distances().
+	 * in place of the shortest path distance computed in delta_stepping_compute_distances().
 	 * The vertices are traversed in increasing value of their scalar field.
 	 */
 	void dijkstra_to_morse_function(
@@ -319,7 +539,7 @@ public:
 		if (boundary_vertices.size() == 0u)
 			cgogn_log_error("distance_to_boundary") << "No boundary found";
 		else
-			dijkstra_compute_distances(boundary_vertices, scalar_field);
+			delta_stepping_compute_distances(boundary_vertices, scalar_field);
 	}
 
 	/**
@@ -342,7 +562,7 @@ public:
 	void distance_to_features(const std::vector<Vertex>& features,
 							  VertexAttribute<Scalar>& scalar_field)
 	{
-		dijkstra_compute_distances(features, scalar_field);
+		delta_stepping_compute_distances(features, scalar_field);
 	}
 
 	/**
@@ -354,20 +574,28 @@ public:
 	void sum_of_distance_to_features(const std::vector<Vertex>& features,
 									 VertexAttribute<Scalar>& scalar_field)
 	{
-		VertexAttribute<Scalar> distance_to_feature =
-				map_.template add_attribute<Scalar, Vertex>("__distance_to_feature__");
+		// the distance fields are computed by batches of SUM_BATCH_SIZE features
+		const uint32 SUM_BATCH_SIZE = 8u;
 
 		for (auto& s : scalar_field) s = Scalar(0);
 
-		for (Vertex f : features)
+		for (std::size_t first = 0u; first < features.size(); first += SUM_BATCH_SIZE)
 		{
-			dijkstra_compute_distances({f}, distance_to_feature);
+			const std::size_t last = std::min(features.size(), first + SUM_BATCH_SIZE);
+			std::vector<std::vector<Vertex>> sources;
+			for (std::size_t i = first; i < last; ++i)
+				sources.push_back({features[i]});
+
+			delta_stepping(sources, Scalar(0));
+
+			const uint32 nb_lanes = nb_lanes_;
 			map_.foreach_cell([&](Vertex v)
 			{
-				scalar_field[v] += distance_to_feature[v];
+				const uint32 i = map_.embedding(v);
+				for (uint32 k = 0u; k < nb_lanes; ++k)
+					scalar_field[v] += distances_[std::size_t(i) * nb_lanes + k];
 			});
 		}
-		map_.remove_attribute(distance_to_feature);
 	}
 
 	/**
@@ -376,27 +604,41 @@ public:
 	 */
 	void morse_distance_to_boundary(VertexAttribute<Scalar>& morse_function)
 	{
-		VertexAttribute<Scalar> distance_to_boundary =
-				map_.template add_attribute<Scalar, Vertex>("__distance_to_boundary__");
-
-		std::vector<Vertex> boundary_vertices;
-
-		map_.foreach_cell([&](Vertex v)
+		morse_distance_to_boundary([&](const std::vector<Vertex>& boundary_vertices, VertexAttribute<Scalar>& distance_to_boundary)
 		{
-			if (map_.is_incident_to_boundary(v))
-				boundary_vertices.push_back(v);
-		});
-
-		if (boundary_vertices.size() == 0u)
-		{
-			cgogn_log_error("distance_to_boundary") << "No boundary found";
-			return;
-		}
+			delta_stepping_compute_distances(boundary_vertices, distance_to_boundary);
+		},
+		morse_function);
+	}
 
-		dijkstra_compute_distances(boundary_vertices, distance_to_boundary);
+	/**
+	 * Build a scalar field that represent the geodesic distance of each vertex
+	 * to a given set of features (selected vertices) of the Map.
+	 * @param[in] geodesic the geodesic solver (HeatMethodGeodesic or FastMarchingGeodesic)
+	 * @param[in] features the vertices from which the distances are computed
+	 * @param[out] scalar_field : the computed distance field
+	 */
+	template <typename GEODESIC>
+	void distance_to_features(GEODESIC& geodesic,
+							  const std::vector<Vertex>& features,
+							  VertexAttribute<Scalar>& scalar_field)
+	{
+		geodesic.compute_distances(features, scalar_field);
+	}
 
-		dijkstra_to_morse_function(boundary_vertices, distance_to_boundary, morse_function);
-		map_.remove_attribute(distance_to_boundary);
+	/**
+	 * Build a morse function from the geodesic distance to the boundary.
+	 * @param[in] geodesic the geodesic solver (HeatMethodGeodesic or FastMarchingGeodesic)
+	 * @param[out] morse_function : the values of the morse function
+	 */
+	template <typename GEODESIC>
+	void morse_distance_to_boundary(GEODESIC& geodesic, VertexAttribute<Scalar>& morse_function)
+	{
+		morse_distance_to_boundary([&](const std::vector<Vertex>& boundary_vertices, VertexAttribute<Scalar>& distance_to_boundary)
+		{
+			geodesic.compute_distances(boundary_vertices, distance_to_boundary);
+		},
+		morse_function);
 	}
 
 	/**
@@ -411,7 +653,7 @@ public:
 				map_.template add_attribute<Scalar, Vertex>("__distance_to_features__");
 
 		// Compute the shortest paths to sources
-		dijkstra_compute_distances(features, distance_to_features);
+		delta_stepping_compute_distances(features, distance_to_features);
 
 		// Search for the vertices that maximize the distance to the sources
 		Vertex max_vertex = find_maximum(distance_to_features);
@@ -427,10 +669,53 @@ public:
 
 private:
 
+	/**
+	 * Build a morse function from a distance to the boundary.
+	 * @param[in] compute_distances : the function that computes the distance field to a set of vertices
+	 * @param[out] morse_function : the values of the morse function
+	 */
+	template <typename FUNC>
+	void morse_distance_to_boundary(const FUNC& compute_distances, VertexAttribute<Scalar>& morse_function)
+	{
+		std::vector<Vertex> boundary_vertices;
+
+		map_.foreach_cell([&](Vertex v)
+		{
+			if (map_.is_incident_to_boundary(v))
+				boundary_vertices.push_back(v);
+		});
+
+		if (boundary_vertices.size() == 0u)
+		{
+			cgogn_log_error("distance_to_boundary") << "No boundary found";
+			return;
+		}
+
+		VertexAttribute<Scalar> distance_to_boundary =
+				map_.template add_attribute<Scalar, Vertex>("__distance_to_boundary__");
+
+		compute_distances(boundary_vertices, distance_to_boundary);
+
+		dijkstra_to_morse_function(boundary_vertices, distance_to_boundary, morse_function);
+		map_.remove_attribute(distance_to_boundary);
+	}
+
 	MAP& map_;
 	AdjacencyCache<MAP> cache_;
 	EdgeAttribute<Scalar> edge_weight_;
 	bool intern_edge_weight_;
+
+	// CSR adjacency graph (see build_graph)
+	std::vector<uint32> graph_offsets_;
+	std::vector<uint32> graph_targets_;
+	std::vector<uint32> graph_edges_;
+	std::vector<Scalar> graph_weights_;
+
+	// results and scratch data of delta_stepping
+	uint32 nb_lanes_;
+	std::vector<Scalar> distances_;
+	std::vector<Scalar> relaxed_;
+	std::vector<std::vector<Request>> requests_;
 };
 
 #if defined(CGOGN_USE_EXTERNAL_TEMPLATES) && (!defined(CGOGN_TOPOLOGY_DISTANCE_FIELD_CPP_))
@@ -0,0 +1,521 @@
+/*******************************************************************************
+* CGoGN: Combinatorial and Geometric modeling with Generic N-dimensional Maps  *
+* Copyright (C) 2015, IGG Group, ICube, University of Strasbourg, France       *
+*                                                                              *
+* This library is free software; you can redistribute it and/or modify it      *
+* under the terms of the GNU Lesser General Public License as published by the *
+* Free Software Foundation; either version 2.1 of the License, or (at your     *
+* option) any later version.                                                   *
+*                                                                              *
+* This library is distributed in the hope that it will be useful, but WITHOUT  *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or        *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License  *
+* for more details.                                                            *
+*                                                                              *
+* You should have received a copy of the GNU Lesser General Public License     *
+* along with this library; if not, write to the Free Software Foundation,      *
+* Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.           *
+*                                                                              *
+* Web site: http://cgogn.unistra.fr/                                           *
+* Contact information: cgogn@unistra.fr                                        *
+*                                                                              *
+*******************************************************************************/
+
+#ifndef CGOGN_TOPOLOGY_ALGOS_GEODESIC_H_
+#define CGOGN_TOPOLOGY_ALGOS_GEODESIC_H_
+
+#include <array>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <vector>
+
+#include <cgogn/core/cmap/cmap2.h>
+#include <cgogn/core/utils/thread_pool.h>
+
+#include <cgogn/geometry/types/eigen.h>
+#include <cgogn/geometry/types/geometry_traits.h>
+
+#include <cgogn/topology/dll.h>
+
+namespace cgogn
+{
+
+namespace topology
+{
+
+namespace internal
+{
+
+/**
+ * class GeodesicTriangles : the triangles of a surface map used by the geodesic solvers.
+ * The vertices are indexed from 0 to nb_vertices()-1 and the polygonal faces are fan triangulated.
+ * The cotangents of the angles of the triangles and the incident triangles of each vertex are precomputed.
+ */
+template <typename VEC3, typename MAP>
+class GeodesicTriangles
+{
+public:
+
+	using Vertex = typename MAP::Vertex;
+	using Face = typename MAP::Face;
+	using Triangle = std::array<uint32, 3>;
+
+	template<typename T>
+	using VertexAttribute = typename MAP::template VertexAttribute<T>;
+
+	CGOGN_NOT_COPYABLE_NOR_MOVABLE(GeodesicTriangles);
+
+	GeodesicTriangles(const MAP& map, const VertexAttribute<VEC3>& position) :
+		map_(map)
+	{
+		index_.assign(map.template const_attribute_container<Vertex::ORBIT>().end(), INVALID_INDEX);
+
+		map.foreach_cell([&](Vertex v)
+		{
+			const VEC3& p = position[v];
+			index_[map.embedding(v)] = uint32(vertices_.size());
+			vertices_.push_back(v);
+			positions_.push_back(Eigen::Vector3d(float64(p[0]), float64(p[1]), float64(p[2])));
+		});
+
+		map.foreach_cell([&](Face f)
+		{
+			const uint32 a = index(Vertex(f.dart));
+			Dart d = map.phi1(f.dart);
+			Dart e = map.phi1(d);
+			while (e != f.dart)
+			{
+				triangles_.push_back({{a, index(Vertex(d)), index(Vertex(e))}});
+				d = e;
+				e = map.phi1(e);
+			}
+		});
+
+		const uint32 nb_tri = nb_triangles();
+		cotangents_.resize(nb_tri);
+		areas_.resize(nb_tri);
+		parallel_foreach_chunk(nb_tri, PARALLEL_BUFFER_SIZE, [&](uint32 first, uint32 last)
+		{
+			for (uint32 t = first; t < last; ++t)
+			{
+				const Triangle& tri = triangles_[t];
+				const float64 area2 = (positions_[tri[1]] - positions_[tri[0]]).cross(positions_[tri[2]] - positions_[tri[0]]).norm();
+				areas_[t] = area2 / 2.0;
+				for (uint32 c = 0u; c < 3u; ++c)
+				{
+					const Eigen::Vector3d& pc = positions_[tri[c]];
+					const float64 dot = (positions_[tri[(c+1u)%3u]] - pc).dot(positions_[tri[(c+2u)%3u]] - pc);
+					cotangents_[t][c] = area2 > 0.0 ? dot / area2 : 0.0;
+				}
+			}
+		});
+
+		// incident corners (3*triangle+corner) of each vertex
+		const uint32 nb_v = nb_vertices();
+		corner_offsets_.assign(nb_v + 1u, 0u);
+		for (const Triangle& tri : triangles_)
+			for (uint32 v : tri)
+				++corner_offsets_[v + 1u];
+		for (uint32 i = 0u; i < nb_v; ++i)
+			corner_offsets_[i + 1u] += corner_offsets_[i];
+		corners_.resize(corner_offsets_.back());
+		std::vector<uint32> pos(corner_offsets_.begin(), corner_offsets_.end() - 1);
+		for (uint32 t = 0u; t < nb_tri; ++t)
+			for (uint32 c = 0u; c < 3u; ++c)
+				corners_[pos[triangles_[t][c]]++] = 3u * t + c;
+	}
+
+	inline uint32 nb_vertices() const { return uint32(vertices_.size()); }
+	inline uint32 nb_triangles() const { return uint32(triangles_.size()); }
+
+	inline uint32 index(Vertex v) const { return index_[map_.embedding(v)]; }
+	inline Vertex vertex(uint32 i) const { return vertices_[i]; }
+	inline const Eigen::Vector3d& position(uint32 i) const { return positions_[i]; }
+
+	inline const Triangle& triangle(uint32 t) const { return triangles_[t]; }
+	/// cotangent of the angle of the triangle t at its corner c
+	inline float64 cotangent(uint32 t, uint32 c) const { return cotangents_[t][c]; }
+	inline float64 area(uint32 t) const { return areas_[t]; }
+
+	/**
+	 * @brief apply f(t, c) on the corners (triangle t, corner c) incident to the vertex i
+	 */
+	template <typename FUNC>
+	inline void foreach_incident_corner(uint32 i, const FUNC& f) const
+	{
+		for (uint32 j = corner_offsets_[i], end = corner_offsets_[i + 1u]; j < end; ++j)
+			f(corners_[j] / 3u, corners_[j] % 3u);
+	}
+
+	/**
+	 * @brief copy values given for the vertices 0..nb_vertices()-1 to a vertex attribute
+	 */
+	template <typename T, typename Scalar>
+	void write(const std::vector<T>& values, VertexAttribute<Scalar>& attribute) const
+	{
+		parallel_foreach_chunk(nb_vertices(), PARALLEL_BUFFER_SIZE, [&](uint32 first, uint32 last)
+		{
+			for (uint32 i = first; i < last; ++i)
+				attribute[vertices_[i]] = Scalar(values[i]);
+		});
+	}
+
+private:
+
+	const MAP& map_;
+	std::vector<uint32> index_;
+	std::vector<Vertex> vertices_;
+	std::vector<Eigen::Vector3d> positions_;
+	std::vector<Triangle> triangles_;
+	std::vector<std::array<float64, 3>> cotangents_;
+	std::vector<float64> areas_;
+	std::vector<uint32> corner_offsets_;
+	std::vector<uint32> corners_;
+};
+
+} // namespace internal
+
+/**
+ * class HeatMethodGeodesic : geodesic distances computed with the heat method
+ * (K. Crane, C. Weischedel, M. Wardetzky, Geodesics in Heat, 2013).
+ * The heat flow and Poisson systems built on the cotan Laplacian are factorized
+ * once in the constructor, so that each query only costs two back-substitutions
+ * and the (parallel) computation of the normalized gradient and its divergence.
+ */
+template <typename VEC3, typename MAP>
+class HeatMethodGeodesic
+{
+public:
+
+	using Scalar = typename geometry::vector_traits<VEC3>::Scalar;
+	using Vertex = typename MAP::Vertex;
+
+	template<typename T>
+	using VertexAttribute = typename MAP::template VertexAttribute<T>;
+
+	CGOGN_NOT_COPYABLE_NOR_MOVABLE(HeatMethodGeodesic);
+
+	/**
+	 * @param map the surface map
+	 * @param position the positions of the vertices
+	 * @param time_factor : the time step of the heat flow is time_factor * h^2 (h : mean edge length)
+	 */
+	HeatMethodGeodesic(const MAP& map, const VertexAttribute<VEC3>& position, float64 time_factor = 1.0) :
+		mesh_(map, position),
+		valid_(false)
+	{
+		factorize(time_factor);
+	}
+
+	/**
+	 * @return true if the systems have been successfully factorized
+	 */
+	inline bool is_valid() const { return valid_; }
+
+	/**
+	 * Compute for each vertex of the map, its geodesic distance to the sources
+	 * @param[in] sources the vertices from which the distances are computed
+	 * @param[out] distance_to_source : the geodesic distances
+	 */
+	void compute_distances(const std::vector<Vertex>& sources, VertexAttribute<Scalar>& distance_to_source)
+	{
+		if (!valid_)
+		{
+			cgogn_log_error("HeatMethodGeodesic::compute_distances") << "The heat method systems could not be factorized.";
+			return;
+		}
+
+		const uint32 nb_v = mesh_.nb_vertices();
+		const uint32 nb_tri = mesh_.nb_triangles();
+
+		// 1. heat flow from the sources
+		Eigen::VectorXd delta = Eigen::VectorXd::Zero(nb_v);
+		for (Vertex s : sources)
+			delta[mesh_.index(s)] = 1.0;
+		const Eigen::VectorXd u = heat_solver_.solve(delta);
+
+		// 2. normalized (opposite) gradient of the heat in each triangle
+		directions_.resize(nb_tri);
+		parallel_foreach_chunk(nb_tri, PARALLEL_BUFFER_SIZE, [&](uint32 first, uint32 last)
+		{
+			for (uint32 t = first; t < last; ++t)
+			{
+				const auto& tri = mesh_.triangle(t);
+				const Eigen::Vector3d grad =
+					gradient_basis_[t][0] * u[tri[0]] +
+					gradient_basis_[t][1] * u[tri[1]] +
+					gradient_basis_[t][2] * u[tri[2]];
+				const float64 n = grad.norm();
+				directions_[t] = n > 0.0 ? Eigen::Vector3d(-grad / n) : Eigen::Vector3d::Zero();
+			}
+		});
+
+		// 3. integrated divergence of the direction field at each vertex
+		Eigen::VectorXd divergence(nb_v);
+		parallel_foreach_chunk(nb_v, PARALLEL_BUFFER_SIZE, [&](uint32 first, uint32 last)
+		{
+			for (uint32 i = first; i < last; ++i)
+			{
+				float64 div = 0.0;
+				mesh_.foreach_incident_corner(i, [&](uint32 t, uint32 c)
+				{
+					const auto& tri = mesh_.triangle(t);
+					const uint32 j = (c + 1u) % 3u;
+					const uint32 k = (c + 2u) % 3u;
+					const Eigen::Vector3d& pi = mesh_.position(i);
+					const Eigen::Vector3d& X = directions_[t];
+					div += mesh_.cotangent(t, k) * (mesh_.position(tri[j]) - pi).dot(X);
+					div += mesh_.cotangent(t, j) * (mesh_.position(tri[k]) - pi).dot(X);
+				});
+				divergence[i] = div / 2.0;
+			}
+		});
+
+		// 4. distance whose gradient best fits the direction field (the laplacian is positive here)
+		Eigen::VectorXd phi = poisson_solver_.solve(-divergence);
+
+		float64 min = std::numeric_limits<float64>::max();
+		for (Vertex s : sources)
+			min = std::min(min, phi[mesh_.index(s)]);
+		std::vector<float64> distances(nb_v);
+		for (uint32 i = 0u; i < nb_v; ++i)
+			distances[i] = std::max(0.0, phi[i] - min);
+
+		mesh_.write(distances, distance_to_source);
+	}
+
+private:
+
+	void factorize(float64 time_factor)
+	{
+		using Triplet = Eigen::Triplet<float64>;
+
+		const uint32 nb_v = mesh_.nb_vertices();
+		const uint32 nb_tri = mesh_.nb_triangles();
+
+		// cotan laplacian (positive semi-definite) and lumped mass matrix
+		std::vector<Triplet> laplacian_coefs;
+		std::vector<Triplet> mass_coefs;
+		laplacian_coefs.reserve(12u * nb_tri);
+		mass_coefs.reserve(3u * nb_tri);
+
+		gradient_basis_.resize(nb_tri);
+		float64 sum_length = 0.0;
+
+		for (uint32 t = 0u; t < nb_tri; ++t)
+		{
+			const auto& tri = mesh_.triangle(t);
+			const Eigen::Vector3d& p0 = mesh_.position(tri[0]);
+			const Eigen::Vector3d& p1 = mesh_.position(tri[1]);
+			const Eigen::Vector3d& p2 = mesh_.position(tri[2]);
+			const Eigen::Vector3d N = (p1 - p0).cross(p2 - p0);
+			const float64 area2 = N.norm();
+
+			for (uint32 c = 0u; c < 3u; ++c)
+			{
+				const uint32 j = tri[(c + 1u) % 3u];
+				const uint32 k = tri[(c + 2u) % 3u];
+				const float64 w = mesh_.cotangent(t, c) / 2.0;
+				laplacian_coefs.push_back(Triplet(j, k, -w));
+				laplacian_coefs.push_back(Triplet(k, j, -w));
+				laplacian_coefs.push_back(Triplet(j, j, w));
+				laplacian_coefs.push_back(Triplet(k, k, w));
+				mass_coefs.push_back(Triplet(tri[c], tri[c], mesh_.area(t) / 3.0));
+
+				// gradient of the hat function of the corner c : N x e_c / (2 area)
+				const Eigen::Vector3d e = mesh_.position(k) - mesh_.position(j);
+				gradient_basis_[t][c] = area2 > 0.0 ? Eigen::Vector3d(N.cross(e) / (area2 * area2)) : Eigen::Vector3d::Zero();
+				sum_length += e.norm();
+			}
+		}
+
+		Eigen::SparseMatrix<float64> laplacian(nb_v, nb_v);
+		laplacian.setFromTriplets(laplacian_coefs.begin(), laplacian_coefs.end());
+		Eigen::SparseMatrix<float64> mass(nb_v, nb_v);
+		mass.setFromTriplets(mass_coefs.begin(), mass_coefs.end());
+
+		const float64 h = nb_tri > 0u ? sum_length / float64(3u * nb_tri) : 1.0;
+		const float64 time = time_factor * h * h;
+
+		heat_solver_.compute(Eigen::SparseMatrix<float64>(mass + time * laplacian));
+		// the constant functions are in the kernel of the laplacian : regularize with the mass matrix
+		poisson_solver_.compute(Eigen::SparseMatrix<float64>(laplacian + 1e-8 * mass));
+
+		valid_ = heat_solver_.info() == Eigen::Success && poisson_solver_.info() == Eigen::Success;
+		if (!valid_)
+			cgogn_log_error("HeatMethodGeodesic") << "Factorization of the heat method systems failed.";
+	}
+
+	internal::GeodesicTriangles<VEC3, MAP> mesh_;
+	std::vector<std::array<Eigen::Vector3d, 3>> gradient_basis_;
+	std::vector<Eigen::Vector3d> directions_;
+	Eigen::SimplicialLDLT<Eigen::SparseMatrix<float64>> heat_solver_;
+	Eigen::SimplicialLDLT<Eigen::SparseMatrix<float64>> poisson_solver_;
+	bool valid_;
+};
+
+/**
+ * class FastMarchingGeodesic : geodesic distances computed with the fast marching method on triangles
+ * (R. Kimmel, J.A. Sethian, Computing geodesic paths on manifolds, 1998).
+ * A front is propagated from the sources in increasing order of distance, the distance of a vertex
+ * is updated from the triangles whose two other vertices are already known (by unfolding the triangle).
+ * A front propagation is sequential, several distance fields are computed in parallel by batch_compute_distances.
+ */
+template <typename VEC3, typename MAP>
+class FastMarchingGeodesic
+{
+public:
+
+	using Scalar = typename geometry::vector_traits<VEC3>::Scalar;
+	using Vertex = typename MAP::Vertex;
+
+	template<typename T>
+	using VertexAttribute = typename MAP::template VertexAttribute<T>;
+
+	CGOGN_NOT_COPYABLE_NOR_MOVABLE(FastMarchingGeodesic);
+
+	FastMarchingGeodesic(const MAP& map, const VertexAttribute<VEC3>& position) :
+		mesh_(map, position)
+	{}
+
+	/**
+	 * Compute for each vertex of the map, its geodesic distance to the sources
+	 * @param[in] sources the vertices from which the distances are computed
+	 * @param[out] distance_to_source : the geodesic distances
+	 */
+	void compute_distances(const std::vector<Vertex>& sources, VertexAttribute<Scalar>& distance_to_source)
+	{
+		std::vector<float64> distances;
+		fast_marching(sources, distances);
+		mesh_.write(distances, distance_to_source);
+	}
+
+	/**
+	 * Compute K distance fields in parallel.
+	 * The k-th distance field is the distance of each vertex to the set of vertices sources[k].
+	 * @param[in] sources the K sets of vertices from which the distances are computed
+	 * @param[out] distances_to_sources : the K distance fields
+	 */
+	void batch_compute_distances(
+		const std::vector<std::vector<Vertex>>& sources,
+		std::vector<VertexAttribute<Scalar>>& distances_to_sources)
+	{
+		cgogn_message_assert(sources.size() == distances_to_sources.size(), "batch_compute_distances: one distance field per set of sources is needed");
+
+		parallel_foreach_chunk(uint32(sources.size()), 1u, [&](uint32 first, uint32 last)
+		{
+			std::vector<float64> distances;
+			for (uint32 k = first; k < last; ++k)
+			{
+				fast_marching(sources[k], distances);
+				for (uint32 i = 0u, nb_v = mesh_.nb_vertices(); i < nb_v; ++i)
+					distances_to_sources[k][mesh_.vertex(i)] = Scalar(distances[i]);
+			}
+		});
+	}
+
+private:
+
+	/**
+	 * distance of C computed from the known distances of A and B in the triangle ABC
+	 */
+	float64 triangle_update(uint32 c, uint32 a, uint32 b, const std::vector<float64>& T) const
+	{
+		const Eigen::Vector3d& A = mesh_.position(a);
+		const Eigen::Vector3d& B = mesh_.position(b);
+		const Eigen::Vector3d& C = mesh_.position(c);
+		const float64 la = (C - B).norm();
+		const float64 lb = (C - A).norm();
+		const float64 lc = (B - A).norm();
+
+		float64 result = std::min(T[a] + lb, T[b] + la);
+
+		if (lc <= 0.0)
+			return result;
+
+		// unfold the triangle in the plane : A = (0,0), B = (lc,0), C above AB
+		const float64 cx = (lb * lb - la * la + lc * lc) / (2.0 * lc);
+		const float64 cy = std::sqrt(std::max(0.0, lb * lb - cx * cx));
+
+		// virtual source S below AB at distance T[a] from A and T[b] from B
+		const float64 sx = (T[a] * T[a] - T[b] * T[b] + lc * lc) / (2.0 * lc);
+		const float64 sy2 = T[a] * T[a] - sx * sx;
+		if (sy2 < 0.0)
+			return result;
+		const float64 sy = -std::sqrt(sy2);
+
+		// the straight path from S to C must cross the edge AB
+		const float64 x = sx + (cx - sx) * (-sy / (cy - sy));
+		if (x < 0.0 || x > lc)
+			return result;
+
+		return std::min(result, std::sqrt((cx - sx) * (cx - sx) + (cy - sy) * (cy - sy)));
+	}
+
+	void fast_marching(const std::vector<Vertex>& sources, std::vector<float64>& T) const
+	{
+		const uint32 nb_v = mesh_.nb_vertices();
+		T.assign(nb_v, std::numeric_limits<float64>::max());
+		std::vector<bool> alive(nb_v, false);
+
+		using FrontElement = std::pair<float64, uint32>;
+		std::priority_queue<FrontElement, std::vector<FrontElement>, std::greater<FrontElement>> front;
+
+		for (Vertex s : sources)
+		{
+			const uint32 i = mesh_.index(s);
+			T[i] = 0.0;
+			front.push(std::make_pair(0.0, i));
+		}
+
+		auto update = [&] (uint32 v, uint32 u, uint32 w)
+		{
+			if (alive[v])
+				return;
+			float64 t = T[u] + (mesh_.position(v) - mesh_.position(u)).norm();
+			if (alive[w])
+				t = std::min(t, triangle_update(v, u, w, T));
+			if (t < T[v])
+			{
+				T[v] = t;
+				front.push(std::make_pair(t, v));
+			}
+		};
+
+		while (!front.empty())
+		{
+			const FrontElement top = front.top();
+			front.pop();
+			const uint32 u = top.second;
+			if (alive[u] || top.first > T[u])
+				continue;
+			alive[u] = true;
+
+			mesh_.foreach_incident_corner(u, [&](uint32 t, uint32 c)
+			{
+				const auto& tri = mesh_.triangle(t);
+				const uint32 j = tri[(c + 1u) % 3u];
+				const uint32 k = tri[(c + 2u) % 3u];
+				update(j, u, k);
+				update(k, u, j);
+			});
+		}
+	}
+
+	internal::GeodesicTriangles<VEC3, MAP> mesh_;
+};
+
+#if defined(CGOGN_USE_EXTERNAL_TEMPLATES) && (!defined(CGOGN_TOPOLOGY_ALGOS_GEODESIC_CPP_))
+extern template class CGOGN_TOPLOGY_API HeatMethodGeodesic<Eigen::Vector3f, CMap2>;
+extern template class CGOGN_TOPLOGY_API HeatMethodGeodesic<Eigen::Vector3d, CMap2>;
+extern template class CGOGN_TOPLOGY_API FastMarchingGeodesic<Eigen::Vector3f, CMap2>;
+extern template class CGOGN_TOPLOGY_API FastMarchingGeodesic<Eigen::Vector3d, CMap2>;
+#endif // defined(CGOGN_USE_EXTERNAL_TEMPLATES) && (!defined(CGOGN_TOPOLOGY_ALGOS_GEODESIC_CPP_))
+
+} // namespace topology
+
+} // namespace cgogn
+
+#endif // CGOGN_TOPOLOGY_ALGOS_GEODESIC_H_
@@ -24,6 +24,13 @@
 #ifndef CGOGN_TOPOLOGY_SCALAR_FIELD_H_
 #define CGOGN_TOPOLOGY_SCALAR_FIELD_H_
 
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include <cgogn/core/utils/thread_pool.h>
+
 #include <cgogn/topology/types/adjacency_cache.h>
 #include <cgogn/topology/types/critical_point.h>
 
@@ -69,6 +76,13 @@ class ScalarField
 	using FaceMarker = typename MAP::template CellMarker<Face::ORBIT>;
 	using VolumeMarker = typename MAP::template CellMarker<Volume::ORBIT>;
 
+	// Memory used by a thread to analyze the link of a vertex
+	struct LinkScratch
+	{
+		std::vector<uint8> inf;
+		std::vector<uint16> parent;
+	};
+
 public:
 	using ContourPoint = std::pair<Dart, Scalar>;
 	using Contour = std::vector<ContourPoint>;
@@ -299,91 +313,167 @@ private:
 	}
 
 	/**
-	 * @brief Count the number of connected components in Link+(v) or Link-(v)
-	 * @param link the set of vertices that belong to the link
-	 * @param link_marker a marker that should be set for the initial set of vertices
-	 * @return the number of connected components
-	 * The algorithm traverses the connected components of Link(v) through adjacent edges.
-	 * The traversal are restricted to marked vertices (i.e. to Link+ or Link-).
+	 * @brief Concatenate the per thread lists of vertices in the order of the vertex traversal
+	 */
+	void merge_vertices(const std::vector<std::vector<Vertex>>& per_thread, std::vector<Vertex>& result)
+	{
+		result.clear();
+		for (const std::vector<Vertex>& vertices : per_thread)
+			result.insert(result.end(), vertices.begin(), vertices.end());
+		std::sort(result.begin(), result.end(), [](Vertex a, Vertex b) { return a.dart.index < b.dart.index; });
+	}
+
+	/**
+	 * @brief Build the links of all the vertices of a 3-manifold in CSR form.
+	 * The vertices adjacent to the vertex of embedding i are the embeddings
+	 * link_vertices_[link_offsets_[i] .. link_offsets_[i+1]-1] and the edges of its link are
+	 * link_edges_[link_edge_offsets_[i] .. link_edge_offsets_[i+1]-1] : pairs of local indices
+	 * of adjacent vertices that are consecutive in a face incident to the vertex.
 	 */
 	template <typename CONCRETE_MAP, typename std::enable_if<CONCRETE_MAP::DIMENSION == 3>::type* = nullptr>
-	uint32 nb_marked_cc_in_link(std::vector<Dart>& link, VertexMarkerNoUnmark& link_marker)
+	void build_links()
 	{
-		uint32 nb_cc = 0u;
-		while (!link.empty())
+		const uint32 nb_emb = map_.template const_attribute_container<Vertex::ORBIT>().end();
+		link_offsets_.assign(nb_emb + 1u, 0u);
+		link_edge_offsets_.assign(nb_emb + 1u, 0u);
+
+		// Each face incident to the vertex is considered once (from one of its two volumes)
+		auto is_link_dart = [&](Dart d) -> bool
 		{
-			// Search a marked vertex in the link
-			// Such vertex belong to a not yet traversed connected component
-			Dart d;
-			do {
-				d = link.back();
-				link.pop_back();
-			} while (!link_marker.is_marked(Vertex(d)) && !link.empty());
+			if (map_.is_boundary(d))
+				return false;
+			Dart d3 = map_.phi3(d);
+			return map_.is_boundary(d3) || d.index < map_.phi1(d3).index;
+		};
 
-			// If a marked vertex has been found, its connected component is counted and unmarked
-			if (link_marker.is_marked(Vertex(d)))
-			{
-				++nb_cc;
-				// Traverse the connected component of d (marked vertices connected to d)
-				std::vector<Dart> cc;
-				cc.push_back(d);
-				while (!cc.empty())
-				{
-					Dart e = cc.back();
-					link_marker.unmark(Vertex(e));
-					cc.pop_back();
+		map_.parallel_foreach_cell([&](Vertex v, uint32)
+		{
+			const uint32 i = map_.embedding(v);
+			uint32 nb_vertices = 0u;
+			uint32 nb_edges = 0u;
+			cache_.foreach_adjacent_vertex_through_edge(v, [&](Vertex) { ++nb_vertices; });
+			map_.foreach_dart_of_orbit(v, [&](Dart d) { if (is_link_dart(d)) ++nb_edges; });
+			link_offsets_[i + 1u] = nb_vertices;
+			link_edge_offsets_[i + 1u] = nb_edges;
+		});
 
-					map_.foreach_incident_face(Edge(e), [&](Face f)
-					{
-						// The vertex of dart adj is adjacent to the vertex of e through an edge and
-						// the dart phi2(adj) belongs to the central vertex C
-						Dart adj = map_.phi2(map_.phi_1(map_.phi_1(f.dart)));
-						if (link_marker.is_marked(Vertex(adj)))
-							cc.push_back(adj);
-					});
-				}
-			}
+		for (uint32 i = 0u; i < nb_emb; ++i)
+		{
+			link_offsets_[i + 1u] += link_offsets_[i];
+			link_edge_offsets_[i + 1u] += link_edge_offsets_[i];
 		}
-		return nb_cc;
+		link_vertices_.resize(link_offsets_.back());
+		link_edges_.resize(link_edge_offsets_.back());
+
+		map_.parallel_foreach_cell([&](Vertex v, uint32)
+		{
+			const uint32 i = map_.embedding(v);
+			const uint32 first = link_offsets_[i];
+			uint32 k = first;
+			cache_.foreach_adjacent_vertex_through_edge(v, [&](Vertex u)
+			{
+				link_vertices_[k++] = map_.embedding(u);
+			});
+			cgogn_message_assert(k - first <= std::numeric_limits<uint16>::max(), "build_links: vertex degree is too high");
+
+			auto local_index = [&](Dart d) -> uint16
+			{
+				const uint32 e = map_.embedding(Vertex(d));
+				uint32 j = first;
+				while (link_vertices_[j] != e)
+					++j;
+				cgogn_assert(j < k);
+				return uint16(j - first);
+			};
+
+			uint32 l = link_edge_offsets_[i];
+			map_.foreach_dart_of_orbit(v, [&](Dart d)
+			{
+				if (is_link_dart(d))
+					link_edges_[l++] = std::make_pair(local_index(map_.phi1(d)), local_index(map_.phi_1(d)));
+			});
+		});
+	}
+
+	template <typename CONCRETE_MAP, typename std::enable_if<CONCRETE_MAP::DIMENSION == 2>::type* = nullptr>
+	void build_links()
+	{}
+
+	/**
+	 * @brief release the memory of the links
+	 */
+	void clear_links()
+	{
+		std::vector<uint32>().swap(link_offsets_);
+		std::vector<uint32>().swap(link_vertices_);
+		std::vector<uint32>().swap(link_edge_offsets_);
+		std::vector<std::pair<uint16, uint16>>().swap(link_edges_);
 	}
 
 	/**
 	 * @brief Classify the vertex of a 3-manifold by differential analysis of the scalar field.
 	 * @param v the vertex to analyze
+	 * @param scratch memory reused from one vertex to the next one
 	 * @return the vertex classification
-	 * The algorithm traverse Link(v) and build Link+(v) and Link-(v) :
-	 * Both sets are stored in vectors of Dart and theirs vertices marked.
-	 * Then the vectors and markers are used to count the numbers of connected components.
+	 * The algorithm splits the (CSR) Link(v) in Link+(v) and Link-(v)
+	 * and counts the numbers of connected components of both sets with a union-find.
 	 */
 	template <typename CONCRETE_MAP, typename std::enable_if<CONCRETE_MAP::DIMENSION == 3>::type* = nullptr>
-	CriticalPoint critical_vertex_analysis(Vertex v)
+	CriticalPoint critical_vertex_analysis(Vertex v, LinkScratch& scratch)
 	{
-		VertexMarkerNoUnmark sup_link_marker(map_);
-		VertexMarkerNoUnmark inf_link_marker(map_);
-
-		std::vector<Dart> sup_link;
-		std::vector<Dart> inf_link;
+		const uint32 i = map_.embedding(v);
+		const uint32 first = link_offsets_[i];
+		const uint32 degree = link_offsets_[i + 1u] - first;
+		const Scalar center_value = scalar_field_[i];
+
+		std::vector<uint8>& inf = scratch.inf;
+		std::vector<uint16>& parent = scratch.parent;
+		inf.resize(degree);
+		parent.resize(degree);
+
+		// Split the Link(v) in Link-(v) and Link+(v)
+		for (uint32 j = 0u; j < degree; ++j)
+		{
+			inf[j] = scalar_field_[link_vertices_[first + j]] < center_value;
+			parent[j] = uint16(j);
+		}
 
-		// Mark and store the vertices that belong to the Link+(v) and Link-(v)
-		Scalar center_value = scalar_field_[v];
-		cache_.foreach_adjacent_vertex_through_edge(v, [&](Vertex u)
+		auto root = [&](uint16 j) -> uint16
 		{
-			Scalar value = scalar_field_[u];
-			if (value < center_value)
+			while (parent[j] != j)
 			{
-				inf_link_marker.mark(u);
-				inf_link.push_back(u.dart);
+				parent[j] = parent[parent[j]];
+				j = parent[j];
 			}
-			else
+			return j;
+		};
+
+		// Merge the vertices of a same part connected by an edge of the link
+		for (uint32 l = link_edge_offsets_[i], end = link_edge_offsets_[i + 1u]; l < end; ++l)
+		{
+			const std::pair<uint16, uint16>& e = link_edges_[l];
+			if (inf[e.first] == inf[e.second])
 			{
-				sup_link_marker.mark(u);
-				sup_link.push_back(u.dart);
+				const uint16 r1 = root(e.first);
+				const uint16 r2 = root(e.second);
+				if (r1 != r2)
+					parent[r1] = r2;
 			}
-		});
+		}
 
 		// Count the number of connected components in the inf and sup links
-		uint32 nb_inf = nb_marked_cc_in_link<CONCRETE_MAP>(inf_link, inf_link_marker);
-		uint32 nb_sup = nb_marked_cc_in_link<CONCRETE_MAP>(sup_link, sup_link_marker);
+		uint32 nb_inf = 0u;
+		uint32 nb_sup = 0u;
+		for (uint32 j = 0u; j < degree; ++j)
+		{
+			if (parent[j] == j)
+			{
+				if (inf[j])
+					++nb_inf;
+				else
+					++nb_sup;
+			}
+		}
 
 		// All vertices of the Link are in Link-(v)
 		if (nb_inf == 1 && nb_sup == 0)
@@ -410,28 +500,46 @@ private:
 		return CriticalPoint(CriticalPoint::Type::UNKNOWN);
 	}
 
+	template <typename CONCRETE_MAP, typename std::enable_if<CONCRETE_MAP::DIMENSION == 2>::type* = nullptr>
+	inline CriticalPoint critical_vertex_analysis(Vertex v, LinkScratch&)
+	{
+		return critical_vertex_analysis<CONCRETE_MAP>(v);
+	}
+
 public:
 
 	/// \brief Find and analyze all critical points of the scalar field
+	/// The vertices are classified in parallel : each thread has its own scratch memory
+	/// and lists of critical points, merged at the end in the order of the vertex traversal.
 	void critical_vertex_analysis()
 	{
-		maxima_.clear();
-		minima_.clear();
-		saddles_.clear();
+		build_links<MAP>();
+
+		const std::size_t nb_threads_pool = cgogn::thread_pool()->nb_threads();
+		std::vector<LinkScratch> scratch(nb_threads_pool);
+		std::vector<std::vector<Vertex>> maxima(nb_threads_pool);
+		std::vector<std::vector<Vertex>> minima(nb_threads_pool);
+		std::vector<std::vector<Vertex>> saddles(nb_threads_pool);
 
-		map_.foreach_cell([&](Vertex v)
+		map_.parallel_foreach_cell([&](Vertex v, uint32 th_id)
 		{
-			CriticalPoint type = critical_vertex_analysis<MAP>(v);
+			CriticalPoint type = critical_vertex_analysis<MAP>(v, scratch[th_id]);
 			vertex_type_[v] = type.v_;
 			if (type.v_ == CriticalPoint::Type::MAXIMUM)
-				maxima_.push_back(v);
+				maxima[th_id].push_back(v);
 			if (type.v_ == CriticalPoint::Type::MINIMUM)
-				minima_.push_back(v);
+				minima[th_id].push_back(v);
 			else if (type.v_ == CriticalPoint::Type::SADDLE  ||
 					 type.v_ == CriticalPoint::Type::SADDLE1 ||
 					 type.v_ == CriticalPoint::Type::SADDLE2)
-				saddles_.push_back(v);
+				saddles[th_id].push_back(v);
 		});
+
+		merge_vertices(maxima, maxima_);
+		merge_vertices(minima, minima_);
+		merge_vertices(saddles, saddles_);
+
+		clear_links();
 		vertex_type_computed_ = true;
 	}
 
@@ -1095,6 +1203,12 @@ private:
 
 	MAP& map_;
 	AdjacencyCache<MAP> cache_;
+
+	// CSR links of the vertices (see build_links)
+	std::vector<uint32> link_offsets_;
+	std::vector<uint32> link_vertices_;
+	std::vector<uint32> link_edge_offsets_;
+	std::vector<std::pair<uint16, uint16>> link_edges_;
 	VertexAttribute<Scalar> scalar_field_;
 	VertexAttribute<CriticalPoint::Type> vertex_type_;
 	bool vertex_type_computed_;